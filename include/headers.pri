@@ -72,6 +72,7 @@ HEADER_CLASSES += ../include/TAccessLog
 HEADER_CLASSES += ../include/TActionWorker
 HEADER_CLASSES += ../include/TAtomicQueue
 HEADER_CLASSES += ../include/TJsonUtil
+HEADER_CLASSES += ../include/TJsonWriter
 HEADER_CLASSES += ../include/TJobScheduler
 HEADER_CLASSES += ../include/TCommandLineInterface
 HEADER_CLASSES += ../include/TSendmailMailer
@@ -89,6 +90,7 @@ HEADER_CLASSES += ../include/TDebug
 HEADER_CLASSES += ../include/TBackgroundProcess
 HEADER_CLASSES += ../include/TBackgroundProcessHandler
 HEADER_CLASSES += ../include/TCache
+HEADER_CLASSES += ../include/TFragmentCache
 HEADER_CLASSES += ../include/THttpClient
 HEADER_CLASSES += ../include/TOAuth2Client
 HEADER_CLASSES += ../include/TUrlRoute
@@ -176,6 +178,7 @@ HEADER_FILES += taccesslog.h
 HEADER_FILES += tactionworker.h
 HEADER_FILES += tatomicqueue.h
 HEADER_FILES += tjsonutil.h
+HEADER_FILES += tjsonwriter.h
 HEADER_FILES += tjobscheduler.h
 HEADER_FILES += tcommandlineinterface.h
 HEADER_FILES += tsendmailmailer.h
@@ -189,12 +192,14 @@ HEADER_FILES += twebsocketsession.h
 HEADER_FILES += tredis.h
 HEADER_FILES += tsqljoin.h
 HEADER_FILES += thazardptrmanager.h
+HEADER_FILES += tsessionmanager.h
 HEADER_FILES += tatomic.h
 HEADER_FILES += tatomicptr.h
 HEADER_FILES += tdebug.h
 HEADER_FILES += tbackgroundprocess.h
 HEADER_FILES += tbackgroundprocesshandler.h
 HEADER_FILES += tcache.h
+HEADER_FILES += tfragmentcache.h
 HEADER_FILES += thttpclient.h
 HEADER_FILES += toauth2client.h
 HEADER_FILES += turlroute.h
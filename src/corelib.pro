@@ -106,6 +106,8 @@ HEADERS += tthreadapplicationserver.h
 SOURCES += tthreadapplicationserver.cpp
 HEADERS += tactioncontext.h
 SOURCES += tactioncontext.cpp
+HEADERS += tdispatcher.h
+SOURCES += tdispatcher.cpp
 HEADERS += tdatabasecontext.h
 SOURCES += tdatabasecontext.cpp
 HEADERS += tactionthread.h
@@ -116,6 +118,12 @@ HEADERS += thttpclient.h
 SOURCES += thttpclient.cpp
 HEADERS += tsendbuffer.h
 SOURCES += tsendbuffer.cpp
+HEADERS += trangefile.h
+SOURCES += trangefile.cpp
+HEADERS += tstaticfilecache.h
+SOURCES += tstaticfilecache.cpp
+HEADERS += tresponsecache.h
+SOURCES += tresponsecache.cpp
 HEADERS += tabstractcontroller.h
 SOURCES += tabstractcontroller.cpp
 HEADERS += tactioncontroller.h
@@ -170,6 +178,8 @@ HEADERS += tactionhelper.h
 SOURCES += tactionhelper.cpp
 HEADERS += tviewhelper.h
 SOURCES += tviewhelper.cpp
+HEADERS += tassetmanifest.h
+SOURCES += tassetmanifest.cpp
 HEADERS += toption.h
 SOURCES += toption.cpp
 HEADERS += ttemporaryfile.h
@@ -314,6 +324,8 @@ HEADERS += tdebug.h
 SOURCES += tdebug.cpp
 HEADERS += tjsonutil.h
 SOURCES += tjsonutil.cpp
+HEADERS += tjsonwriter.h
+SOURCES += tjsonwriter.cpp
 HEADERS += tjsloader.h
 SOURCES += tjsloader.cpp
 HEADERS += tjsmodule.h
@@ -324,6 +336,12 @@ HEADERS += treactcomponent.h
 SOURCES += treactcomponent.cpp
 HEADERS += tcache.h
 SOURCES += tcache.cpp
+HEADERS += tlocalcache.h
+SOURCES += tlocalcache.cpp
+HEADERS += tcachecompressor.h
+SOURCES += tcachecompressor.cpp
+HEADERS += tfragmentcache.h
+SOURCES += tfragmentcache.cpp
 HEADERS += tcachefactory.h
 SOURCES += tcachefactory.cpp
 HEADERS += tcachestore.h
@@ -371,7 +389,6 @@ HEADERS += tfnamespace.h
 HEADERS += tdeclexport.h
 HEADERS += tfcore.h
 HEADERS += tfexception.h
-HEADERS += tdispatcher.h
 HEADERS += tloggerplugin.h
 HEADERS += tsessionobject.h
 HEADERS += tsessionmongoobject.h
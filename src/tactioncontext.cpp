@@ -8,7 +8,10 @@
 #include "tabstractwebsocket.h"
 #include "thttpsocket.h"
 #include "tpublisher.h"
+#include "trangefile.h"
+#include "tresponsecache.h"
 #include "tsessionmanager.h"
+#include "tstaticfilecache.h"
 #include "tsystemglobal.h"
 #include "turlroute.h"
 #include <QHostAddress>
@@ -24,13 +27,79 @@
 #include <THttpUtility>
 #include <TSessionStore>
 #include <TWebApplication>
+#include <memory>
 #include <thread>
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
 
 
 namespace {
 // Stores a pointer to current action context into TLS
 thread_local TActionContext *actionContextPtrTls = nullptr;
 
+// Strong validator built from inode, size and modification time
+QByteArray entityTag(const QFileInfo &fileInfo)
+{
+    uint64_t inode = 0;
+    int64_t mtime = fileInfo.lastModified().toMSecsSinceEpoch();
+#ifdef Q_OS_UNIX
+    struct stat st;
+    if (::stat(QFile::encodeName(fileInfo.absoluteFilePath()).constData(), &st) == 0) {
+        inode = st.st_ino;
+    }
+#endif
+
+    QByteArray etag;
+    etag.reserve(64);
+    etag += '"';
+    etag += QByteArray::number((qulonglong)inode, 16);
+    etag += '-';
+    etag += QByteArray::number(fileInfo.size(), 16);
+    etag += '-';
+    etag += QByteArray::number(mtime, 16);
+    etag += '"';
+    return etag;
+}
+
+// Weak comparison for If-None-Match
+bool matchEntityTag(const QByteArray &ifNoneMatch, const QByteArray &etag)
+{
+    const QList<QByteArray> tags = ifNoneMatch.split(',');
+    for (auto &t : tags) {
+        QByteArray tag = t.trimmed();
+        if (tag == "*") {
+            return true;
+        }
+        if (tag.startsWith("W/")) {
+            tag.remove(0, 2);
+        }
+        if (tag == etag) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Evaluates If-Range; a range request is served only if the validator is current
+bool isRangeApplicable(const QByteArray &ifRange, const QByteArray &etag, const QDateTime &lastModified)
+{
+    QByteArray value = ifRange.trimmed();
+    if (value.isEmpty()) {
+        return true;
+    }
+
+    if (value.startsWith('"')) {
+        return value == etag;  // strong comparison
+    }
+    if (value.startsWith("W/")) {
+        return false;
+    }
+
+    QDateTime dt = THttpUtility::fromHttpDateTimeString(value);
+    return dt.isValid() && dt.toMSecsSinceEpoch() / 1000 == lastModified.toMSecsSinceEpoch() / 1000;
+}
+
 }
 
 /*!
@@ -68,11 +137,13 @@ void TActionContext::execute(THttpRequest &request)
     static const uint ListenPort = Tf::appSettings()->value(Tf::ListenPort).toUInt();
     static const bool EnableCsrfProtectionModuleFlag = Tf::appSettings()->value(Tf::EnableCsrfProtectionModule).toBool();
     static const bool SessionAutoIdRegeneration = Tf::appSettings()->value(Tf::SessionAutoIdRegeneration).toBool();
+    static const bool PrecompressedFiles = Tf::appSettings()->value(Tf::HttpCompressionPrecompressedFiles).toBool();
 
     THttpResponseHeader responseHeader;
 
     try {
         _httpRequest = &request;
+        _chunkedResponseBytes = -1;
         const THttpRequestHeader &reqHeader = _httpRequest->header();
 
         // Access log
@@ -94,13 +165,24 @@ void TActionContext::execute(THttpRequest &request)
 
         // HTTP method
         Tf::HttpMethod method = _httpRequest->method();
-        QString path = THttpUtility::fromUrlEncoding(reqHeader.path().mid(0, reqHeader.path().indexOf('?')));
 
         if (LimitRequestBodyBytes > 0 && reqHeader.contentLength() > (uint)LimitRequestBodyBytes) {
             tSystemWarn("Content-Length: {}  LimitRequestBodyBytes:{}", reqHeader.contentLength(), LimitRequestBodyBytes);
             throw ClientErrorException((int)Tf::StatusCode::RequestEntityTooLarge, __FILE__, __LINE__);  // Request Entity Too Large
         }
 
+        // Static file in memory
+        if (method == Tf::HttpMethod::Get && TStaticFileCache::isEnabled()) {
+            int64_t responseBytes = writeCachedFileResponse();
+            if (responseBytes >= 0) {
+                accessLogger.setResponseBytes(responseBytes);
+                accessLogger.write();  // Writes access log
+                return;
+            }
+        }
+
+        QString path = THttpUtility::fromUrlEncoding(reqHeader.path().mid(0, reqHeader.path().indexOf('?')));
+
         // Routing info exists?
         QStringList components = TUrlRoute::splitPath(path);
         TRouting route = TUrlRoute::instance().findRouting(method, components);
@@ -127,6 +209,28 @@ void TActionContext::execute(THttpRequest &request)
             }
         }
 
+        // Cached response of the route, not for a request with a session
+        if (route.cache.seconds > 0 && method == Tf::HttpMethod::Get && _httpRequest->cookie(TSession::sessionName()).isEmpty()) {
+            QByteArray key = TResponseCache::key(route, *_httpRequest);
+            bool renderer;
+            auto cached = TResponseCache::instance().acquire(key, &renderer);
+            if (cached) {
+                THttpResponseHeader header = cached->header;
+                QByteArray body = cached->body;
+                QBuffer buffer(&body);
+                int64_t responseBytes = writeResponse(header, &buffer, body.length());
+                accessLogger.setResponseBytes(responseBytes);
+                accessLogger.setStatusCode(header.statusCode());
+                accessLogger.write();  // Writes access log
+                return;
+            }
+
+            if (renderer) {
+                _responseCacheKey = key;
+                _responseCacheSeconds = route.cache.seconds;
+            }
+        }
+
         // Call controller method
         TDispatcher<TActionController> ctlrDispatcher(route.controller);
         _currController = ctlrDispatcher.object();
@@ -211,25 +315,36 @@ void TActionContext::execute(THttpRequest &request)
                 tSystemDebug("canonicalPath : {}", canonicalPath);
 
                 if (fi.isFile() && fi.isReadable()) {
-                    // Check "If-Modified-Since" header for caching
-                    bool sendfile = true;
-                    QByteArray ifModifiedSince = reqHeader.rawHeader(QByteArrayLiteral("If-Modified-Since"));
-
-                    if (!ifModifiedSince.isEmpty()) {
-                        QDateTime dt = THttpUtility::fromHttpDateTimeString(ifModifiedSince);
-                        if (dt.isValid()) {
-                            sendfile = (dt.toMSecsSinceEpoch() / 1000 != fi.lastModified().toMSecsSinceEpoch() / 1000);
+                    QByteArray type = Tf::app()->internetMediaType(fi.suffix());
+                    QFileInfo precompressed;
+                    bool sent = false;
+
+                    if (PrecompressedFiles) {
+                        // Precompressed file next to the file
+                        QFile gzPath(reqPath.fileName() + QLatin1String(".gz"));
+                        QFileInfo gzfi(gzPath);
+                        if (gzfi.isFile() && gzfi.isReadable() && gzfi.lastModified() >= fi.lastModified()) {
+                            precompressed = gzfi;
+                            addVaryAcceptEncoding(responseHeader);
+                            if (_httpRequest->acceptsEncoding(QByteArrayLiteral("gzip"))) {
+                                responseHeader.setRawHeader(QByteArrayLiteral("Content-Encoding"), QByteArrayLiteral("gzip"));
+                                responseBytes = writeFileResponse(responseHeader, type, &gzPath, gzfi);
+                                sent = true;
+                            }
                         }
                     }
 
-                    if (sendfile) {
+                    if (!sent) {
                         // Sends a request file
-                        responseHeader.setRawHeader(QByteArrayLiteral("Last-Modified"), THttpUtility::toHttpDateTimeString(fi.lastModified()));
-                        QByteArray type = Tf::app()->internetMediaType(fi.suffix());
-                        responseBytes = writeResponse(Tf::StatusCode::OK, responseHeader, type, &reqPath, reqPath.size());
-                    } else {
-                        // Not send the data
-                        responseBytes = writeResponse(Tf::StatusCode::NotModified, responseHeader);
+                        responseBytes = writeFileResponse(responseHeader, type, &reqPath, fi);
+                    }
+
+                    if (TStaticFileCache::isEnabled() && responseHeader.statusCode() == Tf::StatusCode::OK && fi.size() <= TStaticFileCache::maxFileSize()) {
+                        const QByteArray &reqPathBytes = reqHeader.path();
+                        QByteArray cachePath = reqPathBytes.mid(0, reqPathBytes.indexOf('?'));
+                        if (!TStaticFileCache::instance().isRejected(cachePath, fi.size(), fi.lastModified().toMSecsSinceEpoch())) {
+                            cacheStaticFile(cachePath, fi, type, precompressed);
+                        }
                     }
                 } else {
                     if (!route.exists) {
@@ -255,9 +370,15 @@ void TActionContext::execute(THttpRequest &request)
     } catch (ClientErrorException &e) {
         Tf::warn("Caught {}: status code:{}", e.className(), e.statusCode());
         tSystemWarn("Caught {}: status code:{}", e.className(), e.statusCode());
-        int responseBytes = writeResponse(static_cast<Tf::StatusCode>(e.statusCode()), responseHeader);
-        accessLogger.setResponseBytes(responseBytes);
-        accessLogger.setStatusCode(e.statusCode());
+        if (isChunkedResponseStarted()) {
+            // The response header has been sent already
+            closeSocket();
+            accessLogger.setResponseBytes(_chunkedResponseBytes);
+        } else {
+            int responseBytes = writeResponse(static_cast<Tf::StatusCode>(e.statusCode()), responseHeader);
+            accessLogger.setResponseBytes(responseBytes);
+            accessLogger.setStatusCode(e.statusCode());
+        }
     } catch (TfException &e) {
         Tf::error("Caught {}: {}  [{}:{}]", e.className(), e.message(), e.fileName(), e.lineNumber());
         tSystemError("Caught {}: {}  [{}:{}]", e.className(), e.message(), e.fileName(), e.lineNumber());
@@ -272,6 +393,11 @@ void TActionContext::execute(THttpRequest &request)
         accessLogger.setStatusCode(Tf::StatusCode::InternalServerError);
     }
 
+    if (!_responseCacheKey.isEmpty()) {
+        TResponseCache::instance().release(_responseCacheKey);
+        _responseCacheKey.clear();
+    }
+
     accessLogger.write();  // Writes access log
     _currController = nullptr;
 }
@@ -293,7 +419,7 @@ void TActionContext::release()
 }
 
 
-void TActionContext::flushResponse(TActionController *controller, bool immediate)
+void TActionContext::storeSession(TActionController *controller)
 {
     static const QString SessionCookiePath = Tf::appSettings()->value(Tf::SessionCookiePath).toString().trimmed();
     static const QString SessionCookieDomain = Tf::appSettings()->value(Tf::SessionCookieDomain).toString().trimmed();
@@ -303,6 +429,43 @@ void TActionContext::flushResponse(TActionController *controller, bool immediate
         return maxagestr.toInt();
     }());
 
+    // Writes the session only if modified, or touches it to extend the expiry
+    TSession &session = controller->session();
+    bool stored;
+    if (session.isModified()) {
+        stored = TSessionManager::instance().store(session);
+    } else if (TSessionManager::instance().isTouchRequired(session)) {
+        stored = TSessionManager::instance().touch(session);
+    } else {
+        return;
+    }
+
+    if (Q_LIKELY(stored)) {
+        controller->addCookie(TSession::sessionName(), controller->session().id(), SessionCookieMaxAge,
+            SessionCookiePath, SessionCookieDomain, false, true, SessionCookieSameSite);
+
+        // Commits a transaction for session
+        commitTransactions();
+
+    } else {
+        tSystemError("Failed to store a session");
+    }
+}
+
+
+void TActionContext::setCharsetIntoContentType(TActionController *controller)
+{
+    QByteArray ctype = controller->_response.header().contentType().toLower();
+    if (ctype.startsWith("text") && !ctype.contains("charset")) {
+        ctype += "; charset=";
+        ctype += QStringConverter::nameForEncoding(Tf::app()->encodingForHttpOutput());
+        controller->_response.header().setContentType(ctype);
+    }
+}
+
+
+void TActionContext::flushResponse(TActionController *controller, bool immediate)
+{
     if (!controller) {
         return;
     }
@@ -319,19 +482,9 @@ void TActionContext::flushResponse(TActionController *controller, bool immediate
         commitTransactions();
     }
 
-    // Session store
-    if (controller->sessionEnabled()) {
-        bool stored = TSessionManager::instance().store(controller->session());
-        if (Q_LIKELY(stored)) {
-            controller->addCookie(TSession::sessionName(), controller->session().id(), SessionCookieMaxAge,
-                SessionCookiePath, SessionCookieDomain, false, true, SessionCookieSameSite);
-
-            // Commits a transaction for session
-            commitTransactions();
-
-        } else {
-            tSystemError("Failed to store a session");
-        }
+    // Session store, already done at the start of a chunked response
+    if (controller->sessionEnabled() && !isChunkedResponseStarted()) {
+        storeSession(controller);
     }
 
     // KVS pool
@@ -391,16 +544,18 @@ void TActionContext::flushResponse(TActionController *controller, bool immediate
     }
 
     // Sets charset to the content-type
-    QByteArray ctype = controller->_response.header().contentType().toLower();
-    if (ctype.startsWith("text") && !ctype.contains("charset")) {
-        ctype += "; charset=";
-        ctype += QStringConverter::nameForEncoding(Tf::app()->encodingForHttpOutput());
-        controller->_response.header().setContentType(ctype);
-    }
+    setCharsetIntoContentType(controller);
 
     // Sets the default status code of HTTP response
-    int responseBytes = 0;
-    if (Q_UNLIKELY(controller->_response.isBodyNull())) {
+    int64_t responseBytes = 0;
+    if (isChunkedResponseStarted()) {
+        // Terminates the chunked response
+        finishChunkedResponse();
+        responseBytes = _chunkedResponseBytes;
+        _chunkedResponseBytes = -1;
+        accessLogger.setStatusCode(controller->statusCode());
+
+    } else if (Q_UNLIKELY(controller->_response.isBodyNull())) {
         THttpResponseHeader header;
         responseBytes = writeResponse(Tf::StatusCode::NotFound, header);
         accessLogger.setStatusCode(header.statusCode());
@@ -408,10 +563,20 @@ void TActionContext::flushResponse(TActionController *controller, bool immediate
     } else {
         controller->_response.header().setStatusLine(controller->statusCode(), THttpUtility::getResponseReasonPhrase(controller->statusCode()));
 
-        // Writes a response and access log
-        int64_t bodyLength = (controller->_response.header().contentLength() > 0) ? controller->_response.header().contentLength() : controller->response().bodyLength();
-        responseBytes = writeResponse(controller->_response.header(), controller->_response.bodyIODevice(), bodyLength);
-        accessLogger.setStatusCode(controller->statusCode());
+        QFile *file = qobject_cast<QFile *>(controller->_response.bodyIODevice());
+        if (file && controller->statusCode() == Tf::StatusCode::OK && !autoRemoveFiles.contains(file->fileName())) {
+            // Sends the file with validators and byte ranges
+            responseBytes = writeFileResponse(controller->_response.header(), QByteArray(), file, QFileInfo(*file));
+        } else {
+            if (!_responseCacheKey.isEmpty()) {
+                storeCachedResponse(controller);
+            }
+
+            // Writes a response and access log
+            int64_t bodyLength = (controller->_response.header().contentLength() > 0) ? controller->_response.header().contentLength() : controller->response().bodyLength();
+            responseBytes = writeResponse(controller->_response.header(), controller->_response.bodyIODevice(), bodyLength);
+        }
+        accessLogger.setStatusCode(controller->_response.header().statusCode());
     }
     accessLogger.setResponseBytes(responseBytes);
 
@@ -465,6 +630,36 @@ int64_t TActionContext::writeResponse(Tf::StatusCode statusCode, THttpResponseHe
 
 int64_t TActionContext::writeResponse(THttpResponseHeader &header, QIODevice *body, int64_t length)
 {
+    QByteArray compressed;
+    std::unique_ptr<QBuffer> compressedBuffer;
+
+    // Compresses the body according to Accept-Encoding
+    QBuffer *buffer = dynamic_cast<QBuffer *>(body);
+    if (buffer && _httpRequest && isCompressible(header.contentType(), buffer->size())) {
+        const Tf::StatusCode code = header.statusCode();
+        if (code != Tf::StatusCode::PartialContent && code != Tf::StatusCode::NoContent && code != Tf::StatusCode::NotModified) {
+            addVaryAcceptEncoding(header);
+
+            if (!header.hasRawHeader(QByteArrayLiteral("Content-Encoding"))) {
+                QByteArray coding;
+                if (_httpRequest->acceptsEncoding(QByteArrayLiteral("gzip"))) {
+                    coding = QByteArrayLiteral("gzip");
+                    compressed = Tf::gzipCompress(buffer->data(), compressionLevel());
+                } else if (_httpRequest->acceptsEncoding(QByteArrayLiteral("deflate"))) {
+                    coding = QByteArrayLiteral("deflate");
+                    compressed = Tf::deflateCompress(buffer->data(), compressionLevel());
+                }
+
+                if (!compressed.isEmpty()) {
+                    header.setRawHeader(QByteArrayLiteral("Content-Encoding"), coding);
+                    compressedBuffer = std::make_unique<QBuffer>(&compressed);
+                    body = compressedBuffer.get();
+                    length = compressed.length();
+                }
+            }
+        }
+    }
+
 
     header.setContentLength(length);
     tSystemDebug("content-length: {}", (qint64)header.contentLength());
@@ -476,6 +671,390 @@ int64_t TActionContext::writeResponse(THttpResponseHeader &header, QIODevice *bo
 }
 
 
+/*!
+  Starts a response whose body is sent in pieces as they are produced,
+  with "Transfer-Encoding: chunked". The session is stored and the
+  response header of the \a controller is sent immediately.
+  For an HTTP/1.0 client, the body is sent as is and the connection is
+  closed at the end of the response.
+*/
+bool TActionContext::startChunkedResponse(TActionController *controller)
+{
+    if (!controller || isChunkedResponseStarted()) {
+        return false;
+    }
+
+    if (controller->sessionEnabled()) {
+        storeSession(controller);
+    }
+    setCharsetIntoContentType(controller);
+
+    const THttpRequestHeader &reqHeader = _httpRequest->header();
+    _chunkedEncoding = (reqHeader.majorVersion() > 1 || (reqHeader.majorVersion() == 1 && reqHeader.minorVersion() >= 1));
+
+    THttpResponseHeader &header = controller->_response.header();
+    header.setStatusLine(controller->statusCode(), THttpUtility::getResponseReasonPhrase(controller->statusCode()));
+    header.removeRawHeader(QByteArrayLiteral("Content-Length"));
+    if (_chunkedEncoding) {
+        header.setRawHeader(QByteArrayLiteral("Transfer-Encoding"), QByteArrayLiteral("chunked"));
+        if (keepAliveTimeout() > 0) {
+            header.setRawHeader(QByteArrayLiteral("Connection"), QByteArrayLiteral("Keep-Alive"));
+        }
+    } else {
+        header.setRawHeader(QByteArrayLiteral("Connection"), QByteArrayLiteral("close"));
+    }
+    header.setRawHeader(QByteArrayLiteral("Server"), QByteArrayLiteral("TreeFrog server"));
+    header.setCurrentDate();
+
+    if (writeRawData(header.toByteArray()) < 0) {
+        tSystemWarn("Failed to send a response header");
+        return false;
+    }
+    _chunkedResponseBytes = 0;
+    return true;
+}
+
+/*!
+  Sends the \a data as a chunk of the response started by
+  startChunkedResponse(). This blocks while the socket's send buffer is
+  full. Returns the number of bytes of the data sent, or -1 if an error
+  occurred.
+*/
+int64_t TActionContext::writeChunk(const QByteArray &data)
+{
+    if (!isChunkedResponseStarted()) {
+        return -1;
+    }
+
+    if (data.isEmpty()) {
+        return 0;  // a zero-length chunk terminates the body
+    }
+
+    int64_t res;
+    if (_chunkedEncoding) {
+        QByteArray chunk;
+        chunk.reserve(data.length() + 20);
+        chunk += QByteArray::number(data.length(), 16);
+        chunk += Tf::CRLF;
+        chunk += data;
+        chunk += Tf::CRLF;
+        res = writeRawData(chunk);
+    } else {
+        res = writeRawData(data);
+    }
+
+    if (res < 0) {
+        return -1;
+    }
+    _chunkedResponseBytes += data.length();
+    return data.length();
+}
+
+/*!
+  Terminates the chunked response.
+*/
+void TActionContext::finishChunkedResponse()
+{
+    if (_chunkedEncoding) {
+        writeRawData(QByteArrayLiteral("0\r\n\r\n"));
+    } else {
+        closeSocket();
+    }
+}
+
+/*!
+  Stores the response of the \a controller into the response cache of
+  the route. Responses other than 200, responses setting cookies except
+  the session cookie and responses marked "no-store" or "private" are
+  not stored. Responses rendered with session data, such as flash
+  messages or a CSRF token, are not stored either since they belong to
+  the client. The session cookie is not stored. For a client accepting
+  gzip, the body is compressed here and stored compressed.
+*/
+void TActionContext::storeCachedResponse(TActionController *controller)
+{
+    const THttpResponseHeader &header = controller->_response.header();
+    auto *buffer = dynamic_cast<QBuffer *>(controller->_response.bodyIODevice());
+
+    if (header.statusCode() != Tf::StatusCode::OK || !buffer) {
+        return;
+    }
+
+    if (controller->sessionEnabled() && (!controller->session().isEmpty() || controller->session().isModified())) {
+        return;
+    }
+
+    const QByteArray cacheControl = header.rawHeader(QByteArrayLiteral("Cache-Control")).toLower();
+    if (cacheControl.contains("no-store") || cacheControl.contains("private")) {
+        return;
+    }
+
+    for (auto &cookie : (const QList<TCookie> &)controller->_cookieJar.allCookies()) {
+        if (cookie.name() != TSession::sessionName()) {
+            return;
+        }
+    }
+
+    // The variant for gzip clients is stored compressed, and sent as is
+    // on a hit without compressing it again
+    QByteArray body = buffer->data();
+    if (_httpRequest->acceptsEncoding(QByteArrayLiteral("gzip")) && !header.hasRawHeader(QByteArrayLiteral("Content-Encoding"))
+        && isCompressible(header.contentType(), body.length())) {
+        QByteArray compressed = Tf::gzipCompress(body, compressionLevel());
+        if (!compressed.isEmpty()) {
+            THttpResponseHeader &responseHeader = controller->_response.header();
+            responseHeader.setRawHeader(QByteArrayLiteral("Content-Encoding"), QByteArrayLiteral("gzip"));
+            addVaryAcceptEncoding(responseHeader);
+            responseHeader.setContentLength(compressed.length());
+            controller->_response.setBody(compressed);
+            body = compressed;
+        }
+    }
+
+    THttpResponseHeader cachedHeader = header;
+    cachedHeader.removeAllRawHeaders(QByteArrayLiteral("Set-Cookie"));
+    TResponseCache::instance().store(_responseCacheKey, cachedHeader, body, _responseCacheSeconds);
+}
+
+/*!
+  Writes a 200 or 304 response of the static file cached for the request
+  path with the precomputed header. Returns the number of bytes of the
+  body, or -1 if the file is not cached or the request needs the complete
+  processing, such as a range request.
+*/
+int64_t TActionContext::writeCachedFileResponse()
+{
+    const THttpRequestHeader &reqHeader = _httpRequest->header();
+    const QByteArray &reqPath = reqHeader.path();
+    int idx = reqPath.indexOf('?');
+    auto entry = TStaticFileCache::instance().find((idx < 0) ? reqPath : reqPath.left(idx));
+
+    if (!entry || reqHeader.hasRawHeader(QByteArrayLiteral("Range"))) {
+        return -1;
+    }
+
+    bool gzip = !entry->gzip.body.isEmpty() && _httpRequest->acceptsEncoding(QByteArrayLiteral("gzip"));
+    const TStaticFileCache::Representation &rep = (gzip) ? entry->gzip : entry->identity;
+
+    // Check "If-None-Match" and "If-Modified-Since" headers for caching
+    bool notModified = false;
+    QByteArray ifNoneMatch = reqHeader.rawHeader(QByteArrayLiteral("If-None-Match"));
+    if (!ifNoneMatch.isEmpty()) {
+        notModified = matchEntityTag(ifNoneMatch, rep.etag);
+    } else {
+        QByteArray ifModifiedSince = reqHeader.rawHeader(QByteArrayLiteral("If-Modified-Since"));
+        if (!ifModifiedSince.isEmpty()) {
+            if (ifModifiedSince.trimmed() != rep.lastModified) {
+                return -1;  // compares it as date-time
+            }
+            notModified = true;
+        }
+    }
+
+    const QByteArray &header = (notModified) ? rep.notModifiedHeader : rep.header;
+    const int64_t bodyLength = (notModified) ? 0 : rep.body.length();
+
+    QByteArray response;
+    response.reserve(header.length() + bodyLength + 64);
+    response += header;
+    response += "Date: ";
+    response += THttpUtility::getUTCTimeString();
+    response += Tf::CRLF;
+    if (keepAliveTimeout() > 0) {
+        response += "Connection: Keep-Alive\r\n";
+    }
+    response += Tf::CRLF;
+    if (!notModified) {
+        response += rep.body;
+    }
+
+    accessLogger.setStatusCode((notModified) ? Tf::StatusCode::NotModified : Tf::StatusCode::OK);
+    if (writeRawData(response) < 0) {
+        closeSocket();
+        return 0;
+    }
+    return bodyLength;
+}
+
+/*!
+  Stores the static file \a fileInfo requested with \a path into the static
+  file cache, with its precompressed file \a gzipFileInfo if not empty.
+*/
+void TActionContext::cacheStaticFile(const QByteArray &path, const QFileInfo &fileInfo, const QByteArray &contentType, const QFileInfo &gzipFileInfo)
+{
+    auto readFile = [](const QFileInfo &fi) {
+        QFile file(fi.absoluteFilePath());
+        return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    };
+
+    auto entry = std::make_shared<TStaticFileCache::Entry>();
+    entry->filePath = fileInfo.absoluteFilePath();
+    entry->fileSize = fileInfo.size();
+    entry->lastModifiedMSecs = fileInfo.lastModified().toMSecsSinceEpoch();
+    entry->identity.etag = entityTag(fileInfo);
+    entry->identity.lastModified = THttpUtility::toHttpDateTimeString(fileInfo.lastModified());
+    entry->identity.body = readFile(fileInfo);
+    if (entry->identity.body.length() != entry->fileSize) {
+        return;  // being modified
+    }
+
+    // Compressed variant
+    if (!gzipFileInfo.filePath().isEmpty()) {
+        entry->gzipFilePath = gzipFileInfo.absoluteFilePath();
+        entry->gzip.etag = entityTag(gzipFileInfo);
+        entry->gzip.lastModified = THttpUtility::toHttpDateTimeString(gzipFileInfo.lastModified());
+        entry->gzip.body = readFile(gzipFileInfo);
+        if (entry->gzip.body.length() != gzipFileInfo.size()) {
+            return;  // being modified
+        }
+    } else if (isCompressible(contentType, entry->fileSize)) {
+        entry->gzip.etag = entry->identity.etag;
+        entry->gzip.etag.insert(entry->gzip.etag.length() - 1, "-gz");
+        entry->gzip.lastModified = entry->identity.lastModified;
+        entry->gzip.body = Tf::gzipCompress(entry->identity.body, compressionLevel());
+    }
+
+    const bool vary = !entry->gzip.body.isEmpty();
+    auto headerBlock = [&](const TStaticFileCache::Representation &rep, bool gzip, Tf::StatusCode statusCode) {
+        THttpResponseHeader header;
+        header.setStatusLine(statusCode, THttpUtility::getResponseReasonPhrase(statusCode));
+        if (statusCode == Tf::StatusCode::OK) {
+            header.setContentType(contentType);
+        }
+        header.setRawHeader(QByteArrayLiteral("ETag"), rep.etag);
+        header.setRawHeader(QByteArrayLiteral("Last-Modified"), rep.lastModified);
+        header.setRawHeader(QByteArrayLiteral("Accept-Ranges"), QByteArrayLiteral("bytes"));
+        if (gzip) {
+            header.setRawHeader(QByteArrayLiteral("Content-Encoding"), QByteArrayLiteral("gzip"));
+        }
+        if (vary) {
+            header.setRawHeader(QByteArrayLiteral("Vary"), QByteArrayLiteral("Accept-Encoding"));
+        }
+        header.setContentLength((statusCode == Tf::StatusCode::OK) ? rep.body.length() : 0);
+        header.setRawHeader(QByteArrayLiteral("Server"), QByteArrayLiteral("TreeFrog server"));
+        QByteArray block = header.toByteArray();
+        block.chop(2);  // the empty line is written after the Date header
+        return block;
+    };
+
+    entry->identity.header = headerBlock(entry->identity, false, Tf::StatusCode::OK);
+    entry->identity.notModifiedHeader = headerBlock(entry->identity, false, Tf::StatusCode::NotModified);
+    if (vary) {
+        entry->gzip.header = headerBlock(entry->gzip, true, Tf::StatusCode::OK);
+        entry->gzip.notModifiedHeader = headerBlock(entry->gzip, true, Tf::StatusCode::NotModified);
+    }
+
+    TStaticFileCache::instance().insert(path, entry);
+}
+
+/*!
+  Writes a 200 response of the file \a file, or a 304, 206 or 416 response
+  according to the conditional and Range headers of the request.
+  The ETag, Last-Modified and Accept-Ranges headers are set to \a header.
+*/
+int64_t TActionContext::writeFileResponse(THttpResponseHeader &header, const QByteArray &contentType, QFile *file, const QFileInfo &fileInfo)
+{
+    const THttpRequestHeader &reqHeader = _httpRequest->header();
+    const Tf::HttpMethod method = _httpRequest->method();
+    const int64_t fileSize = fileInfo.size();
+    const QDateTime lastModified = fileInfo.lastModified();
+    const QByteArray etag = entityTag(fileInfo);
+
+    header.setRawHeader(QByteArrayLiteral("ETag"), etag);
+    header.setRawHeader(QByteArrayLiteral("Last-Modified"), THttpUtility::toHttpDateTimeString(lastModified));
+    header.setRawHeader(QByteArrayLiteral("Accept-Ranges"), QByteArrayLiteral("bytes"));
+
+    if (method == Tf::HttpMethod::Get || method == Tf::HttpMethod::Head) {
+        // Check "If-None-Match" and "If-Modified-Since" headers for caching
+        bool notModified = false;
+        QByteArray ifNoneMatch = reqHeader.rawHeader(QByteArrayLiteral("If-None-Match"));
+
+        if (!ifNoneMatch.isEmpty()) {
+            notModified = matchEntityTag(ifNoneMatch, etag);
+        } else {
+            QByteArray ifModifiedSince = reqHeader.rawHeader(QByteArrayLiteral("If-Modified-Since"));
+            if (!ifModifiedSince.isEmpty()) {
+                QDateTime dt = THttpUtility::fromHttpDateTimeString(ifModifiedSince);
+                if (dt.isValid()) {
+                    notModified = (dt.toMSecsSinceEpoch() / 1000 == lastModified.toMSecsSinceEpoch() / 1000);
+                }
+            }
+        }
+
+        if (notModified) {
+            // Not send the data
+            return writeResponse(Tf::StatusCode::NotModified, header);
+        }
+    }
+
+    QByteArray rangeHeader = reqHeader.rawHeader(QByteArrayLiteral("Range"));
+    if (method != Tf::HttpMethod::Get || rangeHeader.isEmpty()
+        || !isRangeApplicable(reqHeader.rawHeader(QByteArrayLiteral("If-Range")), etag, lastModified)) {
+        // Sends the entire file
+        return writeResponse(Tf::StatusCode::OK, header, contentType, file, fileSize);
+    }
+
+    bool ok;
+    const auto ranges = TRangeFile::parseByteRanges(rangeHeader, fileSize, &ok);
+    if (!ok) {
+        // Ignores an invalid Range header
+        return writeResponse(Tf::StatusCode::OK, header, contentType, file, fileSize);
+    }
+
+    if (ranges.isEmpty()) {
+        header.setRawHeader(QByteArrayLiteral("Content-Range"), QByteArrayLiteral("bytes */") + QByteArray::number(fileSize));
+        return writeResponse(Tf::StatusCode::RequestedRangeNotSatisfiable, header);
+    }
+
+    auto contentRange = [fileSize](int64_t offset, int64_t length) {
+        QByteArray cr = "bytes ";
+        cr += QByteArray::number(offset);
+        cr += '-';
+        cr += QByteArray::number(offset + length - 1);
+        cr += '/';
+        cr += QByteArray::number(fileSize);
+        return cr;
+    };
+
+    QList<TRangeFile::Range> bodyRanges;
+    QByteArray epilogue;
+    QByteArray ctype = contentType;
+
+    if (ranges.count() == 1) {
+        // Single part
+        header.setRawHeader(QByteArrayLiteral("Content-Range"), contentRange(ranges[0].first, ranges[0].second));
+        bodyRanges << TRangeFile::Range {ranges[0].first, ranges[0].second, QByteArray()};
+
+    } else {
+        // multipart/byteranges
+        const QByteArray partType = (contentType.isEmpty()) ? header.contentType() : contentType;
+        const QByteArray boundary = QByteArrayLiteral("tf_") + QByteArray::number((qulonglong)Tf::rand64_r(), 36);
+
+        for (auto &r : ranges) {
+            QByteArray prologue;
+            prologue.reserve(128);
+            prologue += "\r\n--";
+            prologue += boundary;
+            prologue += "\r\n";
+            if (!partType.isEmpty()) {
+                prologue += "Content-Type: ";
+                prologue += partType;
+                prologue += "\r\n";
+            }
+            prologue += "Content-Range: ";
+            prologue += contentRange(r.first, r.second);
+            prologue += "\r\n\r\n";
+            bodyRanges << TRangeFile::Range {r.first, r.second, prologue};
+        }
+        epilogue = QByteArrayLiteral("\r\n--") + boundary + QByteArrayLiteral("--\r\n");
+        ctype = QByteArrayLiteral("multipart/byteranges; boundary=") + boundary;
+    }
+
+    TRangeFile body(file->fileName(), bodyRanges, epilogue);
+    return writeResponse(Tf::StatusCode::PartialContent, header, ctype, &body, body.totalLength());
+}
+
+
 void TActionContext::emitError(int)
 {
 }
@@ -500,6 +1079,56 @@ QHostAddress TActionContext::originatingClientAddress() const
     return _httpRequest->originatingClientAddress();
 }
 
+/*!
+  Returns the compression level of HTTP responses, from 1 to 9.
+ */
+int TActionContext::compressionLevel()
+{
+    static const int level = std::clamp(Tf::appSettings()->value(Tf::HttpCompressionLevel).toInt(), 1, 9);
+    return level;
+}
+
+/*!
+  Returns true if the response compression is enabled and a body of
+  \a length bytes of the \a contentType is to be compressed; otherwise
+  returns false.
+ */
+bool TActionContext::isCompressible(const QByteArray &contentType, int64_t length)
+{
+    static const bool enable = Tf::appSettings()->value(Tf::HttpCompressionEnable).toBool();
+    static const int64_t minimumSize = Tf::appSettings()->value(Tf::HttpCompressionMinimumSize).toLongLong();
+    static const QSet<QByteArray> mimeTypes = []() {
+        QSet<QByteArray> types;
+        const QStringList lst = Tf::appSettings()->value(Tf::HttpCompressionMimeTypes).toString().split(';', Qt::SkipEmptyParts);
+        for (auto &type : lst) {
+            types << type.trimmed().toLower().toLatin1();
+        }
+        return types;
+    }();
+
+    if (!enable || length < std::max<int64_t>(minimumSize, 1)) {
+        return false;
+    }
+
+    int idx = contentType.indexOf(';');
+    QByteArray type = (idx < 0) ? contentType : contentType.left(idx);
+    return mimeTypes.contains(type.trimmed().toLower());
+}
+
+/*!
+  Adds "Accept-Encoding" to the Vary header of the \a header, keeping
+  the field names already in it.
+ */
+void TActionContext::addVaryAcceptEncoding(THttpResponseHeader &header)
+{
+    QByteArray vary = header.rawHeader(QByteArrayLiteral("Vary"));
+    if (vary.isEmpty()) {
+        header.setRawHeader(QByteArrayLiteral("Vary"), QByteArrayLiteral("Accept-Encoding"));
+    } else if (!vary.toLower().contains("accept-encoding") && vary.trimmed() != "*") {
+        header.setRawHeader(QByteArrayLiteral("Vary"), vary + QByteArrayLiteral(", Accept-Encoding"));
+    }
+}
+
 /*!
   Returns the keep-alive timeout in seconds.
  */
@@ -8,6 +8,8 @@
 #include <QStringList>
 
 class QIODevice;
+class QFile;
+class QFileInfo;
 class QHostAddress;
 class THttpResponseHeader;
 class THttpSocket;
@@ -32,7 +34,13 @@ public:
     const THttpRequest &httpRequest() const override { return *_httpRequest; }
     THttpRequest &httpRequest() override { return *_httpRequest; }
     void flushResponse(TActionController *controller, bool immediate);
+    bool startChunkedResponse(TActionController *controller);
+    int64_t writeChunk(const QByteArray &data);
+    bool isChunkedResponseStarted() const { return _chunkedResponseBytes >= 0; }
     static int keepAliveTimeout();
+    static int compressionLevel();
+    static bool isCompressible(const QByteArray &contentType, int64_t length);
+    static void addVaryAcceptEncoding(THttpResponseHeader &header);
     static TActionContext *currentActionContext();
     static void setCurrentActionContext(TActionContext *context);
 
@@ -43,8 +51,10 @@ protected:
     int64_t writeResponse(Tf::StatusCode statusCode, THttpResponseHeader &header);
     int64_t writeResponse(Tf::StatusCode statusCode, THttpResponseHeader &header, const QByteArray &contentType, QIODevice *body, int64_t length);
     int64_t writeResponse(THttpResponseHeader &header, QIODevice *body, int64_t length);
+    int64_t writeFileResponse(THttpResponseHeader &header, const QByteArray &contentType, QFile *file, const QFileInfo &fileInfo);
 
     virtual int64_t writeResponse(THttpResponseHeader &, QIODevice *) { return 0; }
+    virtual int64_t writeRawData(const QByteArray &) { return -1; }
     virtual void flushSocket() { }
     virtual void closeSocket() { }
     virtual void emitError(int socketError);
@@ -55,9 +65,20 @@ protected:
     TAccessLogger accessLogger;
 
 private:
+    void storeSession(TActionController *controller);
+    void setCharsetIntoContentType(TActionController *controller);
+    void finishChunkedResponse();
+    int64_t writeCachedFileResponse();
+    void storeCachedResponse(TActionController *controller);
+    void cacheStaticFile(const QByteArray &path, const QFileInfo &fileInfo, const QByteArray &contentType, const QFileInfo &gzipFileInfo);
+
     TActionController *_currController {nullptr};
     QList<TTemporaryFile *> _tempFiles;
     THttpRequest *_httpRequest {nullptr};
+    int64_t _chunkedResponseBytes {-1};  // -1: not chunked response
+    bool _chunkedEncoding {true};
+    QByteArray _responseCacheKey;  // key of the response to be cached
+    int _responseCacheSeconds {0};
 
     T_DISABLE_COPY(TActionContext)
     T_DISABLE_MOVE(TActionContext)
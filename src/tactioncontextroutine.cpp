@@ -7,9 +7,17 @@
 
 #include "tactioncontextroutine.h"
 #include "THttpRequest"
+#include "tfcore.h"
 #include <QMutexLocker>
 
 
+TActionContextRoutine::TActionContextRoutine(int socketDescriptor) :
+    TActionContext()
+{
+    TActionContext::socketDesc = socketDescriptor;
+}
+
+
 void TActionContextRoutine::start(QByteArray &readBuffer)
 {
     TActionContext::setCurrentActionContext(this);
@@ -35,9 +43,55 @@ int64_t TActionContextRoutine::writeResponse(THttpResponseHeader &header, QIODev
             result.response += buf->buffer();
         } else if (auto *file = qobject_cast<QFile*>(body); file) {
             result.fileName = file->fileName();
+        } else if (auto *rangeFile = dynamic_cast<TRangeFile*>(body); rangeFile) {
+            result.fileName = rangeFile->fileName();
+            result.fileRanges = rangeFile->ranges();
+            result.fileEpilogue = rangeFile->epilogue();
         } else {
             tSystemError("Invalid body [{}:{}]", __FILE__, __LINE__);
         }
     }
     return 0;
 }
+
+/*!
+  Writes the data to the socket directly while the coroutine waits for
+  this routine; used for chunked responses.
+*/
+int64_t TActionContextRoutine::writeRawData(const QByteArray &data)
+{
+    const int sd = TActionContext::socketDesc;
+    int64_t total = 0;
+
+    if (sd <= 0) {
+        return -1;
+    }
+
+    while (total < data.length()) {
+        int res = tf_poll_send(sd, 5000);
+        if (res <= 0) {
+            tSystemWarn("Timed out sending data  socket:{}", sd);
+            return -1;
+        }
+
+        int len = tf_send(sd, data.data() + total, data.length() - total);
+        if (len < 0) {
+            if (errno == EAGAIN) {
+                continue;
+            }
+            tSystemWarn("socket write error: socket:{} errno:{}", sd, errno);
+            return -1;
+        }
+        total += len;
+    }
+    return total;
+}
+
+
+void TActionContextRoutine::closeSocket()
+{
+    // The coroutine closes the socket after the peer is disconnected
+    if (TActionContext::socketDesc > 0) {
+        ::shutdown(TActionContext::socketDesc, SHUT_RDWR);
+    }
+}
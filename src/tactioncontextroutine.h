@@ -1,10 +1,11 @@
 #pragma once
 #include <TActionContext>
+#include "trangefile.h"
 
 
 class T_CORE_EXPORT TActionContextRoutine : public TActionContext {
 public:
-    TActionContextRoutine() = default;
+    explicit TActionContextRoutine(int socketDescriptor = 0);
     ~TActionContextRoutine() = default;
     void start(QByteArray &readBuffer);
 
@@ -12,10 +13,14 @@ public:
     public:
         QByteArray response;
         QString fileName;
+        QList<TRangeFile::Range> fileRanges;  // empty for the entire file
+        QByteArray fileEpilogue;
     } result;
 
 protected:
     virtual int64_t writeResponse(THttpResponseHeader &, QIODevice *) override;
+    virtual int64_t writeRawData(const QByteArray &data) override;
+    virtual void closeSocket() override;
 
     T_DISABLE_COPY(TActionContextRoutine)
     T_DISABLE_MOVE(TActionContextRoutine)
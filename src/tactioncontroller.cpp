@@ -23,6 +23,7 @@
 #include <TCache>
 #include <TDispatcher>
 #include <TFormValidator>
+#include <TFragmentCache>
 #include <TSession>
 #include <QMessageAuthenticationCode>
 #include <QJsonArray>
@@ -35,6 +36,7 @@ const QString QUEUED_FLASH_SESSION_KEY("_flashVariants");
 const QString FLASH_VARS_SESSION_KEY("_activeFlash");
 const QString LOGIN_USER_NAME_KEY("_loginUserName");
 const QByteArray DEFAULT_CONTENT_TYPE("text/html");
+const QByteArray GZIP_CACHE_KEY_SUFFIX(":gzip");
 
 /*!
   \class TActionController
@@ -436,13 +438,23 @@ bool TActionController::renderAndCache(const QByteArray &key, int seconds, const
     if ((int)_rendered > 0) {
         QByteArray responseMsg = response().body();
         Tf::cache()->set(key, responseMsg, seconds);
+
+        // Caches the compressed body as well
+        if (TActionContext::isCompressible(contentType(), responseMsg.length())) {
+            QByteArray gzip = Tf::gzipCompress(responseMsg, TActionContext::compressionLevel());
+            if (!gzip.isEmpty()) {
+                Tf::cache()->set(key + GZIP_CACHE_KEY_SUFFIX, gzip, seconds);
+            }
+        }
     }
     return (bool)_rendered;
 }
 
 /*!
   Renders the template cached with the \a key. If no item with the \a key
-  found, returns false.
+  found, returns false. The gzipped variant is rendered only for a client
+  accepting gzip; the route response cache keeps it apart from the
+  identity body.
   To use this function, enable cache module in application.ini.
   \sa renderAndCache()
 */
@@ -453,6 +465,18 @@ bool TActionController::renderOnCache(const QByteArray &key)
         return false;
     }
 
+    // Compressed body
+    if (TActionContext::isCompressible(contentType(), INT64_MAX) && httpRequest().acceptsEncoding(QByteArrayLiteral("gzip"))) {
+        auto gzip = Tf::cache()->get(key + GZIP_CACHE_KEY_SUFFIX);
+        if (!gzip.isEmpty()) {
+            _response.setBody(gzip);
+            _response.header().setRawHeader(QByteArrayLiteral("Content-Encoding"), QByteArrayLiteral("gzip"));
+            TActionContext::addVaryAcceptEncoding(_response.header());
+            _rendered = RenderState::Rendered;
+            return (bool)_rendered;
+        }
+    }
+
     auto responseMsg = Tf::cache()->get(key);
     if (responseMsg.isEmpty()) {
         return false;
@@ -471,6 +495,27 @@ bool TActionController::renderOnCache(const QByteArray &key)
 void TActionController::removeCache(const QByteArray &key)
 {
     Tf::cache()->remove(key);
+    Tf::cache()->remove(key + GZIP_CACHE_KEY_SUFFIX);
+}
+
+/*!
+  Removes the fragment of views with the \a key from the cache; the
+  fragment is rendered in the '<%#cache key, seconds %>' block.
+  \sa removeFragmentsByTag()
+*/
+void TActionController::removeFragment(const QByteArray &key)
+{
+    TFragmentCache::remove(key);
+}
+
+/*!
+  Removes all the fragments of views associated with the \a tag from
+  the cache.
+  \sa removeFragment()
+*/
+void TActionController::removeFragmentsByTag(const QByteArray &tag)
+{
+    TFragmentCache::removeTag(tag);
 }
 
 /*!
@@ -516,7 +561,7 @@ QByteArray TActionController::renderView(TActionView *view)
     if (!layoutEnabled()) {
         // Renders without layout
         tSystemDebug("Renders without layout");
-        return QStringEncoder(Tf::app()->encodingForHttpOutput()).encode(view->toString());
+        return encodeView(view);
     }
 
     // Displays with layout
@@ -534,7 +579,7 @@ QByteArray TActionController::renderView(TActionView *view)
             layoutView = defLayoutDispatcher.object();
             if (!layoutView) {
                 tSystemDebug("Not found default layout. Renders without layout.");
-                return QStringEncoder(Tf::app()->encodingForHttpOutput()).encode(view->toString());
+                return encodeView(view);
             }
         }
     }
@@ -543,7 +588,20 @@ QByteArray TActionController::renderView(TActionView *view)
     layoutView->setVariantMap(allVariants());
     layoutView->setController(this);
     layoutView->setSubActionView(view);
-    return QStringEncoder(Tf::app()->encodingForHttpOutput()).encode(layoutView->toString());
+    return encodeView(layoutView);
+}
+
+/*!
+  Returns the content of the \a view encoded in the encoding for HTTP
+  output. If it is UTF-8, the UTF-8 buffer of the view is used as it is.
+*/
+QByteArray TActionController::encodeView(TActionView *view)
+{
+    auto encoding = Tf::app()->encodingForHttpOutput();
+    if (encoding == QStringConverter::Utf8) {
+        return view->toUtf8();
+    }
+    return QStringEncoder(encoding).encode(view->toString());
 }
 
 /*!
@@ -660,6 +718,92 @@ bool TActionController::sendData(const QByteArray &data, const QByteArray &conte
     return true;
 }
 
+/*!
+  Starts sending a response in pieces with "Transfer-Encoding: chunked";
+  the response header is sent immediately and each piece written by
+  writeStream() reaches the client as it is produced. The response ends
+  when the action returns.
+  \sa writeStream()
+*/
+bool TActionController::startStream(const QByteArray &contentType, const QString &name)
+{
+    if ((int)_rendered > 0) {
+        Tf::warn("Has rendered already: {}", (className() + '#' + activeAction()));
+        return false;
+    }
+
+    if (!name.isEmpty()) {
+        QByteArray filename;
+        filename += "attachment; filename=\"";
+        filename += name.toUtf8();
+        filename += '"';
+        _response.header().setRawHeader("Content-Disposition", filename);
+    }
+    setContentType(contentType);
+
+    if (!context()->startChunkedResponse(this)) {
+        return false;
+    }
+    _rendered = RenderState::Streaming;
+    return true;
+}
+
+/*!
+  Writes the \a data to the stream started by startStream(). This blocks
+  while the client is slower than the data production. Returns false if
+  the data could not be sent, e.g. the client disconnected.
+  \sa startStream()
+*/
+bool TActionController::writeStream(const QByteArray &data)
+{
+    if (_rendered != RenderState::Streaming) {
+        Tf::warn("Stream not started: {}", (className() + '#' + activeAction()));
+        return false;
+    }
+    return context()->writeChunk(data) >= 0;
+}
+
+/*!
+  Starts a stream of server-sent events with "text/event-stream".
+  \sa sendEvent()
+*/
+bool TActionController::startEventStream()
+{
+    _response.header().setRawHeader("Cache-Control", "no-cache");
+    return startStream("text/event-stream");
+}
+
+/*!
+  Sends a server-sent event with the \a data, and the optional \a event
+  type and \a id to the stream started by startEventStream().
+  \sa startEventStream()
+*/
+bool TActionController::sendEvent(const QByteArray &data, const QByteArray &event, const QByteArray &id)
+{
+    QByteArray message;
+    message.reserve(data.length() + event.length() + id.length() + 32);
+
+    if (!id.isEmpty()) {
+        message += "id: ";
+        message += id;
+        message += '\n';
+    }
+    if (!event.isEmpty()) {
+        message += "event: ";
+        message += event;
+        message += '\n';
+    }
+
+    const QList<QByteArray> lines = data.split('\n');
+    for (auto &line : lines) {
+        message += "data: ";
+        message += line;
+        message += '\n';
+    }
+    message += '\n';
+    return writeStream(message);
+}
+
 /*!
   Exports the all flash variants.
 */
@@ -935,6 +1079,16 @@ bool TActionController::renderJson(const QStringList &list)
     return renderJson(QJsonArray::fromStringList(list));
 }
 
+/*!
+  Renders the \a model as a JSON object, writing the properties directly
+  into the response body. If \a properties is not empty, renders only
+  the properties listed.
+*/
+bool TActionController::renderJson(const TAbstractModel &model, const QStringList &properties)
+{
+    return sendData(TJsonWriter::toJson(model, properties), "application/json; charset=utf-8");
+}
+
 /*!
   Renders a CBOR object \a variant as HTTP response.
 */
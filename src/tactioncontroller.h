@@ -9,6 +9,7 @@
 #include <THttpRequest>
 #include <THttpResponse>
 #include <TActionContext>
+#include <TJsonWriter>
 #include <TSession>
 
 class TActionView;
@@ -16,6 +17,7 @@ class TAbstractUser;
 class TFormValidator;
 class TCache;
 class QDomDocument;
+template <class T> class TSqlORMapper;
 
 
 class T_CORE_EXPORT TActionController : public TAbstractController, public TActionHelper, protected TAccessValidator {
@@ -84,9 +86,16 @@ protected:
     bool renderJson(const QVariantMap &map);
     bool renderJson(const QVariantList &list);
     bool renderJson(const QStringList &list);
+    bool renderJson(const TAbstractModel &model, const QStringList &properties = QStringList());
+    template <class T>
+    bool renderJson(const QList<T> &models, const QStringList &properties = QStringList());
+    template <class T>
+    bool renderJson(const TSqlORMapper<T> &mapper, const QStringList &properties = QStringList());
     bool renderAndCache(const QByteArray &key, int seconds, const QString &action = QString(), const QString &layout = QString());
     bool renderOnCache(const QByteArray &key);
     void removeCache(const QByteArray &key);
+    void removeFragment(const QByteArray &key);
+    void removeFragmentsByTag(const QByteArray &tag);
     bool renderCbor(const QVariant &variant, QCborValue::EncodingOptions opt = QCborValue::NoTransformation);
     bool renderCbor(const QVariantMap &map, QCborValue::EncodingOptions opt = QCborValue::NoTransformation);
     bool renderCbor(const QVariantHash &hash, QCborValue::EncodingOptions opt = QCborValue::NoTransformation);
@@ -97,6 +106,10 @@ protected:
     void redirect(const QUrl &url, Tf::StatusCode statusCode = Tf::StatusCode::Found);
     bool sendFile(const QString &filePath, const QByteArray &contentType, const QString &name = QString(), bool autoRemove = false);
     bool sendData(const QByteArray &data, const QByteArray &contentType, const QString &name = QString());
+    bool startStream(const QByteArray &contentType, const QString &name = QString());
+    bool writeStream(const QByteArray &data);
+    bool startEventStream();
+    bool sendEvent(const QByteArray &data, const QByteArray &event = QByteArray(), const QByteArray &id = QByteArray());
     void rollbackTransaction() { _rollback = true; }
     void setAutoRemove(const QString &filePath);
     bool validateAccess(const TAbstractUser *user);
@@ -129,12 +142,14 @@ private:
         NotRendered = 0,
         Rendered,
         DataSent,
+        Streaming,
     };
 
     void setActionName(const QString &name);
     void setArguments(const QStringList &arguments) { _args = arguments; }
     bool verifyRequest(const THttpRequest &request) const;
     QByteArray renderView(TActionView *view);
+    static QByteArray encodeView(TActionView *view);
     void exportAllFlashVariants();
     const TActionController *controller() const override { return this; }
     bool rollbackRequested() const { return _rollback; }
@@ -218,3 +233,23 @@ inline void TActionController::setContentType(const QByteArray &type)
     _response.header().setContentType(type);
 }
 
+/*!
+  Renders the \a models as a JSON array of objects, writing them
+  directly into the response body.
+*/
+template <class T>
+inline bool TActionController::renderJson(const QList<T> &models, const QStringList &properties)
+{
+    return sendData(TJsonWriter::toJsonArray(models, properties), "application/json; charset=utf-8");
+}
+
+/*!
+  Renders the ORM objects fetched by the \a mapper as a JSON array of
+  objects, writing them directly into the response body.
+*/
+template <class T>
+inline bool TActionController::renderJson(const TSqlORMapper<T> &mapper, const QStringList &properties)
+{
+    return sendData(TJsonWriter::toJsonArray(mapper, properties), "application/json; charset=utf-8");
+}
+
@@ -216,6 +216,13 @@ int64_t TActionThread::writeResponse(THttpResponseHeader &header, QIODevice *bod
 }
 
 
+int64_t TActionThread::writeRawData(const QByteArray &data)
+{
+    // Blocks until the data is written to the socket
+    return _httpSocket->writeRawData(data);
+}
+
+
 void TActionThread::closeSocket()
 {
     _httpSocket->abort();
@@ -24,6 +24,7 @@ protected:
     void run() override;
     void emitError(int socketError) override;
     int64_t writeResponse(THttpResponseHeader &header, QIODevice *body) override;
+    int64_t writeRawData(const QByteArray &data) override;
     void flushSocket() override { }
     void closeSocket() override;
     bool handshakeForWebSocket(const THttpRequestHeader &header);
@@ -11,6 +11,7 @@
 #include <QMutexLocker>
 #include <TActionController>
 #include <TActionView>
+#include <TFragmentCache>
 #include <THtmlAttribute>
 #include <THttpUtility>
 #include <TReactComponent>
@@ -32,6 +33,21 @@ TActionView::TActionView() :
 {
 }
 
+/*!
+  \fn QString TActionView::toString()
+  Returns the rendered content.
+*/
+
+/*!
+  Returns the rendered content encoded in UTF-8. Views generated in the
+  UTF-8 output mode of tmake render into the byte buffer directly, so
+  no conversion from UTF-16 is needed.
+*/
+QByteArray TActionView::toUtf8()
+{
+    return toString().toUtf8();
+}
+
 /*!
   Returns a content processed by a action.
 */
@@ -40,6 +56,39 @@ QString TActionView::yield() const
     return (subView) ? subView->toString() : QString();
 }
 
+/*!
+  Outputs the content processed by a action, as echo(yield()) does.
+  In the UTF-8 output mode, the content is appended to the output
+  buffer as UTF-8 without the conversion to QString.
+*/
+QString TActionView::echoYield()
+{
+    if (subView) {
+        if (utf8Output) {
+            responsebytes += subView->toUtf8();
+        } else {
+            responsebody += subView->toString();
+        }
+    }
+    return QString();
+}
+
+/*!
+  Outputs the HTML-escaped content processed by a action, as
+  eh(yield()) does.
+*/
+QString TActionView::ehYield()
+{
+    if (subView) {
+        if (utf8Output) {
+            responsebytes += THttpUtility::htmlEscapeUtf8(subView->toUtf8());
+        } else {
+            eh(subView->toString());
+        }
+    }
+    return QString();
+}
+
 /*!
   Render the partial template given by \a templateName without layout.
 */
@@ -63,6 +112,53 @@ QString TActionView::renderReact(const QString &component)
     return TReactComponent(component, path).renderToString(component);
 }
 
+/*!
+  Begins the cache block of the fragment with the \a key, which the
+  '<%#cache key, seconds[, tags] %>' tag of ERB is compiled into.
+  If the fragment is cached, outputs it and returns false; otherwise
+  returns true to render the block, which is cached for \a seconds
+  seconds at endFragment(). The fragment is associated with the \a tags
+  to be invalidated by TActionController::removeFragmentsByTag().
+*/
+bool TActionView::beginFragment(const QByteArray &key, int seconds, const QByteArrayList &tags)
+{
+    Fragment fragment;
+    fragment.key = key;
+    fragment.seconds = seconds;
+    fragment.tagVersion = TFragmentCache::tagVersion(tags);
+
+    QByteArray cached = TFragmentCache::get(key, fragment.tagVersion);
+    if (!cached.isNull()) {
+        write(QByteArrayView(cached));
+        fragments << fragment;
+        return false;
+    }
+
+    fragment.offset = (utf8Output) ? responsebytes.length() : responsebody.length();
+    fragments << fragment;
+    return true;
+}
+
+/*!
+  Ends the cache block begun by beginFragment(), and caches the fragment
+  rendered in the block.
+*/
+void TActionView::endFragment()
+{
+    if (fragments.isEmpty()) {
+        tSystemError("endFragment() called without beginFragment()");
+        return;
+    }
+
+    Fragment fragment = fragments.takeLast();
+    if (fragment.offset < 0) {
+        return;
+    }
+
+    QByteArray rendered = (utf8Output) ? responsebytes.mid(fragment.offset) : responsebody.mid(fragment.offset).toUtf8();
+    TFragmentCache::set(fragment.key, rendered, fragment.seconds, fragment.tagVersion);
+}
+
 /*!
   Returns a authenticity token for CSRF protection.
 */
@@ -203,9 +299,12 @@ void TActionView::reset()
 {
     TViewHelper::clear();
     responsebody.resize(0);
+    responsebytes.resize(0);
+    utf8Output = false;
     actionController = nullptr;
     subView = nullptr;
     variantMap.clear();
+    fragments.clear();
 }
 
 
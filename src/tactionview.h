@@ -1,4 +1,7 @@
 #pragma once
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QObject>
 #include <QTextStream>
 #include <QVariant>
@@ -17,6 +20,7 @@ public:
     virtual ~TActionView() { }
 
     virtual QString toString() = 0;
+    virtual QByteArray toUtf8();
     QString yield() const;
     QString renderPartial(const QString &templateName, const QVariantMap &vars = QVariantMap()) const;
     QString authenticityToken() const;
@@ -59,9 +63,15 @@ protected:
     QString eh(const THtmlAttribute &attr);
     QString eh(const QVariant &var);
     QString eh(const QVariantMap &map);
+    QString echoYield();
+    QString ehYield();
     QString renderReact(const QString &component);
+    bool beginFragment(const QByteArray &key, int seconds, const QByteArrayList &tags = QByteArrayList());
+    void endFragment();
 
     QString responsebody;
+    QByteArray responsebytes;  // output buffer in UTF-8 output mode
+    bool utf8Output {false};
 
     static inline QString fromValue(const QString &str) { return str; }
     static inline QString fromValue(const char *str) { return QString(str); } // using codecForCStrings()
@@ -87,10 +97,21 @@ private:
     void setController(TAbstractController *controller);
     void setSubActionView(TActionView *actionView);
     virtual const TActionView *actionView() const override { return this; }
+    void write(const QString &str);
+    void write(QByteArrayView utf8);
+
+    class Fragment {
+    public:
+        QByteArray key;
+        int seconds {0};
+        QByteArray tagVersion;
+        qsizetype offset {-1};  // -1 if served from the cache
+    };
 
     TAbstractController *actionController {nullptr};
     TActionView *subView {nullptr};
     QVariantMap variantMap;
+    QList<Fragment> fragments;  // cache blocks being rendered
 
     friend class TActionController;
     friend class TActionMailer;
@@ -128,93 +149,135 @@ inline const QVariantMap &TActionView::allVariants() const
     return variantMap;
 }
 
+inline void TActionView::write(const QString &str)
+{
+    if (utf8Output) {
+        responsebytes += str.toUtf8();
+    } else {
+        responsebody += str;
+    }
+}
+
+inline void TActionView::write(QByteArrayView utf8)
+{
+    if (utf8Output) {
+        responsebytes += utf8;
+    } else {
+        responsebody += QString::fromUtf8(utf8);
+    }
+}
+
 inline QString TActionView::echo(const QString &str)
 {
-    responsebody += fromValue(str);
+    write(str);
     return QString();
 }
 
 inline QString TActionView::echo(const char *str)
 {
-    responsebody += fromValue(str);
+    write(QByteArrayView(str));
     return QString();
 }
 
 inline QString TActionView::echo(const QByteArray &str)
 {
-    responsebody += fromValue(str);
+    write(QByteArrayView(str));
     return QString();
 }
 
 inline QString TActionView::echo(int n, int base)
 {
-    responsebody += fromValue(n, base);
+    if (utf8Output) {
+        responsebytes += QByteArray::number(n, base);
+    } else {
+        responsebody += fromValue(n, base);
+    }
     return QString();
 }
 
 inline QString TActionView::echo(long n, int base)
 {
-    responsebody += fromValue(n, base);
+    if (utf8Output) {
+        responsebytes += QByteArray::number(n, base);
+    } else {
+        responsebody += fromValue(n, base);
+    }
     return QString();
 }
 
 inline QString TActionView::echo(ulong n, int base)
 {
-    responsebody += fromValue(n, base);
+    if (utf8Output) {
+        responsebytes += QByteArray::number(n, base);
+    } else {
+        responsebody += fromValue(n, base);
+    }
     return QString();
 }
 
 inline QString TActionView::echo(qlonglong n, int base)
 {
-    responsebody += fromValue(n, base);
+    if (utf8Output) {
+        responsebytes += QByteArray::number(n, base);
+    } else {
+        responsebody += fromValue(n, base);
+    }
     return QString();
 }
 
 inline QString TActionView::echo(qulonglong n, int base)
 {
-    responsebody += fromValue(n, base);
+    if (utf8Output) {
+        responsebytes += QByteArray::number(n, base);
+    } else {
+        responsebody += fromValue(n, base);
+    }
     return QString();
 }
 
 inline QString TActionView::echo(double d, char format, int precision)
 {
-    responsebody += fromValue(d, format, precision);
+    if (utf8Output) {
+        responsebytes += QByteArray::number(d, format, precision);
+    } else {
+        responsebody += fromValue(d, format, precision);
+    }
     return QString();
 }
 
 inline QString TActionView::echo(const QJsonObject &object)
 {
-    responsebody += fromValue(object);
+    write(QJsonDocument(object).toJson(QJsonDocument::Compact));
     return QString();
 }
 
 inline QString TActionView::echo(const QJsonArray &array)
 {
-    responsebody += fromValue(array);
+    write(QJsonDocument(array).toJson(QJsonDocument::Compact));
     return QString();
 }
 
 inline QString TActionView::echo(const QJsonDocument &doc)
 {
-    responsebody += doc.toJson(QJsonDocument::Compact);
+    write(doc.toJson(QJsonDocument::Compact));
     return QString();
 }
 
 inline QString TActionView::echo(const THtmlAttribute &attr)
 {
-    responsebody += fromValue(attr);
+    write(fromValue(attr));
     return QString();
 }
 
 inline QString TActionView::echo(const QVariant &var)
 {
-    responsebody += fromValue(var);
+    write(fromValue(var));
     return QString();
 }
 
 inline QString TActionView::echo(const QVariantMap &map)
 {
-    responsebody += fromValue(map);
+    write(QJsonDocument::fromVariant(map).toJson(QJsonDocument::Compact));
     return QString();
 }
 
@@ -225,42 +288,50 @@ inline QString TActionView::eh(const QString &str)
 
 inline QString TActionView::eh(const char *str)
 {
+    if (utf8Output) {
+        responsebytes += THttpUtility::htmlEscapeUtf8(QByteArray::fromRawData(str, qstrlen(str)));
+        return QString();
+    }
     return echo(THttpUtility::htmlEscape(fromValue(str)));
 }
 
 inline QString TActionView::eh(const QByteArray &str)
 {
+    if (utf8Output) {
+        responsebytes += THttpUtility::htmlEscapeUtf8(str);
+        return QString();
+    }
     return echo(THttpUtility::htmlEscape(fromValue(str)));
 }
 
 inline QString TActionView::eh(int n, int base)
 {
-    return echo(THttpUtility::htmlEscape(fromValue(n, base)));
+    return echo(n, base);  // nothing to escape
 }
 
 inline QString TActionView::eh(long n, int base)
 {
-    return echo(THttpUtility::htmlEscape(fromValue(n, base)));
+    return echo(n, base);  // nothing to escape
 }
 
 inline QString TActionView::eh(ulong n, int base)
 {
-    return echo(THttpUtility::htmlEscape(fromValue(n, base)));
+    return echo(n, base);  // nothing to escape
 }
 
 inline QString TActionView::eh(qlonglong n, int base)
 {
-    return echo(THttpUtility::htmlEscape(fromValue(n, base)));
+    return echo(n, base);  // nothing to escape
 }
 
 inline QString TActionView::eh(qulonglong n, int base)
 {
-    return echo(THttpUtility::htmlEscape(fromValue(n, base)));
+    return echo(n, base);  // nothing to escape
 }
 
 inline QString TActionView::eh(double d, char format, int precision)
 {
-    return echo(THttpUtility::htmlEscape(fromValue(d, format, precision)));
+    return echo(d, format, precision);  // nothing to escape
 }
 
 inline QString TActionView::eh(const QJsonObject &object)
@@ -48,6 +48,27 @@ int64_t TActionWorker::writeResponse(THttpResponseHeader &header, QIODevice *bod
 }
 
 
+int64_t TActionWorker::writeRawData(const QByteArray &data)
+{
+    constexpr int MAX_BUFFERED_COUNT = 16;
+
+    if (TActionContext::stopped.load()) {
+        return -1;
+    }
+
+    _socket->sendData(data);
+
+    // Waits for the queued data to be sent if the peer is slow
+    if (_socket->bufferedListCount() > MAX_BUFFERED_COUNT) {
+        if (!_socket->waitForDataSent(5000)) {
+            tSystemWarn("Timed out sending data  socket:{}", _socket->socketDescriptor());
+            return -1;
+        }
+    }
+    return data.length();
+}
+
+
 void TActionWorker::flushSocket()
 {
     _socket->waitForDataSent(1000);
@@ -18,6 +18,7 @@ public:
 protected:
     void run();
     int64_t writeResponse(THttpResponseHeader &header, QIODevice *body) override;
+    int64_t writeRawData(const QByteArray &data) override;
     void flushSocket() override;
     void closeSocket() override;
 
@@ -6,6 +6,7 @@
  */
 
 #include "tapplicationserverbase.h"
+#include "tassetmanifest.h"
 #include <QDateTime>
 #include <QDir>
 #include <QLibrary>
@@ -156,6 +157,11 @@ QPair<QHostAddress, uint16_t> TApplicationServerBase::getPeerInfo(int socketDesc
 
 void TApplicationServerBase::invokeStaticInitialize()
 {
+    // Builds the manifest of assets before serving
+    if (TAssetManifest::isEnabled()) {
+        TAssetManifest::instance();
+    }
+
     // Calls staticInitialize()
     TDispatcher<TActionController> dispatcher("applicationcontroller");
     bool dispatched = dispatcher.invoke("staticInitialize", QStringList(), Qt::DirectConnection);
@@ -81,6 +81,26 @@ const QMap<Tf::AppAttribute, QString> attributeMap = {
     {Tf::CacheBackend, "Cache.Backend"},
     {Tf::CacheGcProbability, "Cache.GcProbability"},
     {Tf::CacheEnableCompression, "Cache.EnableCompression"},
+    {Tf::HttpCompressionEnable, "HttpCompression.Enable"},
+    {Tf::HttpCompressionLevel, "HttpCompression.Level"},
+    {Tf::HttpCompressionMinimumSize, "HttpCompression.MinimumSize"},
+    {Tf::HttpCompressionMimeTypes, "HttpCompression.MimeTypes"},
+    {Tf::HttpCompressionPrecompressedFiles, "HttpCompression.PrecompressedFiles"},
+    {Tf::StaticFileCacheEnable, "StaticFileCache.Enable"},
+    {Tf::StaticFileCacheMaxFileSize, "StaticFileCache.MaxFileSize"},
+    {Tf::StaticFileCacheMaxTotalSize, "StaticFileCache.MaxTotalSize"},
+    {Tf::AssetManifestEnable, "AssetManifest.Enable"},
+    {Tf::AssetManifestAutoReload, "AssetManifest.AutoReload"},
+    {Tf::ReactRenderCacheSeconds, "React.RenderCacheSeconds"},
+    {Tf::SessionGcInterval, "Session.GcInterval"},
+    {Tf::SessionGcBatchSize, "Session.GcBatchSize"},
+    {Tf::SessionFileSyncInterval, "Session.FileSyncInterval"},
+    {Tf::SessionPreviousSecrets, "Session.PreviousSecrets"},
+    {Tf::SessionCookieCompressionThreshold, "Session.CookieCompressionThreshold"},
+    {Tf::CacheLocalMaxTotalSize, "Cache.LocalMaxTotalSize"},
+    {Tf::CacheLocalMaxAge, "Cache.LocalMaxAge"},
+    {Tf::CacheCompressionThreshold, "Cache.CompressionThreshold"},
+    {Tf::CacheCompressionDictionary, "Cache.CompressionDictionary"},
 };
 
 
@@ -107,6 +127,24 @@ const QMap<Tf::AppAttribute, QVariant> defaultValueMap = {
     {Tf::SessionAutoIdRegeneration, false},
     {Tf::ActionMailerDelayedDelivery, false},
     {Tf::InternalEncoding, "UTF-8"},
+    {Tf::HttpCompressionEnable, false},
+    {Tf::HttpCompressionLevel, 6},
+    {Tf::HttpCompressionMinimumSize, 1024},
+    {Tf::HttpCompressionMimeTypes, "text/html;text/plain;text/css;text/javascript;application/javascript;application/json;application/xml;image/svg+xml"},
+    {Tf::HttpCompressionPrecompressedFiles, false},
+    {Tf::StaticFileCacheEnable, false},
+    {Tf::StaticFileCacheMaxFileSize, 65536},
+    {Tf::StaticFileCacheMaxTotalSize, 33554432},
+    {Tf::AssetManifestEnable, false},
+    {Tf::AssetManifestAutoReload, false},
+    {Tf::ReactRenderCacheSeconds, 0},
+    {Tf::SessionGcInterval, 300},
+    {Tf::SessionGcBatchSize, 1000},
+    {Tf::SessionFileSyncInterval, 0},
+    {Tf::SessionCookieCompressionThreshold, 256},
+    {Tf::CacheLocalMaxTotalSize, 0},
+    {Tf::CacheLocalMaxAge, 10},
+    {Tf::CacheCompressionThreshold, 128},
 };
 
 
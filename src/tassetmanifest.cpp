@@ -0,0 +1,256 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tassetmanifest.h"
+#include "tsystemglobal.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <TAppSettings>
+#include <TWebApplication>
+#include <thread>
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/*!
+  \class TAssetManifest
+  \brief The TAssetManifest class keeps the fingerprints of the files in
+  the public directory, which are appended to the asset URLs by
+  TViewHelper.
+
+  The manifest is built when the application server starts, so that the
+  view helpers do not access the file system for each asset. If the
+  setting AssetManifest.AutoReload is true, the fingerprints are updated
+  through inotify when the files are modified. That is available on Linux
+  only; on the other platforms the fingerprints stay as built at startup.
+
+  Symbolic links in the public directory are followed, and the files are
+  indexed under their paths in the public directory. A link to one of its
+  own parent directories is skipped.
+*/
+
+/*!
+  Constructs a manifest of the files in the \a publicPath directory.
+  If \a autoReload is true, a thread watching the directory is started
+  on Linux, so that the object must not be destroyed.
+*/
+TAssetManifest::TAssetManifest(const QString &publicPath, bool autoReload) :
+    _publicPath(QDir(publicPath).absolutePath())
+{
+#ifdef Q_OS_LINUX
+    if (autoReload) {
+        _inotifyFd = ::inotify_init1(IN_CLOEXEC);
+        if (_inotifyFd < 0) {
+            tSystemError("inotify_init1 failed  errno:{}", errno);
+        }
+    }
+#else
+    if (autoReload) {
+        tSystemWarn("AssetManifest.AutoReload is not supported on this platform");
+    }
+#endif
+
+    reload();
+
+#ifdef Q_OS_LINUX
+    if (_inotifyFd >= 0) {
+        std::thread([this]() {
+            watchEvents();
+        }).detach();
+    }
+#endif
+}
+
+/*!
+  Returns a global TAssetManifest object, which is built at the first call.
+*/
+TAssetManifest &TAssetManifest::instance()
+{
+    // Never destroyed; the watcher thread refers to it until the process exits
+    static TAssetManifest *manifest = new TAssetManifest(Tf::app()->publicPath(), Tf::appSettings()->value(Tf::AssetManifestAutoReload).toBool());
+    return *manifest;
+}
+
+/*!
+  Returns true if the asset manifest is enabled by the setting
+  AssetManifest.Enable; otherwise returns false.
+*/
+bool TAssetManifest::isEnabled()
+{
+    static const bool enable = Tf::appSettings()->value(Tf::AssetManifestEnable).toBool();
+    return enable;
+}
+
+/*!
+  Returns the fingerprint of the file of the \a path, which is an absolute
+  path in the public directory such as "/images/logo.png". Returns a null
+  string if no such file exists.
+*/
+QString TAssetManifest::fingerprint(const QString &path) const
+{
+    QReadLocker locker(&_lock);
+    auto it = _fingerprints.constFind(path);
+    if (it != _fingerprints.constEnd()) {
+        return it.value();
+    }
+
+    if (path.contains(QLatin1String("/.")) || path.contains(QLatin1String("//"))) {
+        return _fingerprints.value(QDir::cleanPath(path));
+    }
+    return QString();
+}
+
+/*!
+  Rebuilds the manifest by scanning the public directory.
+*/
+void TAssetManifest::reload()
+{
+    QWriteLocker locker(&_lock);
+    _fingerprints.clear();
+    scan(_publicPath);
+    tSystemDebug("Asset manifest built: {} files", (qint64)_fingerprints.count());
+}
+
+/*!
+  Returns the number of the files in the manifest.
+*/
+int TAssetManifest::count() const
+{
+    QReadLocker locker(&_lock);
+    return _fingerprints.count();
+}
+
+// Must be called with the write lock held
+void TAssetManifest::scan(const QString &dirPath, QStringList ancestors)
+{
+    // Directories on the way from the top, to stop at symlink cycles
+    const QString canonicalPath = QFileInfo(dirPath).canonicalFilePath();
+    if (canonicalPath.isEmpty() || ancestors.contains(canonicalPath)) {
+        tSystemDebug("Asset manifest skips a directory: {}", dirPath);
+        return;
+    }
+    ancestors << canonicalPath;
+
+    if (_inotifyFd >= 0) {
+        watch(dirPath);
+    }
+
+    const auto entries = QDir(dirPath).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable);
+    for (auto &fi : entries) {
+        if (fi.isDir()) {
+            scan(fi.absoluteFilePath(), ancestors);
+        } else {
+            _fingerprints.insert(assetPath(fi.absoluteFilePath()), QString::number(fi.lastModified().toSecsSinceEpoch()));
+        }
+    }
+}
+
+// Must be called with the write lock held
+void TAssetManifest::update(const QString &filePath)
+{
+    QFileInfo fi(filePath);
+    if (fi.isDir()) {
+        if (!_watchDirs.values().contains(filePath)) {
+            scan(filePath);  // new directory
+        }
+    } else if (fi.isFile()) {
+        _fingerprints.insert(assetPath(filePath), QString::number(fi.lastModified().toSecsSinceEpoch()));
+    } else {
+        // Removed file, or removed link to a directory
+        const QString path = assetPath(filePath);
+        const QString prefix = path + QLatin1Char('/');
+        _fingerprints.removeIf([&](const QHash<QString, QString>::iterator it) {
+            return it.key() == path || it.key().startsWith(prefix);
+        });
+    }
+}
+
+
+QString TAssetManifest::assetPath(const QString &filePath) const
+{
+    return filePath.mid(_publicPath.length());
+}
+
+// Must be called with the write lock held
+bool TAssetManifest::watch(const QString &dirPath)
+{
+#ifdef Q_OS_LINUX
+    constexpr uint32_t mask = IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+    int wd = ::inotify_add_watch(_inotifyFd, QFile::encodeName(dirPath).constData(), mask);
+    if (wd < 0) {
+        tSystemWarn("inotify_add_watch failed: {}  errno:{}", dirPath, errno);
+        return false;
+    }
+    if (!_watchDirs.contains(wd, dirPath)) {
+        _watchDirs.insert(wd, dirPath);
+    }
+    return true;
+#else
+    Q_UNUSED(dirPath);
+    return false;
+#endif
+}
+
+
+void TAssetManifest::watchEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(struct inotify_event) char buf[8192];
+
+    for (;;) {
+        ssize_t len = ::read(_inotifyFd, buf, sizeof(buf));
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            tSystemError("inotify read error  errno:{}", errno);
+            break;
+        }
+
+        for (char *p = buf; p < buf + len;) {
+            auto *event = reinterpret_cast<struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events were lost
+                reload();
+                continue;
+            }
+
+            QWriteLocker locker(&_lock);
+            if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT)) {
+                // The directory is gone
+                const QStringList dirs = _watchDirs.values(event->wd);
+                _watchDirs.remove(event->wd);
+                for (auto &dir : dirs) {
+                    const QString prefix = assetPath(dir) + QLatin1Char('/');
+                    _fingerprints.removeIf([&](const QHash<QString, QString>::iterator it) {
+                        return it.key().startsWith(prefix);
+                    });
+                }
+                continue;
+            }
+
+            if (event->len > 0) {
+                // A directory linked from several places is watched once
+                const QStringList dirs = _watchDirs.values(event->wd);
+                for (auto &dir : dirs) {
+                    update(dir + QLatin1Char('/') + QFile::decodeName(event->name));
+                }
+            }
+        }
+    }
+
+    // Can not be updated any more
+    QWriteLocker locker(&_lock);
+    ::close(_inotifyFd);
+    _inotifyFd = -1;
+#endif
+}
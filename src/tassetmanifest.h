@@ -0,0 +1,34 @@
+#pragma once
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TAssetManifest {
+public:
+    static TAssetManifest &instance();
+    static bool isEnabled();
+
+    explicit TAssetManifest(const QString &publicPath, bool autoReload = false);
+    QString fingerprint(const QString &path) const;
+    void reload();
+    int count() const;
+
+private:
+    void scan(const QString &dirPath, QStringList ancestors = QStringList());
+    void update(const QString &filePath);
+    bool watch(const QString &dirPath);
+    void watchEvents();
+    QString assetPath(const QString &filePath) const;
+
+    mutable QReadWriteLock _lock;
+    QString _publicPath;  // absolute path without trailing slash
+    QHash<QString, QString> _fingerprints;  // path under the public directory to fingerprint
+    QMultiHash<int, QString> _watchDirs;  // watch descriptor to directory paths, aliased by symlinks
+    int _inotifyFd {-1};
+
+    T_DISABLE_COPY(TAssetManifest)
+    T_DISABLE_MOVE(TAssetManifest)
+};
@@ -5,17 +5,197 @@
  * the New BSD License, which is incorporated herein by reference.
  */
 
+#include "tcachecompressor.h"
 #include "tcachefactory.h"
 #include "tcachestore.h"
+#include "tlocalcache.h"
+#include "tsystembus.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QtEndian>
 #include <TAppSettings>
 #include <TCache>
 #include <TWebApplication>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
 
 /*!
   \class TCache
   \brief The TCache class stores items so that can be served faster.
+
+  If Cache.LocalMaxTotalSize in application.ini is positive, the items
+  are also kept uncompressed in memory of the application server process
+  and served without accessing the cache backend. When an item is set or
+  removed, the copies in other processes are invalidated through the
+  system bus.
+
+  An item can be stored with tags. Each tag has a generation stored in
+  the cache; invalidating a tag makes a new generation, so that all the
+  items stored with the old one are no longer returned.
 */
 
+namespace {
+
+constexpr char ENVELOPE_MAGIC[] = {'\xf5', 'T', 'f', 'C'};
+constexpr int ENVELOPE_HEADER_LEN = 16;  // magic, fresh-until msecs and compute msecs
+constexpr char TAGGED_MAGIC[] = {'\xf5', 'T', 'f', 'T'};
+constexpr auto TAG_KEY_PREFIX = "tf.tag.";
+constexpr int TAG_GENERATION_SECONDS = 30 * 24 * 3600;
+constexpr auto LEASE_KEY_SUFFIX = ".lease";
+constexpr int LEASE_SECONDS = 10;
+
+std::atomic<uint64_t> localHits {0};
+std::atomic<uint64_t> localMisses {0};
+std::atomic<uint64_t> storeHits {0};
+std::atomic<uint64_t> storeMisses {0};
+
+QByteArray newGeneration()
+{
+    return QByteArray::number(QDateTime::currentMSecsSinceEpoch(), 36) + '.' + QByteArray::number(Tf::random(UINT32_MAX), 36);
+}
+
+// Value of a lease key unique to the caller among processes
+QByteArray leaseToken()
+{
+    static std::atomic<uint64_t> counter {0};
+    return QByteArray::number(QCoreApplication::applicationPid()) + '.' + QByteArray::number(++counter) + '.' + QByteArray::number(Tf::random(UINT32_MAX), 36);
+}
+
+// Splits the tagged value into the keys of the tags, their generations
+// and the value; returns false if not tagged or broken
+bool parseTagged(const QByteArray &value, QByteArrayList &tagKeys, QByteArrayList &generations, QByteArray &body)
+{
+    if (!value.startsWith(QByteArrayView(TAGGED_MAGIC, sizeof(TAGGED_MAGIC)))) {
+        return false;
+    }
+
+    constexpr int offset = sizeof(TAGGED_MAGIC) + sizeof(quint32);
+    if (value.length() < offset) {
+        return false;
+    }
+
+    const qsizetype len = qFromLittleEndian<quint32>(value.constData() + sizeof(TAGGED_MAGIC));
+    if (value.length() < offset + len) {
+        return false;
+    }
+
+    const auto fields = QByteArray(value.constData() + offset, len).split('\0');
+    for (int i = 0; i + 1 < fields.count(); i += 2) {
+        tagKeys << TAG_KEY_PREFIX + fields[i];
+        generations << fields[i + 1];
+    }
+    body = value.mid(offset + len);
+    return true;
+}
+
+// Value stored by getOrCompute() with the time until which it is fresh
+class Envelope {
+public:
+    QByteArray value;
+    int64_t freshUntil {0};  // msecs since epoch
+    int computeMSecs {0};  // time taken to compute the value
+
+    QByteArray pack() const
+    {
+        QByteArray data;
+        data.reserve(ENVELOPE_HEADER_LEN + value.length());
+        data.append(ENVELOPE_MAGIC, sizeof(ENVELOPE_MAGIC));
+        const qint64 fresh = qToLittleEndian<qint64>(freshUntil);
+        const qint32 msecs = qToLittleEndian<qint32>(computeMSecs);
+        data.append((const char *)&fresh, sizeof(fresh));
+        data.append((const char *)&msecs, sizeof(msecs));
+        data += value;
+        return data;
+    }
+
+    bool unpack(const QByteArray &data)
+    {
+        if (data.length() <= ENVELOPE_HEADER_LEN || !data.startsWith(QByteArrayView(ENVELOPE_MAGIC, sizeof(ENVELOPE_MAGIC)))) {
+            return false;
+        }
+        freshUntil = qFromLittleEndian<qint64>(data.constData() + 4);
+        computeMSecs = qFromLittleEndian<qint32>(data.constData() + 12);
+        value = data.mid(ENVELOPE_HEADER_LEN);
+        return true;
+    }
+
+    // Decides to refresh before it becomes stale, more likely as the time
+    // approaches, known as probabilistic early expiration
+    bool shouldRefreshEarly(int64_t now, double beta) const
+    {
+        double r = Tf::random(1, 1000000) / 1000000.0;
+        return now - computeMSecs * beta * std::log(r) >= freshUntil;
+    }
+};
+
+
+// Computation of a key in the process, shared by the callers
+class Flight {
+public:
+    QByteArray wait()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this]() { return _done; });
+        return _value;
+    }
+
+    void finish(const QByteArray &value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _value = value;
+            _done = true;
+        }
+        _cond.notify_all();
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    QByteArray _value;
+    bool _done {false};
+};
+
+QMutex flightsMutex;
+QHash<QByteArray, std::shared_ptr<Flight>> flights;
+
+// Returns the flight of the key; \a leader is set to true if it is new
+std::shared_ptr<Flight> joinFlight(const QByteArray &key, bool &leader)
+{
+    QMutexLocker locker(&flightsMutex);
+    auto &flight = flights[key];
+    leader = !flight;
+    if (leader) {
+        flight = std::make_shared<Flight>();
+    }
+    return flight;
+}
+
+void finishFlight(const QByteArray &key, const std::shared_ptr<Flight> &flight, const QByteArray &value)
+{
+    {
+        QMutexLocker locker(&flightsMutex);
+        flights.remove(key);
+    }
+    flight->finish(value);
+}
+
+// Notifies other application server processes of the invalidation
+void broadcastInvalidation(const QByteArray &key)
+{
+    if (Tf::app()->maxNumberOfAppServers() > 1) {
+        TSystemBus::instance()->send(Tf::CacheInvalidate, QString(), key);
+    }
+}
+
+}
+
 TCache::TCache()
 {
     static int CacheGcProbability = TAppSettings::instance()->value(Tf::CacheGcProbability).toInt();
@@ -70,11 +250,20 @@ bool TCache::set(const QByteArray &key, const QByteArray &value, int seconds)
 
     if (_cache) {
         if (compressionEnabled()) {
-            ret = _cache->set(key, Tf::lz4Compress(value), seconds);
+            ret = _cache->set(key, TCacheCompressor::instance().compress(value), seconds);
         } else {
             ret = _cache->set(key, value, seconds);
         }
 
+        if (TLocalCache::isEnabled()) {
+            if (ret) {
+                TLocalCache::instance().insert(key, value, seconds);
+            } else {
+                TLocalCache::instance().remove(key);
+            }
+            broadcastInvalidation(key);
+        }
+
         // GC
         if (_gcDivisor > 0 && Tf::random(1, _gcDivisor) == 1) {
             _cache->gc();
@@ -83,6 +272,126 @@ bool TCache::set(const QByteArray &key, const QByteArray &value, int seconds)
     return ret;
 }
 
+/*!
+  Stores a new item with the \a key and a \a value associated with the
+  \a tags, and sets the timeout after a given number of \a seconds. The
+  item is no longer returned once one of the tags is invalidated by
+  invalidateTag(). The generations of the tags are taken when it is
+  stored.
+ */
+bool TCache::set(const QByteArray &key, const QByteArray &value, int seconds, const QByteArrayList &tags)
+{
+    if (tags.isEmpty()) {
+        return set(key, value, seconds);
+    }
+
+    const auto generations = tagGenerations(tags);
+    QByteArray header;
+    for (int i = 0; i < tags.count(); ++i) {
+        if (tags[i].contains('\0')) {
+            tSystemError("Invalid cache tag: {}", tags[i].data());
+            return false;
+        }
+        header += tags[i];
+        header += '\0';
+        header += generations[i];
+        header += '\0';
+    }
+
+    const quint32 len = qToLittleEndian<quint32>(header.length());
+    QByteArray data;
+    data.reserve(sizeof(TAGGED_MAGIC) + sizeof(len) + header.length() + value.length());
+    data.append(TAGGED_MAGIC, sizeof(TAGGED_MAGIC));
+    data.append((const char *)&len, sizeof(len));
+    data += header;
+    data += value;
+    return set(key, data, seconds);
+}
+
+/*!
+  Invalidates all the items associated with the \a tag. Only the
+  generation of the tag is replaced, regardless of the number of the
+  items.
+ */
+void TCache::invalidateTag(const QByteArray &tag)
+{
+    set(TAG_KEY_PREFIX + tag, newGeneration(), TAG_GENERATION_SECONDS);
+}
+
+/*!
+  Returns the current generations of the \a tags, looked up at once. A
+  new generation is made for a tag not found; if another caller makes
+  it at the same time, the one stored first is taken.
+ */
+QByteArrayList TCache::tagGenerations(const QByteArrayList &tags)
+{
+    QByteArrayList keys;
+    for (auto &tag : tags) {
+        keys << TAG_KEY_PREFIX + tag;
+    }
+
+    QByteArrayList generations;
+    const auto found = fetchMulti(keys);
+    for (auto &key : keys) {
+        QByteArray generation = found.value(key);
+        if (generation.isEmpty() && _cache) {
+            // Unknown or evicted tag, the items of which must be stale
+            generation = newGeneration();
+            const QByteArray data = compressionEnabled() ? TCacheCompressor::instance().compress(generation) : generation;
+            if (_cache->add(key, data, TAG_GENERATION_SECONDS)) {
+                if (TLocalCache::isEnabled()) {
+                    TLocalCache::instance().insert(key, generation, TAG_GENERATION_SECONDS);
+                    broadcastInvalidation(key);
+                }
+            } else {
+                // Made by another caller
+                QByteArray current = _cache->get(key);
+                if (compressionEnabled()) {
+                    current = TCacheCompressor::instance().uncompress(current);
+                }
+                if (current.isEmpty()) {
+                    set(key, generation, TAG_GENERATION_SECONDS);
+                } else {
+                    generation = current;
+                }
+            }
+        }
+        generations << generation;
+    }
+    return generations;
+}
+
+// Returns the value without the tags if the generations of the tags are
+// current; returns a null byte array if stale
+QByteArray TCache::untag(const QByteArray &value)
+{
+    QByteArrayList tagKeys;
+    QByteArrayList generations;
+    QByteArray body;
+    if (!parseTagged(value, tagKeys, generations, body)) {
+        return value.startsWith(QByteArrayView(TAGGED_MAGIC, sizeof(TAGGED_MAGIC))) ? QByteArray() : value;
+    }
+    return untag(value, fetchMulti(tagKeys));
+}
+
+// Same as above with the current generations already looked up
+QByteArray TCache::untag(const QByteArray &value, const QMap<QByteArray, QByteArray> &currentGenerations)
+{
+    QByteArrayList tagKeys;
+    QByteArrayList generations;
+    QByteArray body;
+    if (!parseTagged(value, tagKeys, generations, body)) {
+        return value.startsWith(QByteArrayView(TAGGED_MAGIC, sizeof(TAGGED_MAGIC))) ? QByteArray() : value;
+    }
+
+    for (int i = 0; i < tagKeys.count(); ++i) {
+        if (currentGenerations.value(tagKeys[i]) != generations[i]) {
+            return QByteArray();
+        }
+    }
+    return body;
+}
+
 /*!
   Returns the value associated with the \a key.
  */
@@ -91,14 +400,173 @@ QByteArray TCache::get(const QByteArray &key)
     QByteArray value;
 
     if (_cache) {
+        const bool local = TLocalCache::isEnabled();
+        if (local) {
+            if (TLocalCache::instance().get(key, value)) {
+                localHits++;
+                return untag(value);
+            }
+            localMisses++;
+        }
+
         value = _cache->get(key);
         if (compressionEnabled()) {
-            value = Tf::lz4Uncompress(value);
+            value = TCacheCompressor::instance().uncompress(value);
+        }
+
+        if (value.isEmpty()) {
+            storeMisses++;
+        } else {
+            storeHits++;
+            if (local) {
+                TLocalCache::instance().insert(key, value, TLocalCache::maxAge());
+            }
+        }
+    }
+    return untag(value);
+}
+
+/*!
+  Returns the value associated with the \a key, or computes it by the
+  function \a compute and stores it for \a seconds if not found.
+
+  Concurrent callers missing the same key wait for one computation: in
+  the process they share the result, and among processes the one that
+  obtains the lease key computes while the others wait for the value to
+  be stored. If \a staleSeconds is positive, the value is kept that much
+  longer after it becomes stale, and the stale value is returned while
+  one caller computes a new value. If \a earlyRefreshBeta is positive, a
+  caller may compute a new value before it becomes stale, more likely as
+  the time approaches and as the computation takes longer; 1.0 is a
+  typical value.
+
+  The items stored by this function must be read by this function.
+ */
+QByteArray TCache::getOrCompute(const QByteArray &key, int seconds, const std::function<QByteArray()> &compute, int staleSeconds, double earlyRefreshBeta)
+{
+    if (!_cache) {
+        return compute();
+    }
+
+    Envelope envelope;
+    bool leader = false;
+
+    if (envelope.unpack(get(key))) {
+        const int64_t now = Tf::getMSecsSinceEpoch();
+        if (now < envelope.freshUntil && (earlyRefreshBeta <= 0 || !envelope.shouldRefreshEarly(now, earlyRefreshBeta))) {
+            return envelope.value;
+        }
+
+        // Refreshes by one caller; the others get the current value
+        auto flight = joinFlight(key, leader);
+        if (!leader) {
+            return envelope.value;
+        }
+
+        QByteArray value = envelope.value;
+        try {
+            const QByteArray leaseKey = key + LEASE_KEY_SUFFIX;
+            const QByteArray token = leaseToken();
+            if (_cache->add(leaseKey, token, LEASE_SECONDS)) {
+                const int64_t leased = Tf::getMSecsSinceEpoch();
+                Tf::ScopeExitFunction release([&]() { releaseLease(leaseKey, token, leased); });
+                QByteArray newValue = computeAndSet(key, seconds, compute, staleSeconds);
+                if (!newValue.isEmpty()) {
+                    value = newValue;
+                }
+            }
+        } catch (...) {
+            finishFlight(key, flight, value);
+            throw;
         }
+        // Published before returning, not by a scope exit, since the
+        // returned value may be moved out before that runs
+        finishFlight(key, flight, value);
+        return value;
+    }
+
+    // Not found
+    auto flight = joinFlight(key, leader);
+    if (!leader) {
+        return flight->wait();
     }
+
+    QByteArray value;
+    try {
+        const QByteArray leaseKey = key + LEASE_KEY_SUFFIX;
+        const QByteArray token = leaseToken();
+        if (_cache->add(leaseKey, token, LEASE_SECONDS)) {
+            const int64_t leased = Tf::getMSecsSinceEpoch();
+            Tf::ScopeExitFunction release([&]() { releaseLease(leaseKey, token, leased); });
+            value = computeAndSet(key, seconds, compute, staleSeconds);
+        } else {
+            // Another process is computing
+            value = waitForComputation(key);
+            if (value.isNull()) {
+                value = computeAndSet(key, seconds, compute, staleSeconds);
+            }
+        }
+    } catch (...) {
+        finishFlight(key, flight, QByteArray());
+        throw;
+    }
+    finishFlight(key, flight, value);
     return value;
 }
 
+
+// Removes the lease only if it is still held by this caller; once it
+// expired, another process may have taken it
+void TCache::releaseLease(const QByteArray &leaseKey, const QByteArray &token, int64_t leasedMSecs)
+{
+    if (Tf::getMSecsSinceEpoch() - leasedMSecs >= LEASE_SECONDS * 1000LL) {
+        return;
+    }
+    if (_cache->get(leaseKey) == token) {
+        _cache->remove(leaseKey);
+    }
+}
+
+
+QByteArray TCache::computeAndSet(const QByteArray &key, int seconds, const std::function<QByteArray()> &compute, int staleSeconds)
+{
+    Envelope envelope;
+    const int64_t start = Tf::getMSecsSinceEpoch();
+    envelope.value = compute();
+    const int64_t now = Tf::getMSecsSinceEpoch();
+
+    if (!envelope.value.isEmpty()) {
+        envelope.freshUntil = now + seconds * 1000LL;
+        envelope.computeMSecs = (int)(now - start);
+        set(key, envelope.pack(), seconds + qMax(staleSeconds, 0));
+    }
+    return envelope.value;
+}
+
+// Waits for the value computed by another process until the lease is
+// released or expires; returns a null byte array if not stored
+QByteArray TCache::waitForComputation(const QByteArray &key)
+{
+    const QByteArray leaseKey = key + LEASE_KEY_SUFFIX;
+    const int64_t limit = Tf::getMSecsSinceEpoch() + LEASE_SECONDS * 1000LL;
+    int interval = 10;
+
+    while (Tf::getMSecsSinceEpoch() < limit) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+        interval = qMin(interval * 2, 200);
+
+        Envelope envelope;
+        if (envelope.unpack(get(key))) {
+            return envelope.value;
+        }
+
+        if (_cache->get(leaseKey).isEmpty()) {
+            break;  // released without a value
+        }
+    }
+    return QByteArray();
+}
+
 /*!
   Removes the item that have the \a key from the cache.
  */
@@ -106,7 +574,153 @@ void TCache::remove(const QByteArray &key)
 {
     if (_cache) {
         _cache->remove(key);
+
+        if (TLocalCache::isEnabled()) {
+            TLocalCache::instance().remove(key);
+            broadcastInvalidation(key);
+        }
+    }
+}
+
+/*!
+  Returns the values associated with the \a keys. The keys not found
+  are not contained. The cache backend is requested at once for the
+  keys not in the local cache, and once more for the tags of the values
+  stored with tags.
+ */
+QMap<QByteArray, QByteArray> TCache::getMulti(const QByteArrayList &keys)
+{
+    QMap<QByteArray, QByteArray> values = fetchMulti(keys);
+
+    // Looks up the tags of all the values at once
+    QByteArrayList tagKeys;
+    for (auto &value : values) {
+        QByteArrayList valueTagKeys;
+        QByteArrayList generations;
+        QByteArray body;
+        if (parseTagged(value, valueTagKeys, generations, body)) {
+            for (auto &key : valueTagKeys) {
+                if (!tagKeys.contains(key)) {
+                    tagKeys << key;
+                }
+            }
+        }
+    }
+    const auto currentGenerations = tagKeys.isEmpty() ? QMap<QByteArray, QByteArray>() : fetchMulti(tagKeys);
+
+    for (auto it = values.begin(); it != values.end();) {
+        QByteArray value = untag(it.value(), currentGenerations);
+        if (value.isNull()) {
+            it = values.erase(it);
+        } else {
+            it.value() = value;
+            ++it;
+        }
+    }
+    return values;
+}
+
+// Returns the values as stored, from the local cache or the cache backend
+QMap<QByteArray, QByteArray> TCache::fetchMulti(const QByteArrayList &keys)
+{
+    QMap<QByteArray, QByteArray> values;
+
+    if (_cache) {
+        const bool local = TLocalCache::isEnabled();
+        QByteArrayList rest;
+
+        if (local) {
+            for (auto &key : keys) {
+                QByteArray value;
+                if (TLocalCache::instance().get(key, value)) {
+                    values.insert(key, value);
+                    localHits++;
+                } else {
+                    rest << key;
+                    localMisses++;
+                }
+            }
+        } else {
+            rest = keys;
+        }
+
+        if (!rest.isEmpty()) {
+            auto found = _cache->getMulti(rest);
+            for (auto it = found.begin(); it != found.end(); ++it) {
+                QByteArray value = compressionEnabled() ? TCacheCompressor::instance().uncompress(it.value()) : it.value();
+                if (value.isEmpty()) {
+                    continue;
+                }
+
+                if (local) {
+                    TLocalCache::instance().insert(it.key(), value, TLocalCache::maxAge());
+                }
+                values.insert(it.key(), value);
+            }
+            storeHits += found.count();
+            storeMisses += rest.count() - found.count();
+        }
     }
+    return values;
+}
+
+/*!
+  Stores the \a items in the cache at once and sets the timeout after a
+  given number of \a seconds. Returns the number of items stored.
+ */
+int TCache::setMulti(const QMap<QByteArray, QByteArray> &items, int seconds)
+{
+    int ret = 0;
+
+    if (_cache) {
+        if (compressionEnabled()) {
+            QMap<QByteArray, QByteArray> compressed;
+            for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+                compressed.insert(it.key(), TCacheCompressor::instance().compress(it.value()));
+            }
+            ret = _cache->setMulti(compressed, seconds);
+        } else {
+            ret = _cache->setMulti(items, seconds);
+        }
+
+        if (TLocalCache::isEnabled()) {
+            for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+                if (ret == items.count()) {
+                    TLocalCache::instance().insert(it.key(), it.value(), seconds);
+                } else {
+                    TLocalCache::instance().remove(it.key());
+                }
+                broadcastInvalidation(it.key());
+            }
+        }
+
+        // GC
+        if (_gcDivisor > 0 && Tf::random(1, _gcDivisor) == 1) {
+            _cache->gc();
+        }
+    }
+    return ret;
+}
+
+/*!
+  Removes the items that have the \a keys from the cache at once.
+  Returns the number of items removed.
+ */
+int TCache::removeMulti(const QByteArrayList &keys)
+{
+    int ret = 0;
+
+    if (_cache) {
+        ret = _cache->removeMulti(keys);
+
+        if (TLocalCache::isEnabled()) {
+            for (auto &key : keys) {
+                TLocalCache::instance().remove(key);
+                broadcastInvalidation(key);
+            }
+        }
+    }
+    return ret;
 }
 
 /*!
@@ -116,6 +730,11 @@ void TCache::clear()
 {
     if (_cache) {
         _cache->clear();
+
+        if (TLocalCache::isEnabled()) {
+            TLocalCache::instance().clear();
+            broadcastInvalidation(QByteArray());  // all items
+        }
     }
 }
 
@@ -125,3 +744,45 @@ bool TCache::compressionEnabled()
     static bool compression = Tf::appSettings()->value(Tf::CacheEnableCompression).toBool();
     return compression;
 }
+
+/*!
+  Returns the numbers of hits and misses of the local cache in the
+  process and of the cache backend, counted by get().
+*/
+TCache::Statistics TCache::statistics()
+{
+    Statistics stats;
+    stats.localHits = localHits.load();
+    stats.localMisses = localMisses.load();
+    stats.storeHits = storeHits.load();
+    stats.storeMisses = storeMisses.load();
+    return stats;
+}
+
+/*!
+  Invalidates the item with the \a key in the local cache, which has been
+  set or removed by another process. If \a key is empty, invalidates all
+  items.
+*/
+void TCache::invalidateLocal(const QByteArray &key)
+{
+    if (key.isEmpty()) {
+        TLocalCache::instance().clear();
+    } else {
+        TLocalCache::instance().remove(key);
+    }
+}
+
+
+double TCache::Statistics::localHitRatio() const
+{
+    uint64_t total = localHits + localMisses;
+    return (total > 0) ? (double)localHits / total : 0.0;
+}
+
+
+double TCache::Statistics::storeHitRatio() const
+{
+    uint64_t total = storeHits + storeMisses;
+    return (total > 0) ? (double)storeHits / total : 0.0;
+}
@@ -1,24 +1,53 @@
 #pragma once
+#include <QByteArrayList>
+#include <QMap>
 #include <TGlobal>
+#include <functional>
 
 class TCacheStore;
 
 
 class T_CORE_EXPORT TCache {
 public:
+    class Statistics {
+    public:
+        uint64_t localHits {0};
+        uint64_t localMisses {0};
+        uint64_t storeHits {0};
+        uint64_t storeMisses {0};
+
+        double localHitRatio() const;
+        double storeHitRatio() const;
+    };
+
     TCache();
     ~TCache();
 
     bool set(const QByteArray &key, const QByteArray &value, int seconds);
+    bool set(const QByteArray &key, const QByteArray &value, int seconds, const QByteArrayList &tags);
     QByteArray get(const QByteArray &key);
+    QByteArray getOrCompute(const QByteArray &key, int seconds, const std::function<QByteArray()> &compute, int staleSeconds = 0, double earlyRefreshBeta = 0);
     void remove(const QByteArray &key);
+    QMap<QByteArray, QByteArray> getMulti(const QByteArrayList &keys);
+    int setMulti(const QMap<QByteArray, QByteArray> &items, int seconds);
+    int removeMulti(const QByteArrayList &keys);
+    void invalidateTag(const QByteArray &tag);
+    QByteArrayList tagGenerations(const QByteArrayList &tags);
     void clear();
 
     static bool compressionEnabled();
+    static Statistics statistics();
 
 private:
     void initialize();
     void cleanup();
+    static void invalidateLocal(const QByteArray &key);
+    QByteArray computeAndSet(const QByteArray &key, int seconds, const std::function<QByteArray()> &compute, int staleSeconds);
+    QByteArray waitForComputation(const QByteArray &key);
+    void releaseLease(const QByteArray &leaseKey, const QByteArray &token, int64_t leasedMSecs);
+    QMap<QByteArray, QByteArray> fetchMulti(const QByteArrayList &keys);
+    QByteArray untag(const QByteArray &value);
+    static QByteArray untag(const QByteArray &value, const QMap<QByteArray, QByteArray> &currentGenerations);
 
     TCacheStore *_cache {nullptr};
     int _gcDivisor {0};
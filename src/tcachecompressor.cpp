@@ -0,0 +1,253 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tcachecompressor.h"
+#include "lz4.h"
+#include "tsystemglobal.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+#include <TAppSettings>
+#include <TWebApplication>
+#include <algorithm>
+#include <cstring>
+
+/*!
+  \class TCacheCompressor
+  \brief The TCacheCompressor class compresses the values stored in the
+  cache with LZ4 adaptively.
+
+  A compressed value begins with a one-byte header telling how it is
+  encoded. The values smaller than the threshold, and the values which
+  do not shrink such as images and gzip data, are stored as they are
+  after the header. If a dictionary is given, small values similar to it
+  such as JSON fragments are compressed with it. The values compressed
+  without the header by the former versions are still readable.
+*/
+
+namespace {
+
+enum Format : char {
+    Raw = '\xf0',  // header + value
+    Lz4 = '\xf1',  // header + original size + LZ4 block
+    Lz4Dictionary = '\xf2',  // header + original size + dictionary ID + LZ4 block
+};
+
+constexpr int LZ4_HEADER_LEN = 1 + sizeof(quint32);
+constexpr int LZ4_DICTIONARY_HEADER_LEN = LZ4_HEADER_LEN + sizeof(quint32);
+constexpr int MAX_DICTIONARY_SIZE = 64 * 1024;  // LZ4 uses the last 64KB only
+constexpr int LEGACY_BLOCKSIZE = 1024 * 1024;  // block size of Tf::lz4Compress()
+
+// FNV-1a, stable across processes
+uint dictionaryId(const QByteArray &dictionary)
+{
+    uint h = 2166136261u;
+    for (char c : dictionary) {
+        h ^= (uchar)c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+QByteArray loadDictionary()
+{
+    QString path = Tf::appSettings()->value(Tf::CacheCompressionDictionary).toString().trimmed();
+    if (path.isEmpty()) {
+        return QByteArray();
+    }
+
+    if (QFileInfo(path).isRelative()) {
+        path = Tf::app()->configPath() + path;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        tSystemError("Failed to open the cache compression dictionary: {}", path);
+        return QByteArray();
+    }
+    return file.readAll().right(MAX_DICTIONARY_SIZE);
+}
+
+}
+
+
+TCacheCompressor::TCacheCompressor(int threshold, const QByteArray &dictionary) :
+    _threshold(std::max(threshold, 0)),
+    _dictionary(dictionary.right(MAX_DICTIONARY_SIZE))
+{
+    if (!_dictionary.isEmpty()) {
+        _dictionaryId = dictionaryId(_dictionary);
+        auto *stream = LZ4_createStream();
+        LZ4_loadDict(stream, _dictionary.constData(), _dictionary.length());
+        _dictionaryStream = stream;
+    }
+}
+
+
+TCacheCompressor::~TCacheCompressor()
+{
+    if (_dictionaryStream) {
+        LZ4_freeStream((LZ4_stream_t *)_dictionaryStream);
+    }
+}
+
+/*!
+  Returns the compressor configured by Cache.CompressionThreshold and
+  Cache.CompressionDictionary in application.ini.
+*/
+TCacheCompressor &TCacheCompressor::instance()
+{
+    static TCacheCompressor compressor(Tf::appSettings()->value(Tf::CacheCompressionThreshold).toInt(), loadDictionary());
+    return compressor;
+}
+
+/*!
+  Compresses the \a value if it is not smaller than the threshold and
+  shrinks; otherwise returns the \a value only with the header.
+*/
+QByteArray TCacheCompressor::compress(const QByteArray &value) const
+{
+    QByteArray data;
+
+    if (value.length() >= _threshold && value.length() <= LZ4_MAX_INPUT_SIZE) {
+        data = compressBlock(value, hasDictionary());
+        if (data.length() > value.length() || isLegacyFormat(data)) {
+            data.clear();  // not shrunk
+        }
+    }
+
+    if (data.isEmpty()) {
+        data.reserve(value.length() + 1);
+        data += Raw;
+        data += value;
+
+        if (isLegacyFormat(data)) {
+            // Rare; must not be taken for the former format
+            QByteArray compressed = compressBlock(value, false);
+            if (!compressed.isEmpty() && !isLegacyFormat(compressed)) {
+                return compressed;
+            }
+        }
+    }
+    return data;
+}
+
+/*!
+  Uncompresses the \a data returned by compress() or Tf::lz4Compress().
+  Returns a null byte array if it fails.
+*/
+QByteArray TCacheCompressor::uncompress(const QByteArray &data) const
+{
+    if (data.isEmpty()) {
+        return QByteArray();
+    }
+
+    if (isLegacyFormat(data)) {
+        QByteArray value = Tf::lz4Uncompress(data);
+        if (!value.isEmpty()) {
+            return value;
+        }
+    }
+
+    switch (data[0]) {
+    case Raw:
+        return data.mid(1);
+
+    case Lz4:
+    case Lz4Dictionary: {
+        const bool dict = (data[0] == Lz4Dictionary);
+        const int headerLen = dict ? LZ4_DICTIONARY_HEADER_LEN : LZ4_HEADER_LEN;
+        if (data.length() <= headerLen) {
+            break;
+        }
+
+        const quint32 size = qFromLittleEndian<quint32>(data.constData() + 1);
+        if (size > (quint32)LZ4_MAX_INPUT_SIZE) {
+            break;
+        }
+
+        QByteArray value(size, Qt::Uninitialized);
+        int len;
+        if (dict) {
+            if (qFromLittleEndian<quint32>(data.constData() + LZ4_HEADER_LEN) != _dictionaryId || !hasDictionary()) {
+                // Compressed with another dictionary
+                return QByteArray();
+            }
+            len = LZ4_decompress_safe_usingDict(data.constData() + headerLen, value.data(), data.length() - headerLen, size, _dictionary.constData(), _dictionary.length());
+        } else {
+            len = LZ4_decompress_safe(data.constData() + headerLen, value.data(), data.length() - headerLen, size);
+        }
+
+        if (len == (int)size) {
+            return value;
+        }
+        tSystemError("LZ4 uncompression error: {}", len);
+        break;
+    }
+
+    default:
+        break;
+    }
+    return QByteArray();
+}
+
+
+QByteArray TCacheCompressor::compressBlock(const QByteArray &value, bool useDictionary) const
+{
+    const int headerLen = useDictionary ? LZ4_DICTIONARY_HEADER_LEN : LZ4_HEADER_LEN;
+    const int bound = LZ4_compressBound(value.length());
+    QByteArray data(headerLen + bound, Qt::Uninitialized);
+    data[0] = useDictionary ? Lz4Dictionary : Lz4;
+    qToLittleEndian<quint32>(value.length(), data.data() + 1);
+
+    int len;
+    if (useDictionary) {
+        qToLittleEndian<quint32>(_dictionaryId, data.data() + LZ4_HEADER_LEN);
+
+        thread_local LZ4_stream_t stream = []() {
+            LZ4_stream_t s;
+            LZ4_initStream(&s, sizeof(s));
+            return s;
+        }();
+#if LZ4_VERSION_NUMBER >= 11000
+        LZ4_resetStream_fast(&stream);
+        LZ4_attach_dictionary(&stream, (const LZ4_stream_t *)_dictionaryStream);
+#else
+        std::memcpy(&stream, _dictionaryStream, sizeof(stream));
+#endif
+        len = LZ4_compress_fast_continue(&stream, value.constData(), data.data() + headerLen, value.length(), bound, 1);
+    } else {
+        len = LZ4_compress_default(value.constData(), data.data() + headerLen, value.length(), bound);
+    }
+
+    if (len <= 0) {
+        tSystemError("LZ4 compression error: {}", len);
+        return QByteArray();
+    }
+    data.resize(headerLen + len);
+    return data;
+}
+
+// Returns true if the data looks like the blocks written by
+// Tf::lz4Compress(), each of which is prefixed with its length
+bool TCacheCompressor::isLegacyFormat(const QByteArray &data)
+{
+    static const int maxBlockLen = LZ4_compressBound(LEGACY_BLOCKSIZE);
+    qsizetype pos = 0;
+
+    while (pos < data.length()) {
+        if (data.length() - pos < (qsizetype)sizeof(qint32)) {
+            return false;
+        }
+        qint32 len = qFromLittleEndian<qint32>(data.constData() + pos);
+        if (len <= 0 || len > maxBlockLen) {
+            return false;
+        }
+        pos += sizeof(qint32) + len;
+    }
+    return pos == data.length();
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <QByteArray>
+#include <TGlobal>
+#include <memory>
+
+
+class T_CORE_EXPORT TCacheCompressor {
+public:
+    TCacheCompressor(int threshold, const QByteArray &dictionary = QByteArray());
+    ~TCacheCompressor();
+
+    static TCacheCompressor &instance();
+
+    QByteArray compress(const QByteArray &value) const;
+    QByteArray uncompress(const QByteArray &data) const;
+    int threshold() const { return _threshold; }
+    bool hasDictionary() const { return !_dictionary.isEmpty(); }
+
+private:
+    QByteArray compressBlock(const QByteArray &value, bool useDictionary) const;
+    static bool isLegacyFormat(const QByteArray &data);
+
+    int _threshold {0};
+    QByteArray _dictionary;
+    uint _dictionaryId {0};
+    void *_dictionaryStream {nullptr};  // LZ4_stream_t
+
+    T_DISABLE_COPY(TCacheCompressor)
+    T_DISABLE_MOVE(TCacheCompressor)
+};
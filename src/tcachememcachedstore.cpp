@@ -39,6 +39,13 @@ bool TCacheMemcachedStore::set(const QByteArray &key, const QByteArray &value, i
 }
 
 
+bool TCacheMemcachedStore::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    TMemcached memcached(Tf::KvsEngine::CacheKvs);
+    return memcached.add(key, value, seconds);
+}
+
+
 bool TCacheMemcachedStore::remove(const QByteArray &key)
 {
     TMemcached memcached(Tf::KvsEngine::CacheKvs);
@@ -46,6 +53,27 @@ bool TCacheMemcachedStore::remove(const QByteArray &key)
 }
 
 
+QMap<QByteArray, QByteArray> TCacheMemcachedStore::getMulti(const QByteArrayList &keys)
+{
+    TMemcached memcached(Tf::KvsEngine::CacheKvs);
+    return memcached.get(keys);
+}
+
+
+int TCacheMemcachedStore::setMulti(const QMap<QByteArray, QByteArray> &items, int seconds)
+{
+    TMemcached memcached(Tf::KvsEngine::CacheKvs);
+    return memcached.set(items, seconds);
+}
+
+
+int TCacheMemcachedStore::removeMulti(const QByteArrayList &keys)
+{
+    TMemcached memcached(Tf::KvsEngine::CacheKvs);
+    return memcached.remove(keys);
+}
+
+
 void TCacheMemcachedStore::clear()
 {
     TMemcached memcached(Tf::KvsEngine::CacheKvs);
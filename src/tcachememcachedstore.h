@@ -14,7 +14,11 @@ public:
 
     QByteArray get(const QByteArray &key) override;
     bool set(const QByteArray &key, const QByteArray &value, int seconds) override;
+    bool add(const QByteArray &key, const QByteArray &value, int seconds) override;
     bool remove(const QByteArray &key) override;
+    QMap<QByteArray, QByteArray> getMulti(const QByteArrayList &keys) override;
+    int setMulti(const QMap<QByteArray, QByteArray> &items, int seconds) override;
+    int removeMulti(const QByteArrayList &keys) override;
     void clear() override;
     void gc() override;
     QMap<QString, QVariant> defaultSettings() const override;
@@ -64,6 +64,46 @@ bool TCacheMongoStore::remove(const QByteArray &key)
 }
 
 
+QMap<QByteArray, QByteArray> TCacheMongoStore::getMulti(const QByteArrayList &keys)
+{
+    QMap<QByteArray, QByteArray> values;
+    TMongoQuery mongo(Tf::KvsEngine::CacheKvs, COL);
+    int64_t current = QDateTime::currentMSecsSinceEpoch() / 1000;
+
+    QVariantList ks;
+    for (auto &key : keys) {
+        ks << QString(key);
+    }
+
+    QVariantMap in {{"$in", ks}};
+    QVariantMap cri {{"k", in}};
+    if (mongo.find(cri)) {
+        while (mongo.next()) {
+            QVariantMap doc = mongo.value();
+            if (doc.value("t").toLongLong() > current) {
+                values.insert(doc.value("k").toString().toUtf8(), doc.value("v").toByteArray());
+            }
+        }
+    }
+    return values;
+}
+
+
+int TCacheMongoStore::removeMulti(const QByteArrayList &keys)
+{
+    TMongoQuery mongo(Tf::KvsEngine::CacheKvs, COL);
+
+    QVariantList ks;
+    for (auto &key : keys) {
+        ks << QString(key);
+    }
+
+    QVariantMap in {{"$in", ks}};
+    QVariantMap cri {{"k", in}};
+    return mongo.remove(cri);
+}
+
+
 void TCacheMongoStore::clear()
 {
     TMongoQuery mongo(Tf::KvsEngine::CacheKvs, COL);
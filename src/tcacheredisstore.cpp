@@ -39,6 +39,13 @@ bool TCacheRedisStore::set(const QByteArray &key, const QByteArray &value, int s
 }
 
 
+bool TCacheRedisStore::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    TRedis redis(Tf::KvsEngine::CacheKvs);
+    return redis.setNxEx(key, value, seconds);
+}
+
+
 bool TCacheRedisStore::remove(const QByteArray &key)
 {
     TRedis redis(Tf::KvsEngine::CacheKvs);
@@ -46,6 +53,35 @@ bool TCacheRedisStore::remove(const QByteArray &key)
 }
 
 
+QMap<QByteArray, QByteArray> TCacheRedisStore::getMulti(const QByteArrayList &keys)
+{
+    QMap<QByteArray, QByteArray> values;
+    TRedis redis(Tf::KvsEngine::CacheKvs);
+    const auto vals = redis.mget(keys);
+
+    for (int i = 0; i < vals.count() && i < keys.count(); ++i) {
+        if (!vals[i].isEmpty()) {
+            values.insert(keys[i], vals[i]);
+        }
+    }
+    return values;
+}
+
+
+int TCacheRedisStore::setMulti(const QMap<QByteArray, QByteArray> &items, int seconds)
+{
+    TRedis redis(Tf::KvsEngine::CacheKvs);
+    return redis.msetEx(items, seconds);
+}
+
+
+int TCacheRedisStore::removeMulti(const QByteArrayList &keys)
+{
+    TRedis redis(Tf::KvsEngine::CacheKvs);
+    return (keys.isEmpty()) ? 0 : redis.del(keys);
+}
+
+
 void TCacheRedisStore::clear()
 {
     TRedis redis(Tf::KvsEngine::CacheKvs);
@@ -34,6 +34,13 @@ bool TCacheSharedMemoryStore::set(const QByteArray &key, const QByteArray &value
 }
 
 
+bool TCacheSharedMemoryStore::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    TSharedMemoryKvs kvs(Tf::KvsEngine::CacheKvs);
+    return kvs.add(key, value, seconds);
+}
+
+
 QByteArray TCacheSharedMemoryStore::get(const QByteArray &key)
 {
     TSharedMemoryKvs kvs(Tf::KvsEngine::CacheKvs);
@@ -48,6 +55,27 @@ bool TCacheSharedMemoryStore::remove(const QByteArray &key)
 }
 
 
+QMap<QByteArray, QByteArray> TCacheSharedMemoryStore::getMulti(const QByteArrayList &keys)
+{
+    TSharedMemoryKvs kvs(Tf::KvsEngine::CacheKvs);
+    return kvs.get(keys);
+}
+
+
+int TCacheSharedMemoryStore::setMulti(const QMap<QByteArray, QByteArray> &items, int seconds)
+{
+    TSharedMemoryKvs kvs(Tf::KvsEngine::CacheKvs);
+    return kvs.set(items, seconds);
+}
+
+
+int TCacheSharedMemoryStore::removeMulti(const QByteArrayList &keys)
+{
+    TSharedMemoryKvs kvs(Tf::KvsEngine::CacheKvs);
+    return kvs.remove(keys);
+}
+
+
 void TCacheSharedMemoryStore::clear()
 {
     TSharedMemoryKvs kvs(Tf::KvsEngine::CacheKvs);
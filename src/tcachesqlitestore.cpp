@@ -18,11 +18,30 @@ constexpr auto TABLE_NAME = "kb";
 constexpr auto KEY_COLUMN = "k";
 constexpr auto BLOB_COLUMN = "b";
 constexpr auto TIMESTAMP_COLUMN = "t";
+constexpr int MAX_ROWS_PER_QUERY = 250;  // within the limit of host parameters
+constexpr int MAX_CACHED_STATEMENTS = 64;
+constexpr int GC_BATCH_SIZE = 1000;  // rows deleted in a transaction
+constexpr int MAX_GC_BATCHES = 10;
 
 static int sqliteMajorVersion;
 static int sqliteMinorVersion;
 
 
+// Returns a list of the number of placeholders, such as "?,?,?"
+static QString placeholders(int count, const QString &placeholder = QStringLiteral("?"))
+{
+    QString str;
+    str.reserve(count * (placeholder.length() + 1));
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) {
+            str += QLatin1Char(',');
+        }
+        str += placeholder;
+    }
+    return str;
+}
+
+
 inline QSqlError lastError()
 {
     return Tf::currentSqlDatabase(Tf::app()->databaseIdForCache()).sqlDatabase().lastError();
@@ -48,6 +67,38 @@ static void getVersion()
     }
 }
 
+// Short write transaction of the cache database, which is in autocommit
+// mode; does nothing if a transaction has begun already
+class WriteTransaction {
+public:
+    WriteTransaction()
+    {
+        TSqlQuery query(Tf::app()->databaseIdForCache());
+        _active = query.exec(QStringLiteral("BEGIN IMMEDIATE"));
+    }
+
+    ~WriteTransaction()
+    {
+        if (_active) {
+            TSqlQuery query(Tf::app()->databaseIdForCache());
+            query.exec(QStringLiteral("ROLLBACK"));
+        }
+    }
+
+    bool commit()
+    {
+        if (!_active) {
+            return true;
+        }
+        _active = false;
+        TSqlQuery query(Tf::app()->databaseIdForCache());
+        return query.exec(QStringLiteral("COMMIT"));
+    }
+
+private:
+    bool _active {false};
+};
+
 // Query without a transaction
 static bool queryNonTrx(const QSqlDatabase &db, const QString &sql)
 {
@@ -65,6 +116,8 @@ bool TCacheSQLiteStore::createTable(const QString &table)
     int id = Tf::app()->databaseIdForCache();
     auto db = TSqlDatabasePool::instance()->database(id);
     bool ret = queryNonTrx(db->sqlDatabase(), QStringLiteral("CREATE TABLE IF NOT EXISTS %1 (%2 TEXT PRIMARY KEY, %3 INTEGER, %4 BLOB)").arg(table, KEY_COLUMN, TIMESTAMP_COLUMN, BLOB_COLUMN));
+    // Index of the expiration time for GC
+    ret = ret && queryNonTrx(db->sqlDatabase(), QStringLiteral("CREATE INDEX IF NOT EXISTS %1_%2 ON %1 (%2)").arg(table, TIMESTAMP_COLUMN));
     queryNonTrx(db->sqlDatabase(), QStringLiteral("VACUUM"));
 
     return ret;
@@ -110,6 +163,54 @@ bool TCacheSQLiteStore::isOpen() const
     return true;
 }
 
+// Executes the SQL with the \a values bound; the statement is prepared
+// once for each connection and reused. Returns the query executed, or
+// nullptr if failed.
+TSqlQuery *TCacheSQLiteStore::exec(const QString &sql, const QVariantList &values)
+{
+    const int id = Tf::app()->databaseIdForCache();
+    const QString key = Tf::currentSqlDatabase(id).connectionName() + QLatin1Char(':') + sql;
+    std::shared_ptr<TSqlQuery> query = _statements.value(key);
+    bool cached = (bool)query;
+    QString error;
+
+    for (;;) {
+        if (!query) {
+            query = std::make_shared<TSqlQuery>(id);
+            query->prepare(sql);
+            if (query->lastError().isValid()) {
+                error = query->lastError().text();
+                break;
+            }
+
+            if (_statements.count() >= MAX_CACHED_STATEMENTS) {
+                _statements.clear();
+            }
+            _statements.insert(key, query);
+        }
+
+        for (int i = 0; i < values.count(); ++i) {
+            query->bind(i, values[i]);
+        }
+
+        if (query->exec()) {
+            return query.get();
+        }
+
+        error = query->lastError().text();
+        _statements.remove(key);
+        if (!cached) {
+            break;
+        }
+        // Finalized by closing the connection; prepares it again
+        query.reset();
+        cached = false;
+    }
+
+    tSystemError("SQLite error : {}, query:'{}' [{}:{}]", error, sql, __FILE__, __LINE__);
+    return nullptr;
+}
+
 
 int TCacheSQLiteStore::count()
 {
@@ -128,15 +229,15 @@ int TCacheSQLiteStore::count()
 bool TCacheSQLiteStore::exists(const QByteArray &key)
 {
     int exist = 0;
-    TSqlQuery query(Tf::app()->databaseIdForCache());
-    QString sql = QStringLiteral("select exists(select 1 from %1 where %2=:name and %3>:ts limit 1)").arg(_table).arg(KEY_COLUMN).arg(TIMESTAMP_COLUMN);
-    auto current = QDateTime::currentMSecsSinceEpoch() / 1000;
+    QString sql = QStringLiteral("select exists(select 1 from %1 where %2=? and %3>? limit 1)").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN);
+    qint64 current = QDateTime::currentMSecsSinceEpoch() / 1000;
 
-    query.prepare(sql);
-    query.bind(":name", key);
-    query.bind(":ts", current);
-    if (query.exec() && query.next()) {
-        exist = query.value(0).toInt();
+    auto *query = exec(sql, {key, current});
+    if (query) {
+        if (query->next()) {
+            exist = query->value(0).toInt();
+        }
+        query->finish();
     }
     return (exist > 0);
 }
@@ -169,6 +270,33 @@ bool TCacheSQLiteStore::set(const QByteArray &key, const QByteArray &value, int
 }
 
 
+/*!
+  Stores the \a value with the \a key only if the key does not exist or
+  has expired.
+*/
+bool TCacheSQLiteStore::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    if (key.isEmpty() || seconds <= 0) {
+        return false;
+    }
+
+    const qint64 current = QDateTime::currentMSecsSinceEpoch() / 1000;
+    WriteTransaction tx;
+
+    // Removes the expired item first
+    if (!exec(QStringLiteral("delete from %1 where %2=? and %3<=?").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN), {key, current})) {
+        return false;
+    }
+
+    auto *query = exec(QStringLiteral("insert or ignore into %1 (%2,%3,%4) values (?,?,?)").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN, BLOB_COLUMN), {key, current + seconds, value});
+    if (!query) {
+        return false;
+    }
+    bool ret = (query->numRowsAffected() == 1);
+    return tx.commit() && ret;
+}
+
+
 bool TCacheSQLiteStore::read(const QByteArray &key, QByteArray &blob, int64_t &timestamp)
 {
     bool ret = false;
@@ -177,20 +305,14 @@ bool TCacheSQLiteStore::read(const QByteArray &key, QByteArray &blob, int64_t &t
         return ret;
     }
 
-    TSqlQuery query(Tf::app()->databaseIdForCache());
-    query.prepare(QStringLiteral("select %1,%2 from %3 where %4=:key").arg(TIMESTAMP_COLUMN, BLOB_COLUMN, _table, KEY_COLUMN));
-    query.bind(":key", key);
-    ret = query.exec();
-    if (ret) {
-        if (query.next()) {
-            timestamp = query.value(0).toLongLong();
-            blob = query.value(1).toByteArray();
-        }
-    } else {
-        auto error = lastErrorString();
-        if (!error.isEmpty()) {
-            tSystemError("SQLite error : {} [{}:{}]", error, __FILE__, __LINE__);
+    auto *query = exec(QStringLiteral("select %1,%2 from %3 where %4=?").arg(TIMESTAMP_COLUMN, BLOB_COLUMN, _table, KEY_COLUMN), {key});
+    if (query) {
+        if (query->next()) {
+            timestamp = query->value(0).toLongLong();
+            blob = query->value(1).toByteArray();
         }
+        query->finish();  // releases the read snapshot
+        ret = true;
     }
     return ret;
 }
@@ -207,18 +329,12 @@ bool TCacheSQLiteStore::write(const QByteArray &key, const QByteArray &blob, int
     QString sql;
     if (sqliteMajorVersion >= 3 && sqliteMinorVersion >= 24) {
         // upsert-clause
-        sql = QStringLiteral("insert into %1 (%2,%3,%4) values (:key,:ts,:blob) on conflict(k) do update set b=:blob, t=:ts").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN, BLOB_COLUMN);
+        sql = QStringLiteral("insert into %1 (%2,%3,%4) values (?,?,?) on conflict(k) do update set b=excluded.b, t=excluded.t").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN, BLOB_COLUMN);
     } else {
-        sql = QStringLiteral("replace into %1 (%2,%3,%4) values (:key,:ts,:blob)").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN, BLOB_COLUMN);
+        sql = QStringLiteral("replace into %1 (%2,%3,%4) values (?,?,?)").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN, BLOB_COLUMN);
     }
 
-    TSqlQuery query(Tf::app()->databaseIdForCache());
-    query.prepare(sql);
-    query.bind(":key", key).bind(":ts", (qint64)timestamp).bind(":blob", blob);
-    ret = query.exec();
-    if (!ret && lastError().isValid()) {
-        tSystemError("SQLite error : {} [{}:{}]", lastErrorString(), __FILE__, __LINE__);
-    }
+    ret = (exec(sql, {key, (qint64)timestamp, blob}) != nullptr);
     return ret;
 }
 
@@ -231,16 +347,99 @@ bool TCacheSQLiteStore::remove(const QByteArray &key)
         return ret;
     }
 
-    TSqlQuery query(Tf::app()->databaseIdForCache());
-    QString sql = QStringLiteral("delete from %1 where %2=:key").arg(_table, KEY_COLUMN);
+    ret = (exec(QStringLiteral("delete from %1 where %2=?").arg(_table, KEY_COLUMN), {key}) != nullptr);
+    return ret;
+}
 
-    query.prepare(sql);
-    query.bind(":key", key);
-    ret = query.exec();
-    if (!ret && lastError().isValid()) {
-        tSystemError("SQLite error : {} [{}:{}]", lastErrorString(), __FILE__, __LINE__);
+
+/*!
+  Returns the values associated with the \a keys, selected by a query
+  for every 250 keys.
+*/
+QMap<QByteArray, QByteArray> TCacheSQLiteStore::getMulti(const QByteArrayList &keys)
+{
+    QMap<QByteArray, QByteArray> values;
+    const int64_t current = QDateTime::currentMSecsSinceEpoch() / 1000;
+
+    for (int i = 0; i < keys.count(); i += MAX_ROWS_PER_QUERY) {
+        QVariantList ks;
+        for (auto &key : keys.mid(i, MAX_ROWS_PER_QUERY)) {
+            ks << key;
+        }
+
+        auto *query = exec(QStringLiteral("select %1,%2,%3 from %4 where %1 in (%5)").arg(KEY_COLUMN, TIMESTAMP_COLUMN, BLOB_COLUMN, _table, placeholders(ks.count())), ks);
+        if (!query) {
+            break;
+        }
+
+        while (query->next()) {
+            if (query->value(1).toLongLong() > current) {
+                values.insert(query->value(0).toByteArray(), query->value(2).toByteArray());
+            }
+        }
+        query->finish();
     }
-    return ret;
+    return values;
+}
+
+/*!
+  Stores the \a items which expire after \a seconds, inserted by a
+  query for every 250 items in a transaction.
+*/
+int TCacheSQLiteStore::setMulti(const QMap<QByteArray, QByteArray> &items, int seconds)
+{
+    if (seconds <= 0) {
+        return 0;
+    }
+
+    int cnt = 0;
+    const qint64 expire = QDateTime::currentMSecsSinceEpoch() / 1000 + seconds;
+    auto it = items.constBegin();
+    WriteTransaction tx;
+
+    while (it != items.constEnd()) {
+        QVariantList values;
+        for (; it != items.constEnd() && values.count() < MAX_ROWS_PER_QUERY * 3; ++it) {
+            if (!it.key().isEmpty()) {
+                values << it.key() << expire << it.value();
+            }
+        }
+
+        if (values.isEmpty()) {
+            continue;
+        }
+
+        QString sql = QStringLiteral("replace into %1 (%2,%3,%4) values %5").arg(_table, KEY_COLUMN, TIMESTAMP_COLUMN, BLOB_COLUMN, placeholders(values.count() / 3, QStringLiteral("(?,?,?)")));
+        if (!exec(sql, values)) {
+            break;
+        }
+        cnt += values.count() / 3;
+    }
+    return tx.commit() ? cnt : 0;
+}
+
+/*!
+  Removes the items with the \a keys, deleted by a query for every 250
+  keys in a transaction.
+*/
+int TCacheSQLiteStore::removeMulti(const QByteArrayList &keys)
+{
+    int cnt = 0;
+    WriteTransaction tx;
+
+    for (int i = 0; i < keys.count(); i += MAX_ROWS_PER_QUERY) {
+        QVariantList ks;
+        for (auto &key : keys.mid(i, MAX_ROWS_PER_QUERY)) {
+            ks << key;
+        }
+
+        auto *query = exec(QStringLiteral("delete from %1 where %2 in (%3)").arg(_table, KEY_COLUMN, placeholders(ks.count())), ks);
+        if (!query) {
+            break;
+        }
+        cnt += query->numRowsAffected();
+    }
+    return tx.commit() ? cnt : 0;
 }
 
 
@@ -327,10 +526,30 @@ int64_t TCacheSQLiteStore::dbSize()
 }
 
 
+/*!
+  Removes the expired items incrementally, looked up by the index of the
+  expiration time. Each batch of deletions is a short transaction not to
+  block the other writers for long.
+*/
 void TCacheSQLiteStore::gc()
 {
-    int removed = removeOlderThan(1 + QDateTime::currentMSecsSinceEpoch() / 1000);
-    tSystemDebug("removeOlderThan: {}\n", removed);
+    const qint64 current = QDateTime::currentMSecsSinceEpoch() / 1000;
+    const QString sql = QStringLiteral("delete from %1 where ROWID in (select ROWID from %1 where %2<=? limit %3)").arg(_table, TIMESTAMP_COLUMN).arg(GC_BATCH_SIZE);
+    int removed = 0;
+
+    for (int i = 0; i < MAX_GC_BATCHES; ++i) {
+        auto *query = exec(sql, {current});
+        if (!query) {
+            break;
+        }
+
+        int cnt = query->numRowsAffected();
+        removed += cnt;
+        if (cnt < GC_BATCH_SIZE) {
+            break;
+        }
+    }
+    tSystemDebug("Removed expired cache items: {}", removed);
 }
 
 
@@ -339,7 +558,7 @@ QMap<QString, QVariant> TCacheSQLiteStore::defaultSettings() const
     QMap<QString, QVariant> settings {
         {"DriverType", "QSQLITE"},
         {"DatabaseName", "cachedb"},
-        {"PostOpenStatements", "PRAGMA journal_mode=OFF; PRAGMA busy_timeout=5; PRAGMA synchronous=OFF;"},
+        {"PostOpenStatements", "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL; PRAGMA busy_timeout=200; PRAGMA mmap_size=268435456; PRAGMA temp_store=MEMORY;"},
     };
     return settings;
 }
@@ -1,7 +1,11 @@
 #pragma once
 #include "tcachestore.h"
+#include <QHash>
 #include <QSqlDatabase>
 #include <TGlobal>
+#include <memory>
+
+class TSqlQuery;
 
 
 class T_CORE_EXPORT TCacheSQLiteStore : public TCacheStore {
@@ -17,7 +21,11 @@ public:
 
     QByteArray get(const QByteArray &key) override;
     bool set(const QByteArray &key, const QByteArray &value, int seconds) override;
+    bool add(const QByteArray &key, const QByteArray &value, int seconds) override;
     bool remove(const QByteArray &key) override;
+    QMap<QByteArray, QByteArray> getMulti(const QByteArrayList &keys) override;
+    int setMulti(const QMap<QByteArray, QByteArray> &items, int seconds) override;
+    int removeMulti(const QByteArrayList &keys) override;
     void clear() override;
     void gc() override;
     QMap<QString, QVariant> defaultSettings() const override;
@@ -36,8 +44,10 @@ public:
 
 protected:
     TCacheSQLiteStore(const QByteArray &table = QByteArray());
+    TSqlQuery *exec(const QString &sql, const QVariantList &values);
 
     QString _table;
+    QHash<QString, std::shared_ptr<TSqlQuery>> _statements;  // prepared for each connection
 
     friend class TCacheFactory;
     friend class TSessionFileDbStore;
@@ -4,3 +4,61 @@
   \class TCacheStore
   \brief The TCacheStore class provides a listing of cache store interfaces.
 */
+
+/*!
+  Stores the \a value with the \a key only if the key does not exist,
+  and returns true if stored. The default implementation is not atomic;
+  reimplement it to add the item atomically among processes.
+*/
+bool TCacheStore::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    return get(key).isEmpty() && set(key, value, seconds);
+}
+
+/*!
+  Returns the values associated with the \a keys. The keys not found are
+  not contained. The default implementation calls get() for each key;
+  reimplement it to look up the keys in one request.
+*/
+QMap<QByteArray, QByteArray> TCacheStore::getMulti(const QByteArrayList &keys)
+{
+    QMap<QByteArray, QByteArray> values;
+    for (auto &key : keys) {
+        QByteArray value = get(key);
+        if (!value.isEmpty()) {
+            values.insert(key, value);
+        }
+    }
+    return values;
+}
+
+/*!
+  Stores the \a items which expire after \a seconds and returns the
+  number of items stored. The default implementation calls set() for
+  each item.
+*/
+int TCacheStore::setMulti(const QMap<QByteArray, QByteArray> &items, int seconds)
+{
+    int cnt = 0;
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        if (set(it.key(), it.value(), seconds)) {
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
+/*!
+  Removes the items with the \a keys and returns the number of items
+  removed. The default implementation calls remove() for each key.
+*/
+int TCacheStore::removeMulti(const QByteArrayList &keys)
+{
+    int cnt = 0;
+    for (auto &key : keys) {
+        if (remove(key)) {
+            cnt++;
+        }
+    }
+    return cnt;
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <QByteArray>
+#include <QByteArrayList>
 #include <QMap>
 #include <QVariant>
 #include <TGlobal>
@@ -22,7 +23,11 @@ public:
     virtual void close() = 0;
     virtual QByteArray get(const QByteArray &key) = 0;
     virtual bool set(const QByteArray &key, const QByteArray &value, int seconds) = 0;
+    virtual bool add(const QByteArray &key, const QByteArray &value, int seconds);
     virtual bool remove(const QByteArray &key) = 0;
+    virtual QMap<QByteArray, QByteArray> getMulti(const QByteArrayList &keys);
+    virtual int setMulti(const QMap<QByteArray, QByteArray> &items, int seconds);
+    virtual int removeMulti(const QByteArrayList &keys);
     virtual void clear() = 0;
     virtual void gc() = 0;
     virtual QMap<QString, QVariant> defaultSettings() const { return QMap<QString, QVariant>(); }
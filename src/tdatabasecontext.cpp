@@ -38,6 +38,14 @@ TDatabaseContext::TDatabaseContext()
         sqlTransactions.resize(count);
     }
 
+    // The cache database is used in autocommit mode; TCacheSQLiteStore
+    // makes short transactions by itself not to hold the write lock
+    // during the request
+    int cacheId = Tf::app()->databaseIdForCache();
+    if (cacheId >= 0 && cacheId < count) {
+        sqlTransactions[cacheId].setEnabled(false);
+    }
+
     if (kvsDatabases.size() < (size_t)Tf::KvsEngine::Num) {
         kvsDatabases.resize((size_t)Tf::KvsEngine::Num);
     }
@@ -139,6 +147,9 @@ void TDatabaseContext::setTransactionEnabled(bool enable, int id)
         return;
     }
 
+    if (id == Tf::app()->databaseIdForCache()) {
+        return;  // always autocommit
+    }
     sqlTransactions[id].setEnabled(enable);
 }
 
@@ -0,0 +1,131 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tdispatcher.h"
+#include <QHash>
+#include <QReadWriteLock>
+#include <array>
+
+/*!
+  \class TDispatchTable
+  \brief The TDispatchTable class caches the object factories by meta type
+  name and the methods to be dispatched by method name and the number of
+  arguments, so that dispatching does not look up the meta-object for
+  each request.
+*/
+
+namespace {
+
+using MethodIndexes = std::array<int, NUM_METHOD_PARAMS>;  // method index by the number of arguments
+
+QReadWriteLock factoryLock;
+QHash<QString, std::function<QObject *()>> factoryHash;
+QReadWriteLock methodLock;
+QHash<const QMetaObject *, QHash<QByteArray, MethodIndexes>> methodHash;
+
+
+// Resolves slots taking QString arguments, in the same order of preference
+// as looking up them by signatures
+QHash<QByteArray, MethodIndexes> resolveMethods(const QMetaObject *metaObject)
+{
+    QHash<QByteArray, MethodIndexes> exactMethods;
+
+    for (int i = 0; i < metaObject->methodCount(); ++i) {
+        QMetaMethod mm = metaObject->method(i);
+        if (mm.methodType() != QMetaMethod::Slot || mm.parameterCount() >= NUM_METHOD_PARAMS) {
+            continue;
+        }
+
+        bool strings = true;
+        for (int j = 0; j < mm.parameterCount(); ++j) {
+            if (mm.parameterType(j) != QMetaType::QString) {
+                strings = false;
+                break;
+            }
+        }
+
+        if (strings) {
+            auto it = exactMethods.find(mm.name());
+            if (it == exactMethods.end()) {
+                MethodIndexes indexes;
+                indexes.fill(-1);
+                it = exactMethods.insert(mm.name(), indexes);
+            }
+            (*it)[mm.parameterCount()] = i;  // a subclass overrides
+        }
+    }
+
+    QHash<QByteArray, MethodIndexes> methods;
+    for (auto it = exactMethods.cbegin(); it != exactMethods.cend(); ++it) {
+        const MethodIndexes &exact = it.value();
+        MethodIndexes indexes;
+        indexes.fill(-1);
+
+        for (int narg = 0; narg < NUM_METHOD_PARAMS; ++narg) {
+            // Fewer arguments first, then more
+            for (int i = narg; i >= 0 && indexes[narg] < 0; --i) {
+                indexes[narg] = exact[i];
+            }
+            for (int i = narg + 1; i < NUM_METHOD_PARAMS - 1 && indexes[narg] < 0; ++i) {
+                indexes[narg] = exact[i];
+            }
+        }
+        methods.insert(it.key(), indexes);
+    }
+    return methods;
+}
+
+}
+
+/*!
+  Returns the factory of objects of the meta type \a metaTypeName.
+*/
+std::function<QObject *()> TDispatchTable::factory(const QString &metaTypeName)
+{
+    {
+        QReadLocker locker(&factoryLock);
+        auto it = factoryHash.constFind(metaTypeName);
+        if (it != factoryHash.constEnd()) {
+            return it.value();
+        }
+    }
+
+    auto factory = Tf::objectFactories()->value(metaTypeName.toLatin1().toLower(), nullptr);
+    if (factory) {
+        QWriteLocker locker(&factoryLock);
+        factoryHash.insert(metaTypeName, factory);
+    }
+    return factory;
+}
+
+/*!
+  Returns the index of the slot named \a methodName of the \a metaObject
+  to be called with \a argCount QString arguments, or -1 if not found.
+  If no slot takes exactly \a argCount arguments, the one taking the
+  nearest fewer arguments, otherwise the nearest more, is returned.
+*/
+int TDispatchTable::methodIndex(const QMetaObject *metaObject, const QByteArray &methodName, int argCount)
+{
+    const int narg = qBound(0, argCount, NUM_METHOD_PARAMS - 1);
+
+    {
+        QReadLocker locker(&methodLock);
+        auto it = methodHash.constFind(metaObject);
+        if (it != methodHash.constEnd()) {
+            auto mit = it->constFind(methodName);
+            return (mit != it->constEnd()) ? (*mit)[narg] : -1;
+        }
+    }
+
+    auto methods = resolveMethods(metaObject);
+    auto mit = methods.constFind(methodName);
+    int index = (mit != methods.constEnd()) ? (*mit)[narg] : -1;
+
+    QWriteLocker locker(&methodLock);
+    methodHash.insert(metaObject, methods);
+    return index;
+}
@@ -4,11 +4,20 @@
 #include <QMetaObject>
 #include <QMetaType>
 #include <QStringList>
+#include <QThread>
 #include <TGlobal>
+#include <functional>
 
 constexpr int NUM_METHOD_PARAMS = 11;
 
 
+class T_CORE_EXPORT TDispatchTable {
+public:
+    static std::function<QObject *()> factory(const QString &metaTypeName);
+    static int methodIndex(const QMetaObject *metaObject, const QByteArray &methodName, int argCount);
+};
+
+
 template <class T>
 class TDispatcher {
 public:
@@ -46,51 +55,13 @@ inline TDispatcher<T>::~TDispatcher()
 template <class T>
 inline QMetaMethod TDispatcher<T>::method(const QByteArray &methodName, int argCount)
 {
-    static const QByteArray params[NUM_METHOD_PARAMS] = {
-        QByteArrayLiteral("()"),
-        QByteArrayLiteral("(QString)"),
-        QByteArrayLiteral("(QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString,QString,QString,QString,QString)"),
-        QByteArrayLiteral("(QString,QString,QString,QString,QString,QString,QString,QString,QString,QString)")};
-
     object();
     if (Q_UNLIKELY(!_ptr)) {
         tSystemDebug("Failed to invoke, no such class: {}", _metaType);
         return QMetaMethod();
     }
 
-    int idx = -1;
-    int narg = qMin(argCount, NUM_METHOD_PARAMS - 1);
-    for (int i = narg; i >= 0; i--) {
-        // Find method
-        QByteArray mtd = methodName;
-        mtd += params[i];
-        idx = _ptr->metaObject()->indexOfSlot(mtd.constData());
-        if (idx >= 0) {
-            tSystemDebug("Found method: {}", mtd.constData());
-            break;
-        }
-    }
-
-    if (idx < 0) {
-        for (int i = narg + 1; i < NUM_METHOD_PARAMS - 1; i++) {
-            // Find method
-            QByteArray mtd = methodName;
-            mtd += params[i];
-            idx = _ptr->metaObject()->indexOfSlot(mtd.constData());
-            if (idx >= 0) {
-                tSystemDebug("Found method: {}", mtd);
-                break;
-            }
-        }
-    }
-
+    int idx = TDispatchTable::methodIndex(_ptr->metaObject(), methodName, argCount);
     if (Q_UNLIKELY(idx < 0)) {
         tSystemDebug("No such method: {}", methodName);
         return QMetaMethod();
@@ -120,6 +91,16 @@ inline bool TDispatcher<T>::invoke(const QByteArray &method, const QStringList &
 
     if (Q_UNLIKELY(!mm.isValid())) {
         tSystemDebug("Failed to invoke method: {}", method);
+    } else if (mm.parameterCount() == args.count()
+        && (connectionType == Qt::DirectConnection || (connectionType == Qt::AutoConnection && _ptr->thread() == QThread::currentThread()))) {
+        // Calls the method directly
+        tSystemDebug("Invoke method: {}", (_metaType + "." + method));
+        void *argv[NUM_METHOD_PARAMS] = {nullptr};  // argv[0] is for the return value
+        for (int i = 0; i < args.count(); ++i) {
+            argv[i + 1] = const_cast<QString *>(&args[i]);
+        }
+        QMetaObject::metacall(_ptr, QMetaObject::InvokeMetaMethod, mm.methodIndex(), argv);
+        ret = true;
     } else {
         tSystemDebug("Invoke method: {}", (_metaType + "." + method));
         switch (args.count()) {
@@ -186,7 +167,7 @@ template <class T>
 inline T *TDispatcher<T>::object()
 {
     if (!_ptr) {
-        auto factory = Tf::objectFactories()->value(_metaType.toLatin1().toLower(), nullptr);
+        auto factory = TDispatchTable::factory(_metaType);
         if (Q_LIKELY(factory)) {
             auto p = factory();
             _ptr = dynamic_cast<T *>(p);
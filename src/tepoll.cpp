@@ -9,6 +9,7 @@
 #include "tepollsocket.h"
 #include "tepollwebsocket.h"
 #include "tfcore.h"
+#include "trangefile.h"
 #include "tsendbuffer.h"
 #include "tsessionmanager.h"
 #include "tsystemglobal.h"
@@ -269,17 +270,22 @@ void TEpoll::setSendData(TEpollSocket *socket, const QByteArray &header, QIODevi
 {
     QByteArray response = header;
     QFileInfo fi;
+    TSendBuffer *sendbuf = nullptr;
 
     if (Q_LIKELY(body)) {
         QBuffer *buffer = dynamic_cast<QBuffer *>(body);
         if (buffer) {
             response += buffer->data();
+        } else if (auto *rangeFile = dynamic_cast<TRangeFile *>(body)) {
+            sendbuf = TEpollSocket::createSendBuffer(response, *rangeFile, std::move(accessLogger));
         } else {
             fi.setFile(*dynamic_cast<QFile *>(body));
         }
     }
 
-    TSendBuffer *sendbuf = TEpollSocket::createSendBuffer(response, fi, autoRemove, std::move(accessLogger));
+    if (!sendbuf) {
+        sendbuf = TEpollSocket::createSendBuffer(response, fi, autoRemove, std::move(accessLogger));
+    }
     socket->enqueueSendData(sendbuf);
     bool res = modifyPoll(socket, (EPOLLIN | EPOLLOUT | EPOLLET));  // reset
     if (!res) {
@@ -58,6 +58,12 @@ TSendBuffer *TEpollSocket::createSendBuffer(const QByteArray &header, const QFil
 }
 
 
+TSendBuffer *TEpollSocket::createSendBuffer(const QByteArray &header, const TRangeFile &file, TAccessLogger &&logger)
+{
+    return new TSendBuffer(header, file, std::move(logger));
+}
+
+
 TSendBuffer *TEpollSocket::createSendBuffer(const QByteArray &data)
 {
     return new TSendBuffer(data);
@@ -12,6 +12,7 @@ class THttpRequestHeader;
 class QHostAddress;
 class QThread;
 class QFileInfo;
+class TRangeFile;
 
 
 class T_CORE_EXPORT TEpollSocket {
@@ -52,6 +53,7 @@ public:
     virtual bool isProcessing() const { return false; }
 
     static TSendBuffer *createSendBuffer(const QByteArray &header, const QFileInfo &file, bool autoRemove, TAccessLogger &&logger);
+    static TSendBuffer *createSendBuffer(const QByteArray &header, const TRangeFile &file, TAccessLogger &&logger);
     static TSendBuffer *createSendBuffer(const QByteArray &data);
 
 protected:
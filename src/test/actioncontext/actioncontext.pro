@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = actioncontext
+SOURCES = main.cpp
@@ -0,0 +1,264 @@
+#include <TfTest/TfTest>
+#include <QtCore>
+#include <TActionController>
+#include <TActionView>
+#include <TCache>
+#include <THttpRequest>
+#include <THttpResponseHeader>
+#include "tresponsecache.h"
+#include "tactioncontext.h"
+
+
+// Executes requests and keeps the response written
+class TestContext : public TActionContext
+{
+public:
+    THttpResponseHeader header;
+    QByteArray body;
+    QByteArray rawData;
+
+    void get(const QByteArray &path, const QByteArray &acceptEncoding = QByteArray())
+    {
+        QByteArray raw = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n";
+        if (!acceptEncoding.isEmpty()) {
+            raw += "Accept-Encoding: " + acceptEncoding + "\r\n";
+        }
+        raw += "\r\n";
+
+        header = THttpResponseHeader();
+        body.clear();
+        rawData.clear();
+        THttpRequest request(THttpRequestHeader(raw), QByteArray(), QHostAddress(), this);
+        execute(request);
+        release();
+    }
+
+protected:
+    int64_t writeResponse(THttpResponseHeader &header, QIODevice *body) override
+    {
+        this->header = header;
+        if (body) {
+            auto *buffer = dynamic_cast<QBuffer *>(body);
+            this->body = (buffer) ? buffer->data() : body->readAll();
+        }
+        return header.toByteArray().length() + this->body.length();
+    }
+
+    int64_t writeRawData(const QByteArray &data) override
+    {
+        rawData += data;
+        return data.length();
+    }
+};
+
+
+class CacheController : public TActionController
+{
+    Q_OBJECT
+public:
+    bool sessionEnabled() const override { return false; }
+    bool transactionEnabled() const override { return false; }
+
+public slots:
+    void store() { renderAndCache("actioncontext", 60, "show"); }
+    void load() { renderOnCache("actioncontext"); }
+    void loadVaryCookie()
+    {
+        httpResponse().header().setRawHeader("Vary", "Cookie");
+        renderOnCache("actioncontext");
+    }
+    void page()
+    {
+        renderCount++;
+        renderText(QString(2048, QLatin1Char('p')), false);
+    }
+
+    static int renderCount;
+};
+int CacheController::renderCount = 0;
+T_DEFINE_CONTROLLER(CacheController)
+
+
+class StreamController : public TActionController
+{
+    Q_OBJECT
+public:
+    bool sessionEnabled() const override { return false; }
+    bool transactionEnabled() const override { return false; }
+
+public slots:
+    void chunks()
+    {
+        startStream("text/plain");
+        writeStream("hello");
+        writeStream(QByteArray(26, 'x'));
+        writeStream(QByteArray());
+    }
+    void events()
+    {
+        startEventStream();
+        sendEvent("one");
+        sendEvent("line1\nline2", "update", "7");
+    }
+    void notStarted()
+    {
+        results.clear();
+        results << writeStream("before");
+        renderText("rendered");
+        results << startStream("text/plain");
+        results << writeStream("after");
+    }
+    void restarted()
+    {
+        results.clear();
+        results << startStream("text/plain");
+        results << startStream("text/plain");
+        results << writeStream("a");
+    }
+
+    static QList<bool> results;
+};
+QList<bool> StreamController::results;
+T_DEFINE_CONTROLLER(StreamController)
+
+
+class cache_showView : public TActionView
+{
+    Q_OBJECT
+public:
+    QString toString() override { return QString(2048, QLatin1Char('a')); }
+};
+T_DEFINE_VIEW(cache_showView)
+
+
+class TestActionContext : public QObject
+{
+    Q_OBJECT
+private slots:
+    void renderOnCache();
+    void routeCache();
+    void chunkedStream();
+    void eventStream();
+    void streamNotStarted();
+    void renderedAlready();
+};
+
+
+void TestActionContext::renderOnCache()
+{
+    const QByteArray html(2048, 'a');
+    const QByteArray gzip = Tf::gzipCompress(html, TActionContext::compressionLevel());
+    TestContext context;
+
+    // Stored by a client not accepting gzip
+    context.get("/cache/store");
+    QCOMPARE(context.body, html);
+    QVERIFY(!context.header.hasRawHeader("Content-Encoding"));
+    QCOMPARE(context.header.rawHeader("Vary"), QByteArray("Accept-Encoding"));
+
+    context.get("/cache/load", "gzip, deflate");
+    QCOMPARE(context.header.rawHeader("Content-Encoding"), QByteArray("gzip"));
+    QCOMPARE(context.header.rawHeader("Vary"), QByteArray("Accept-Encoding"));
+    QCOMPARE(context.body, gzip);
+
+    context.get("/cache/load");
+    QVERIFY(!context.header.hasRawHeader("Content-Encoding"));
+    QCOMPARE(context.header.rawHeader("Vary"), QByteArray("Accept-Encoding"));
+    QCOMPARE(context.body, html);
+
+    // Added to the Vary set by the action
+    context.get("/cache/loadVaryCookie", "gzip");
+    QCOMPARE(context.header.rawHeader("Content-Encoding"), QByteArray("gzip"));
+    QCOMPARE(context.header.rawHeader("Vary"), QByteArray("Cookie, Accept-Encoding"));
+    QCOMPARE(context.body, gzip);
+
+    context.get("/cache/loadVaryCookie");
+    QVERIFY(!context.header.hasRawHeader("Content-Encoding"));
+    QCOMPARE(context.header.rawHeader("Vary"), QByteArray("Cookie, Accept-Encoding"));
+    QCOMPARE(context.body, html);
+}
+
+void TestActionContext::routeCache()
+{
+    TResponseCache::instance().clear();
+    CacheController::renderCount = 0;
+    const QByteArray text(2048, 'p');
+    const QByteArray gzip = Tf::gzipCompress(text, TActionContext::compressionLevel());
+    TestContext context;
+
+    // Compressed once when stored, and sent as stored on a hit
+    for (int i = 0; i < 2; ++i) {
+        context.get("/page", "gzip");
+        QCOMPARE(CacheController::renderCount, 1);
+        QCOMPARE(context.header.rawHeader("Content-Encoding"), QByteArray("gzip"));
+        QCOMPARE(context.header.rawHeader("Vary"), QByteArray("Accept-Encoding"));
+        QCOMPARE(context.header.contentLength(), (int64_t)gzip.length());
+        QCOMPARE(context.body, gzip);
+    }
+
+    // Identity body cached apart
+    for (int i = 0; i < 2; ++i) {
+        context.get("/page");
+        QCOMPARE(CacheController::renderCount, 2);
+        QVERIFY(!context.header.hasRawHeader("Content-Encoding"));
+        QCOMPARE(context.header.rawHeader("Vary"), QByteArray("Accept-Encoding"));
+        QCOMPARE(context.body, text);
+    }
+}
+
+
+void TestActionContext::chunkedStream()
+{
+    TestContext context;
+    context.get("/stream/chunks");
+    int idx = context.rawData.indexOf("\r\n\r\n");
+    QVERIFY(idx > 0);
+    QByteArray header = context.rawData.left(idx + 2);
+    QVERIFY(header.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(header.contains("Transfer-Encoding: chunked\r\n"));
+    QVERIFY(!header.contains("Content-Length"));
+
+    // Sizes in hex, an empty data not framed, and the last chunk
+    QCOMPARE(context.rawData.mid(idx + 4), "5\r\nhello\r\n1a\r\n" + QByteArray(26, 'x') + "\r\n0\r\n\r\n");
+}
+
+
+void TestActionContext::eventStream()
+{
+    TestContext context;
+    context.get("/stream/events");
+    int idx = context.rawData.indexOf("\r\n\r\n");
+    QVERIFY(idx > 0);
+    QByteArray header = context.rawData.left(idx + 2);
+    QVERIFY(header.contains("Content-Type: text/event-stream"));
+    QVERIFY(header.contains("Cache-Control: no-cache\r\n"));
+
+    // A data line for each line, after the id and event type
+    QByteArray body;
+    body += "b\r\ndata: one\n\n\r\n";
+    body += "2d\r\nid: 7\nevent: update\ndata: line1\ndata: line2\n\n\r\n";
+    body += "0\r\n\r\n";
+    QCOMPARE(context.rawData.mid(idx + 4), body);
+}
+
+
+void TestActionContext::streamNotStarted()
+{
+    TestContext context;
+    context.get("/stream/notStarted");
+    QCOMPARE(StreamController::results, QList<bool>({false, false, false}));
+    QCOMPARE(context.body, QByteArray("rendered"));
+    QVERIFY(context.rawData.isEmpty());
+}
+
+
+void TestActionContext::renderedAlready()
+{
+    TestContext context;
+    context.get("/stream/restarted");
+    QCOMPARE(StreamController::results, QList<bool>({true, false, true}));
+    QVERIFY(context.rawData.endsWith("\r\n\r\n1\r\na\r\n0\r\n\r\n"));
+}
+
+TF_TEST_MAIN(TestActionContext)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = assetmanifest
+SOURCES = main.cpp
@@ -0,0 +1,168 @@
+#include <TfTest/TfTest>
+#include <QtCore>
+#include "tassetmanifest.h"
+#include "../../tviewhelper.h"
+
+
+class ViewHelper : public TViewHelper
+{
+    const TActionView *actionView() const { return 0; }
+};
+
+
+class TestAssetManifest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void scan();
+    void symlink();
+    void symlinkCycle();
+    void reload();
+    void urlRewrite();
+
+private:
+    static bool writeFile(const QString &path, const QDateTime &modified);
+    QTemporaryDir _tmpDir;
+    QString _publicPath;
+    bool _createdPublic {false};
+};
+
+
+const QDateTime MODIFIED = QDateTime::fromSecsSinceEpoch(1700000000);
+const QString FINGERPRINT = QString::number(MODIFIED.toSecsSinceEpoch());
+
+
+bool TestAssetManifest::writeFile(const QString &path, const QDateTime &modified)
+{
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write("asset");
+    file.setFileTime(modified, QFileDevice::FileModificationTime);
+    file.close();
+    return true;
+}
+
+
+void TestAssetManifest::initTestCase()
+{
+    QVERIFY(_tmpDir.isValid());
+    _publicPath = _tmpDir.path() + "/public";
+    QVERIFY(writeFile(_publicPath + "/css/style.css", MODIFIED));
+    QVERIFY(writeFile(_publicPath + "/js/lib/app.js", MODIFIED.addSecs(60)));
+    QVERIFY(writeFile(_tmpDir.path() + "/shared/images/logo.png", MODIFIED));
+    QVERIFY(writeFile(_tmpDir.path() + "/shared/robots.txt", MODIFIED));
+
+    // Public directory of the application for the view helpers
+    QDir appPublic(Tf::app()->publicPath());
+    if (!appPublic.exists()) {
+        QVERIFY(appPublic.mkpath("."));
+        _createdPublic = true;
+    }
+    QVERIFY(writeFile(Tf::app()->publicPath() + "js/tfasset.js", MODIFIED));
+}
+
+
+void TestAssetManifest::cleanupTestCase()
+{
+    if (_createdPublic) {
+        QDir(Tf::app()->publicPath()).removeRecursively();
+    } else {
+        QFile::remove(Tf::app()->publicPath() + "js/tfasset.js");
+    }
+}
+
+
+void TestAssetManifest::scan()
+{
+    TAssetManifest manifest(_publicPath);
+    QCOMPARE(manifest.fingerprint("/css/style.css"), FINGERPRINT);
+    QCOMPARE(manifest.fingerprint("/js/lib/app.js"), QString::number(MODIFIED.addSecs(60).toSecsSinceEpoch()));
+    QCOMPARE(manifest.fingerprint("/js/../css/style.css"), FINGERPRINT);
+    QCOMPARE(manifest.fingerprint("/css//style.css"), FINGERPRINT);
+    QVERIFY(manifest.fingerprint("/css/none.css").isNull());
+    QVERIFY(manifest.fingerprint("/style.css").isNull());
+}
+
+
+void TestAssetManifest::symlink()
+{
+#ifdef Q_OS_UNIX
+    QVERIFY(QFile::link(_tmpDir.path() + "/shared/images", _publicPath + "/images"));
+    QVERIFY(QFile::link(_tmpDir.path() + "/shared/robots.txt", _publicPath + "/robots.txt"));
+
+    // Indexed under the paths in the public directory
+    TAssetManifest manifest(_publicPath);
+    QCOMPARE(manifest.fingerprint("/images/logo.png"), FINGERPRINT);
+    QCOMPARE(manifest.fingerprint("/robots.txt"), FINGERPRINT);
+    QVERIFY(manifest.fingerprint("/shared/robots.txt").isNull());
+
+    QFile::remove(_publicPath + "/images");
+    QFile::remove(_publicPath + "/robots.txt");
+#else
+    QSKIP("symbolic links not supported");
+#endif
+}
+
+
+void TestAssetManifest::symlinkCycle()
+{
+#ifdef Q_OS_UNIX
+    QVERIFY(QFile::link(_publicPath, _publicPath + "/js/lib/top"));
+    QVERIFY(QFile::link(_publicPath + "/js", _publicPath + "/css/js"));
+
+    TAssetManifest manifest(_publicPath);
+    QCOMPARE(manifest.fingerprint("/css/style.css"), FINGERPRINT);
+    // Not a cycle, linked from another directory
+    QCOMPARE(manifest.fingerprint("/css/js/lib/app.js"), manifest.fingerprint("/js/lib/app.js"));
+    // Stops at the link to the parent directory
+    QVERIFY(manifest.fingerprint("/js/lib/top/css/style.css").isNull());
+    QCOMPARE(manifest.count(), 3);
+
+    QFile::remove(_publicPath + "/js/lib/top");
+    QFile::remove(_publicPath + "/css/js");
+#else
+    QSKIP("symbolic links not supported");
+#endif
+}
+
+
+void TestAssetManifest::reload()
+{
+    TAssetManifest manifest(_publicPath);
+    int count = manifest.count();
+    QVERIFY(writeFile(_publicPath + "/css/print.css", MODIFIED.addSecs(120)));
+    QVERIFY(manifest.fingerprint("/css/print.css").isNull());
+
+    manifest.reload();
+    QCOMPARE(manifest.count(), count + 1);
+    QCOMPARE(manifest.fingerprint("/css/print.css"), QString::number(MODIFIED.addSecs(120).toSecsSinceEpoch()));
+    QFile::remove(_publicPath + "/css/print.css");
+}
+
+
+void TestAssetManifest::urlRewrite()
+{
+    if (!TAssetManifest::isEnabled()) {
+        QSKIP("AssetManifest.Enable is false");
+    }
+
+    ViewHelper view;
+    QCOMPARE(view.jsPath("tfasset.js"), QString("/js/tfasset.js?") + FINGERPRINT);
+    QCOMPARE(view.jsPath("/js/tfasset.js"), QString("/js/tfasset.js?") + FINGERPRINT);
+    QCOMPARE(view.jsPath("tfasset.js", false), QString("/js/tfasset.js"));
+    QCOMPARE(view.jsPath("none.js"), QString("/js/none.js"));
+    QCOMPARE(view.jsPath("http://example.com/js/tfasset.js"), QString("http://example.com/js/tfasset.js"));
+
+    // Added after the manifest was built
+    QVERIFY(writeFile(Tf::app()->publicPath() + "js/tfadded.js", MODIFIED.addSecs(180)));
+    QCOMPARE(view.jsPath("tfadded.js"), QString("/js/tfadded.js?") + QString::number(MODIFIED.addSecs(180).toSecsSinceEpoch()));
+    QFile::remove(Tf::app()->publicPath() + "js/tfadded.js");
+}
+
+TF_TEST_SQLLESS_MAIN(TestAssetManifest)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = cachecompressor
+SOURCES = main.cpp
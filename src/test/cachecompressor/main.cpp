@@ -0,0 +1,167 @@
+#include <QTest>
+#include <QtCore>
+#include <TGlobal>
+#include "tcachecompressor.h"
+
+
+class TestCacheCompressor : public QObject
+{
+    Q_OBJECT
+private slots:
+    void roundTrip_data();
+    void roundTrip();
+    void threshold();
+    void incompressible();
+    void dictionary();
+    void otherDictionary();
+    void legacyFormat();
+    void bench_compress_json();
+    void bench_compress_json_dictionary();
+    void bench_compress_random();
+    void bench_uncompress_json_dictionary();
+};
+
+
+static QByteArray jsonFragment(int id)
+{
+    return QStringLiteral(R"({"id":%1,"title":"Title %1","body":"Hello world","rating":4.5,"published":true,"created_at":"2026-01-02T03:04:05"})").arg(id).toUtf8();
+}
+
+static QByteArray dictionaryData()
+{
+    QByteArray dict;
+    for (int i = 0; i < 20; ++i) {
+        dict += jsonFragment(i * 7919);
+    }
+    return dict;
+}
+
+static QByteArray randomData(int length)
+{
+    QByteArray data(length, Qt::Uninitialized);
+    for (int i = 0; i < length; ++i) {
+        data[i] = (char)Tf::random(255);
+    }
+    return data;
+}
+
+
+void TestCacheCompressor::roundTrip_data()
+{
+    QTest::addColumn<QByteArray>("value");
+
+    QTest::newRow("empty") << QByteArray("");
+    QTest::newRow("small") << QByteArray("hello");
+    QTest::newRow("json") << jsonFragment(1);
+    QTest::newRow("repeated") << QByteArray(100000, 'a');
+    QTest::newRow("random") << randomData(5000);
+}
+
+
+void TestCacheCompressor::roundTrip()
+{
+    QFETCH(QByteArray, value);
+
+    TCacheCompressor compressor(16);
+    QCOMPARE(compressor.uncompress(compressor.compress(value)), value);
+
+    TCacheCompressor dictCompressor(16, dictionaryData());
+    QCOMPARE(dictCompressor.uncompress(dictCompressor.compress(value)), value);
+}
+
+
+void TestCacheCompressor::threshold()
+{
+    TCacheCompressor compressor(128);
+    QByteArray small(100, 'a');
+    QCOMPARE(compressor.compress(small).length(), small.length() + 1);  // header only
+
+    QByteArray large(1000, 'a');
+    QVERIFY(compressor.compress(large).length() < 100);
+}
+
+
+void TestCacheCompressor::incompressible()
+{
+    TCacheCompressor compressor(16);
+    QByteArray value = randomData(4096);
+    QByteArray data = compressor.compress(value);
+    QCOMPARE(data.length(), value.length() + 1);
+    QCOMPARE(compressor.uncompress(data), value);
+}
+
+
+void TestCacheCompressor::dictionary()
+{
+    TCacheCompressor compressor(16);
+    TCacheCompressor dictCompressor(16, dictionaryData());
+    QByteArray value = jsonFragment(12345);
+
+    QByteArray data = dictCompressor.compress(value);
+    QVERIFY(data.length() < compressor.compress(value).length());
+    QCOMPARE(dictCompressor.uncompress(data), value);
+}
+
+
+void TestCacheCompressor::otherDictionary()
+{
+    TCacheCompressor dictCompressor(16, dictionaryData());
+    QByteArray data = dictCompressor.compress(jsonFragment(12345));
+
+    TCacheCompressor compressor(16);
+    QVERIFY(compressor.uncompress(data).isNull());
+    TCacheCompressor otherCompressor(16, "foo bar baz");
+    QVERIFY(otherCompressor.uncompress(data).isNull());
+}
+
+
+void TestCacheCompressor::legacyFormat()
+{
+    TCacheCompressor compressor(16);
+    for (auto &value : {jsonFragment(1), QByteArray(3 * 1024 * 1024, 'b'), randomData(1000)}) {
+        QCOMPARE(compressor.uncompress(Tf::lz4Compress(value)), value);
+    }
+}
+
+
+void TestCacheCompressor::bench_compress_json()
+{
+    TCacheCompressor compressor(16);
+    QByteArray value = jsonFragment(12345);
+    QBENCHMARK {
+        compressor.compress(value);
+    }
+}
+
+
+void TestCacheCompressor::bench_compress_json_dictionary()
+{
+    TCacheCompressor compressor(16, dictionaryData());
+    QByteArray value = jsonFragment(12345);
+    QBENCHMARK {
+        compressor.compress(value);
+    }
+}
+
+
+void TestCacheCompressor::bench_compress_random()
+{
+    TCacheCompressor compressor(16);
+    QByteArray value = randomData(16384);
+    QBENCHMARK {
+        compressor.compress(value);
+    }
+}
+
+
+void TestCacheCompressor::bench_uncompress_json_dictionary()
+{
+    TCacheCompressor compressor(16, dictionaryData());
+    QByteArray data = compressor.compress(jsonFragment(12345));
+    QBENCHMARK {
+        compressor.uncompress(data);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestCacheCompressor)
+#include "main.moc"
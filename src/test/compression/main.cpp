@@ -1,5 +1,6 @@
 #include <QTest>
 #include <QDebug>
+#include <QtEndian>
 #include "tglobal.h"
 
 static QByteArray dummydata;
@@ -22,6 +23,10 @@ private slots:
     void lz4_l2();
     void lz4_l5_data();
     void lz4_l5();
+    void deflate_data();
+    void deflate();
+    void gzip_data();
+    void gzip();
     void bench_lz4_l1_512();
     void bench_lz4_l2_512();
     void bench_lz4_l5_512();
@@ -150,6 +155,60 @@ void LZ4Compress::lz4_l5()
     QCOMPARE(data, uncomp);
 }
 
+void LZ4Compress::deflate_data()
+{
+    QTest::addColumn<QByteArray>("data");
+
+    QTest::newRow("1") << testdata2;
+    QTest::newRow("2") << testdata3;
+    QTest::newRow("3") << testdata5;
+    QTest::newRow("4") << dummydata.mid(0, 1025);
+    QTest::newRow("5") << dummydata;
+}
+
+
+void LZ4Compress::deflate()
+{
+    QFETCH(QByteArray, data);
+
+    QByteArray comp = Tf::deflateCompress(data);
+    QCOMPARE((uchar)comp[0] & 0x0F, 8);  // CM = deflate
+
+    // qUncompress() expects the uncompressed length in 4 bytes
+    QByteArray len(4, 0);
+    qToBigEndian<quint32>(data.length(), len.data());
+    QByteArray uncomp = qUncompress(len + comp);
+    QCOMPARE(data, uncomp);
+}
+
+
+void LZ4Compress::gzip_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<quint32>("crc");
+
+    QTest::newRow("1") << QByteArray("123456789") << (quint32)0xCBF43926;
+    QTest::newRow("2") << QByteArray("The quick brown fox jumps over the lazy dog") << (quint32)0x414FA339;
+}
+
+
+void LZ4Compress::gzip()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(quint32, crc);
+
+    QByteArray comp = Tf::gzipCompress(data);
+    QCOMPARE((uchar)comp[0], (uchar)0x1f);
+    QCOMPARE((uchar)comp[1], (uchar)0x8b);
+    QCOMPARE(qFromLittleEndian<quint32>(comp.constData() + comp.length() - 8), crc);
+    QCOMPARE(qFromLittleEndian<quint32>(comp.constData() + comp.length() - 4), (quint32)data.length());
+
+    // Same deflate data as the zlib format
+    QByteArray zlib = Tf::deflateCompress(data);
+    QCOMPARE(comp.mid(10, comp.length() - 18), zlib.mid(2, zlib.length() - 6));
+}
+
+
 void LZ4Compress::bench_lz4_l1_512()
 {
     auto d = dummydata.mid(0, 512);
@@ -13,6 +13,16 @@ private slots:
     void escapeQuotes();
     void escapeNoQuotes_data();
     void escapeNoQuotes();
+    void escapeUtf8_data();
+    void escapeUtf8();
+    void benchmark_escape_plain();
+    void benchmark_escape_html();
+    void benchmark_escapeUtf8_plain();
+    void benchmark_escapeUtf8_html();
+
+private:
+    static QString plainText();
+    static QString htmlText();
 };
 
 
@@ -85,5 +95,75 @@ void HtmlParser::escapeNoQuotes()
     QCOMPARE(actualStr, correct);
 }
 
+void HtmlParser::escapeUtf8_data()
+{
+     QTest::addColumn<QString>("string");
+     QTest::addColumn<int>("flag");
+
+     QTest::newRow("1") << QString::fromUtf8(u8"こんにちは") << (int)Tf::Quotes;
+     QTest::newRow("2") << "<a href=\"hoge\">a & b</a>" << (int)Tf::Compatible;
+     QTest::newRow("3") << "A 'quote' is <b>bold</b>" << (int)Tf::Quotes;
+     QTest::newRow("4") << "A 'quote' is <b>bold</b>" << (int)Tf::NoQuotes;
+     QTest::newRow("5") << QString::fromUtf8(u8"0123456789abcdef<0123456789abcdef>ハロー&'\"") << (int)Tf::Quotes;
+     QTest::newRow("6") << plainText() << (int)Tf::Quotes;
+     QTest::newRow("7") << htmlText() << (int)Tf::Compatible;
+}
+
+void HtmlParser::escapeUtf8()
+{
+    QFETCH(QString, string);
+    QFETCH(int, flag);
+
+    QString escaped = THttpUtility::htmlEscape(string, (Tf::EscapeFlag)flag);
+    QCOMPARE(THttpUtility::htmlEscapeUtf8(string.toUtf8(), (Tf::EscapeFlag)flag), escaped.toUtf8());
+    QCOMPARE(THttpUtility::htmlEscape(string.toUtf8(), (Tf::EscapeFlag)flag), escaped);
+}
+
+void HtmlParser::benchmark_escape_plain()
+{
+    const QString text = plainText();
+    QBENCHMARK {
+        QString escaped = THttpUtility::htmlEscape(text);
+        QCOMPARE(escaped.length(), text.length());
+    }
+}
+
+void HtmlParser::benchmark_escape_html()
+{
+    const QString text = htmlText();
+    QBENCHMARK {
+        QString escaped = THttpUtility::htmlEscape(text);
+        QVERIFY(escaped.length() > text.length());
+    }
+}
+
+void HtmlParser::benchmark_escapeUtf8_plain()
+{
+    const QByteArray text = plainText().toUtf8();
+    QBENCHMARK {
+        QByteArray escaped = THttpUtility::htmlEscapeUtf8(text);
+        QCOMPARE(escaped.length(), text.length());
+    }
+}
+
+void HtmlParser::benchmark_escapeUtf8_html()
+{
+    const QByteArray text = htmlText().toUtf8();
+    QBENCHMARK {
+        QByteArray escaped = THttpUtility::htmlEscapeUtf8(text);
+        QVERIFY(escaped.length() > text.length());
+    }
+}
+
+QString HtmlParser::plainText()
+{
+    return QString::fromUtf8(u8"The quick brown fox jumps over the lazy dog. こんにちは世界。").repeated(100);
+}
+
+QString HtmlParser::htmlText()
+{
+    return QString::fromUtf8(u8"<p class=\"text\">Tom &amp; Jerry's <b>show</b> こんにちは</p>\n").repeated(100);
+}
+
 TF_TEST_SQLLESS_MAIN(HtmlParser)
 #include "main.moc"
@@ -1,6 +1,7 @@
 #include <TfTest/TfTest>
 #include <QJSEngine>
 #include <QJSValue>
+#include <thread>
 #include "../../tjsmodule.h"
 #include "../../tjsinstance.h"
 #include "../../tjsloader.h"
@@ -38,6 +39,9 @@ private slots:
     void reactComponent_data();
     void reactComponent();
     void benchmark();
+    void benchmark_compileJsx();
+    void benchmark_reactComponent();
+    void reactComponentWarmEngine();
 };
 
 
@@ -235,6 +239,15 @@ void JSContext::benchmark()
 }
 
 
+void JSContext::benchmark_compileJsx()
+{
+    QVERIFY(!TJSLoader::compileJsx("<HelloWorld />").isEmpty());
+    QBENCHMARK {
+        TJSLoader::compileJsx("<HelloWorld />");
+    }
+}
+
+
 void JSContext::load_data()
 {
     QTest::addColumn<QString>("file");
@@ -289,6 +302,37 @@ void JSContext::react()
     QCOMPARE(output, result);
 }
 
+
+void JSContext::benchmark_reactComponent()
+{
+    // Renders with the warm engine of a render thread as TActionView does
+    TReactComponent comp("js/react_samlple.jsx");
+    QVERIFY(!comp.renderToString("<MyComponent/>").isEmpty());
+    QBENCHMARK {
+        TReactComponent(QString("js/react_samlple.jsx")).renderToString("<MyComponent/>");
+    }
+}
+
+
+void JSContext::reactComponentWarmEngine()
+{
+    TReactComponent comp("js/react_samlple.jsx");
+    QVERIFY(!comp.renderToString("<MyComponent/>").isEmpty());
+    const QDateTime loaded = comp.loadedDateTime();
+    QVERIFY(loaded.isValid());
+
+    // Threads started for each connection in the thread MPM
+    for (int i = 0; i < 3; i++) {
+        QDateTime actual;
+        std::thread([&]() {
+            TReactComponent c("js/react_samlple.jsx");
+            c.renderToString("<MyComponent/>");
+            actual = c.loadedDateTime();
+        }).join();
+        QCOMPARE(actual, loaded);
+    }
+}
+
 void JSContext::reactjsx_data()
 {
     QTest::addColumn<QString>("jsxfile");
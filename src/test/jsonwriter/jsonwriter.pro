@@ -0,0 +1,3 @@
+include(../test.pri)
+TEMPLATE = app
+SOURCES = main.cpp
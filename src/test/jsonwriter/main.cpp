@@ -0,0 +1,192 @@
+#include <QTest>
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <TAbstractModel>
+#include <TJsonWriter>
+#include <TModelObject>
+#include <memory>
+
+
+class BlogObject : public TModelObject {
+    Q_OBJECT
+public:
+    int id {0};
+    QString title;
+    QString body;
+    double rating {0};
+    bool published {false};
+    QDateTime created_at;
+
+    bool isNull() const override { return id <= 0; }
+    bool create() override { return true; }
+    bool update() override { return true; }
+    bool save() override { return true; }
+    bool remove() override { return true; }
+
+private:
+    Q_PROPERTY(int id READ getid WRITE setid)
+    T_DEFINE_PROPERTY(int, id)
+    Q_PROPERTY(QString title READ gettitle WRITE settitle)
+    T_DEFINE_PROPERTY(QString, title)
+    Q_PROPERTY(QString body READ getbody WRITE setbody)
+    T_DEFINE_PROPERTY(QString, body)
+    Q_PROPERTY(double rating READ getrating WRITE setrating)
+    T_DEFINE_PROPERTY(double, rating)
+    Q_PROPERTY(bool published READ getpublished WRITE setpublished)
+    T_DEFINE_PROPERTY(bool, published)
+    Q_PROPERTY(QDateTime created_at READ getcreated_at WRITE setcreated_at)
+    T_DEFINE_PROPERTY(QDateTime, created_at)
+};
+
+
+class Blog : public TAbstractModel {
+public:
+    Blog(int id, const QString &title, const QString &body, const QDateTime &createdAt = QDateTime(QDate(2026, 1, 2), QTime(3, 4, 5))) :
+        d(new BlogObject)
+    {
+        d->id = id;
+        d->title = title;
+        d->body = body;
+        d->rating = id / 4.0;
+        d->published = id % 2;
+        d->created_at = createdAt;
+    }
+
+private:
+    std::shared_ptr<BlogObject> d;
+    TModelObject *modelData() override { return d.get(); }
+    const TModelObject *modelData() const override { return d.get(); }
+};
+
+
+static QList<Blog> blogList(int count)
+{
+    QList<Blog> list;
+    for (int i = 1; i <= count; ++i) {
+        list << Blog(i, QStringLiteral("Title %1").arg(i), QStringLiteral("Hello \"world\"\nあいう <b>%1</b>").arg(i));
+    }
+    return list;
+}
+
+
+class TestJsonWriter : public QObject
+{
+    Q_OBJECT
+private slots:
+    void writeString_data();
+    void writeString();
+    void writeModel_data();
+    void writeModel();
+    void writeModelList();
+    void writeNullDateTime();
+    void benchmark_toJsonObject();
+    void benchmark_writer();
+};
+
+
+void TestJsonWriter::writeString_data()
+{
+    QTest::addColumn<QString>("str");
+    QTest::addColumn<QByteArray>("json");
+
+    QTest::newRow("1") << "" << QByteArray("\"\"");
+    QTest::newRow("2") << "hello" << QByteArray("\"hello\"");
+    QTest::newRow("3") << "a\"b\\c/d" << QByteArray("\"a\\\"b\\\\c/d\"");
+    QTest::newRow("4") << "\b\f\n\r\t" << QByteArray("\"\\b\\f\\n\\r\\t\"");
+    QTest::newRow("5") << QString(QChar(0x01)) + QChar(0x1f) << QByteArray("\"\\u0001\\u001f\"");
+    QTest::newRow("6") << QString::fromUtf8("\xe3\x81\x82\"\xf0\x9f\x98\x80") << QByteArray("\"\xe3\x81\x82\\\"\xf0\x9f\x98\x80\"");
+}
+
+
+void TestJsonWriter::writeString()
+{
+    QFETCH(QString, str);
+    QFETCH(QByteArray, json);
+
+    QByteArray buffer;
+    TJsonWriter(buffer).write(str);
+    QCOMPARE(buffer, json);
+    QCOMPARE(QJsonDocument::fromJson("[" + buffer + "]").array().at(0).toString(), str);
+}
+
+
+void TestJsonWriter::writeModel_data()
+{
+    QTest::addColumn<QStringList>("properties");
+
+    QTest::newRow("1") << QStringList();
+    QTest::newRow("2") << QStringList({"id", "title"});
+    QTest::newRow("3") << QStringList({"createdAt"});
+}
+
+
+void TestJsonWriter::writeModel()
+{
+    QFETCH(QStringList, properties);
+
+    Blog blog(3, "foo", "bar\t\"baz\"");
+    QByteArray json = TJsonWriter::toJson(blog, properties);
+    QJsonParseError error;
+    QJsonObject obj = QJsonDocument::fromJson(json, &error).object();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(obj, blog.toJsonObject(properties));
+}
+
+
+void TestJsonWriter::writeModelList()
+{
+    const auto list = blogList(10);
+    QJsonArray expect;
+    for (auto &blog : list) {
+        expect.append(blog.toJsonObject());
+    }
+
+    QByteArray json = TJsonWriter::toJsonArray(list);
+    QCOMPARE(QJsonDocument::fromJson(json).array(), expect);
+    QCOMPARE(TJsonWriter::toJsonArray(QList<Blog>()), QByteArray("[]"));
+}
+
+
+void TestJsonWriter::writeNullDateTime()
+{
+    Blog blog(3, "foo", "bar", QDateTime());
+    QByteArray json = TJsonWriter::toJson(blog);
+    QJsonParseError error;
+    QJsonObject obj = QJsonDocument::fromJson(json, &error).object();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QVERIFY(obj.contains("createdAt"));
+    QVERIFY(obj.value("createdAt").isNull());
+    QCOMPARE(obj.value("title").toString(), QString("foo"));
+
+    QVariantMap map {{"date", QDate()}, {"time", QTime()}, {"today", QDate(2026, 1, 2)}};
+    QByteArray buffer;
+    TJsonWriter(buffer).write(map);
+    QCOMPARE(buffer, QByteArray("{\"date\":null,\"time\":null,\"today\":\"2026-01-02\"}"));
+}
+
+
+void TestJsonWriter::benchmark_toJsonObject()
+{
+    const auto list = blogList(1000);
+    QBENCHMARK {
+        QJsonArray array;
+        for (auto &blog : list) {
+            array.append(blog.toJsonObject());
+        }
+        QByteArray json = QJsonDocument(array).toJson(QJsonDocument::Compact);
+    }
+}
+
+
+void TestJsonWriter::benchmark_writer()
+{
+    const auto list = blogList(1000);
+    QBENCHMARK {
+        QByteArray json = TJsonWriter::toJsonArray(list);
+    }
+}
+
+QTEST_APPLESS_MAIN(TestJsonWriter)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = localcache
+SOURCES = main.cpp
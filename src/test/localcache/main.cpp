@@ -0,0 +1,115 @@
+#include <TfTest/TfTest>
+#include <QtCore>
+#include <thread>
+#include "tlocalcache.h"
+
+const int NUM_THREADS = 16;
+
+
+class TestLocalCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void insertAndGet();
+    void expire();
+    void evict();
+    void tooLarge();
+    void bench_get_multithread();
+};
+
+
+void TestLocalCache::init()
+{
+    TLocalCache::instance().clear();
+}
+
+
+void TestLocalCache::insertAndGet()
+{
+    auto &cache = TLocalCache::instance();
+    QVERIFY(TLocalCache::isEnabled());
+
+    QByteArray value;
+    QVERIFY(!cache.get("foo", value));
+    cache.insert("foo", "hello", 60);
+    QVERIFY(cache.get("foo", value));
+    QCOMPARE(value, QByteArray("hello"));
+
+    cache.insert("foo", "world", 60);
+    QVERIFY(cache.get("foo", value));
+    QCOMPARE(value, QByteArray("world"));
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.totalSize(), (int64_t)8);
+
+    cache.remove("foo");
+    QVERIFY(!cache.get("foo", value));
+    QCOMPARE(cache.totalSize(), (int64_t)0);
+}
+
+
+void TestLocalCache::expire()
+{
+    auto &cache = TLocalCache::instance();
+    cache.insert("foo", "hello", 1);
+    cache.insert("bar", "hello", 60);  // kept for Cache.LocalMaxAge seconds
+
+    QByteArray value;
+    QTest::qSleep(1100);
+    QVERIFY(!cache.get("foo", value));
+    QVERIFY(cache.get("bar", value));
+    QTest::qSleep(1000);
+    QVERIFY(!cache.get("bar", value));
+}
+
+
+void TestLocalCache::evict()
+{
+    auto &cache = TLocalCache::instance();
+    for (int i = 0; i < 2000; ++i) {
+        cache.insert("key" + QByteArray::number(i), QByteArray(100, 'x'), 60);
+    }
+    QVERIFY(cache.totalSize() <= 65536);
+    QVERIFY(cache.count() < 2000);
+
+    // The most recently used one is kept
+    QByteArray value;
+    QVERIFY(cache.get("key1999", value));
+    QVERIFY(!cache.get("key0", value));
+}
+
+
+void TestLocalCache::tooLarge()
+{
+    auto &cache = TLocalCache::instance();
+    cache.insert("foo", QByteArray(65536, 'x'), 60);
+    QByteArray value;
+    QVERIFY(!cache.get("foo", value));
+}
+
+
+void TestLocalCache::bench_get_multithread()
+{
+    auto &cache = TLocalCache::instance();
+    for (int i = 0; i < 100; ++i) {
+        cache.insert("key" + QByteArray::number(i), QByteArray(100, 'x'), 60);
+    }
+
+    QBENCHMARK {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            threads.emplace_back([&cache]() {
+                QByteArray value;
+                for (int i = 0; i < 10000; ++i) {
+                    cache.get("key" + QByteArray::number(i % 100), value);
+                }
+            });
+        }
+        for (auto &th : threads) {
+            th.join();
+        }
+    }
+}
+
+TF_TEST_SQLLESS_MAIN(TestLocalCache)
+#include "main.moc"
@@ -1,6 +1,7 @@
 #include <TfTest/TfTest>
 #include "tsharedmemoryallocator.h"
 #include "tglobal.h"
+#include <vector>
 
 
 class TestMalloc : public QObject
@@ -20,8 +21,11 @@ private slots:
     void testAlloc7();
     void testAlloc8();
     void testReuse1();
+    void testFreeLists();
 
     void bench();
+    void bench_fragmentation();
+    void bench_many_blocks();
 };
 
 
@@ -231,6 +235,37 @@ void TestMalloc::testReuse1()
     QCOMPARE(alloc->dataSegmentSize(), 0U);
 }
 
+void TestMalloc::testFreeLists()
+{
+    constexpr int NUM = 1000;
+    void *ptr[NUM];
+
+    for (int i = 0; i < NUM; i++) {
+        ptr[i] = alloc->malloc((i % 2) ? 64 : 500);
+        QVERIFY(ptr[i]);
+    }
+    for (int i = 0; i < NUM - 1; i += 2) {
+        alloc->free(ptr[i]);
+    }
+    QCOMPARE(alloc->countFreeBlocks(), NUM / 2);
+    alloc->summary();
+
+    // Takes the free blocks of the larger size class
+    for (int i = 0; i < NUM - 1; i += 2) {
+        ptr[i] = alloc->malloc(300);
+        QVERIFY(ptr[i]);
+    }
+    QCOMPARE(alloc->countBlocks(), NUM);
+    QCOMPARE(alloc->countFreeBlocks(), 0);
+
+    for (int i = 0; i < NUM; i++) {
+        alloc->free(ptr[i]);
+    }
+    QCOMPARE(alloc->countBlocks(), 0);
+    QCOMPARE(alloc->countFreeBlocks(), 0);
+    QCOMPARE(alloc->dataSegmentSize(), 0U);
+}
+
 
 void TestMalloc::bench()
 {
@@ -264,5 +299,70 @@ void TestMalloc::bench()
 }
 
 
+// Allocates and frees blocks of widely varying sizes, and shows how much
+// of the data segment is left in free blocks
+void TestMalloc::bench_fragmentation()
+{
+    constexpr int NUM = 1024 * 16;
+    std::vector<void *> ptr(NUM, nullptr);
+
+    QBENCHMARK {
+        for (int i = 0; i < 100000; i++) {
+            int d = Tf::random(0, NUM - 1);
+            if (ptr[d]) {
+                alloc->free(ptr[d]);
+                ptr[d] = nullptr;
+            } else {
+                ptr[d] = alloc->malloc(1u << (int)Tf::random(5, 13));  // 32 - 8192 bytes
+                QVERIFY(ptr[d]);
+            }
+        }
+    }
+
+    double ratio = (double)alloc->sizeOfFreeBlocks() / alloc->dataSegmentSize();
+    qInfo("blocks: %d, free blocks: %d, free ratio of data segment: %.1f%%", alloc->countBlocks(), alloc->countFreeBlocks(), ratio * 100);
+
+    for (auto p : ptr) {
+        alloc->free(p);
+    }
+    QCOMPARE(alloc->countBlocks(), 0);
+}
+
+// Allocates and frees while a few hundred thousand blocks are live, as
+// in a large shared memory cache
+void TestMalloc::bench_many_blocks()
+{
+    constexpr int NUM = 300000;
+    std::vector<void *> ptr(NUM, nullptr);
+
+    for (int i = 0; i < NUM; i++) {
+        ptr[i] = alloc->malloc(Tf::random(64, 512));
+        QVERIFY(ptr[i]);
+    }
+    for (int i = 0; i < NUM; i += 3) {
+        alloc->free(ptr[i]);  // makes holes
+        ptr[i] = nullptr;
+    }
+
+    QBENCHMARK {
+        for (int i = 0; i < 10000; i++) {
+            int d = Tf::random(0, NUM - 1);
+            if (ptr[d]) {
+                alloc->free(ptr[d]);
+                ptr[d] = nullptr;
+            } else {
+                ptr[d] = alloc->malloc(Tf::random(64, 512));
+                QVERIFY(ptr[d]);
+            }
+        }
+    }
+
+    for (auto p : ptr) {
+        alloc->free(p);
+    }
+    QCOMPARE(alloc->countBlocks(), 0);
+}
+
+
 TF_TEST_MAIN(TestMalloc)
 #include "malloc.moc"
@@ -1,6 +1,7 @@
 #include <TfTest/TfTest>
 #include <TMemcached>
 #include <QDateTime>
+#include "tsessionmemcachedstore.h"
 
 
 static QByteArray randomString(int length)
@@ -49,6 +50,9 @@ private slots:
     void version();
     void keyError_data();
     void keyError();
+    void multi();
+    void touch();
+    void sessionTouch();
 };
 
 
@@ -709,5 +713,60 @@ void TestMemcached::keyError()
 }
 
 
+void TestMemcached::multi()
+{
+    QMap<QByteArray, QByteArray> items;
+    QByteArrayList keys;
+    for (int i = 0; i < 30; ++i) {
+        QByteArray key = "multi" + QByteArray::number(QDateTime::currentMSecsSinceEpoch()) + "_" + QByteArray::number(i);
+        items.insert(key, randomString(Tf::random(1, 8192)));
+        keys << key;
+    }
+
+    TMemcached memcached;
+    QCOMPARE(memcached.set(items, 10), items.count());
+    QCOMPARE(memcached.get(keys + QByteArrayList {"multinotfound"}), items);
+    QCOMPARE(memcached.remove(keys.mid(0, 10)), 10);
+    QCOMPARE(memcached.get(keys).count(), 20);
+}
+
+
+void TestMemcached::touch()
+{
+    QByteArray key = "touch" + QByteArray::number(QDateTime::currentMSecsSinceEpoch());
+    TMemcached memcached;
+    QVERIFY(memcached.set(key, "touch", 1));
+    QVERIFY(memcached.touch(key, 10));
+    QTest::qSleep(2000);
+    QVERIFY(!memcached.get(key).isNull());  // extended
+    QVERIFY(!memcached.touch(key + "notfound", 10));
+    memcached.remove(key);
+}
+
+
+void TestMemcached::sessionTouch()
+{
+    TSessionMemcachedStore store;
+    TSession session(QByteArray::number(QDateTime::currentMSecsSinceEpoch()));
+    session.insert("user", "foo");
+    QVERIFY(store.store(session));
+
+    // Expires in a second unless touched
+    TMemcached memcached;
+    QVERIFY(memcached.touch('_' + session.id(), 1));
+    QVERIFY(store.touch(session));
+    QTest::qSleep(2000);
+    QCOMPARE(store.find(session.id()).value("user").toString(), QString("foo"));
+
+    // Stores the session not found
+    TSession missing(session.id() + "missing");
+    missing.insert("user", "bar");
+    QVERIFY(store.touch(missing));
+    QCOMPARE(store.find(missing.id()).value("user").toString(), QString("bar"));
+    QVERIFY(store.remove(session.id()));
+    QVERIFY(store.remove(missing.id()));
+}
+
+
 TF_TEST_MAIN(TestMemcached)
 #include "memcached.moc"
@@ -1,6 +1,7 @@
 #include <TfTest/TfTest>
 #include <TRedis>
 #include <QDateTime>
+#include "tsessionredisstore.h"
 
 
 static QString randomString(int length)
@@ -36,6 +37,9 @@ private slots:
     void setnxGet();
     void getSet_data();
     void getSet();
+    void multi();
+    void expire();
+    void sessionTouch();
 
     void setsGet_data();
     void setsGet();
@@ -411,5 +415,64 @@ void TestRedis::getSets()
 }
 
 
+void TestRedis::multi()
+{
+    QMap<QByteArray, QByteArray> items;
+    QByteArrayList keys;
+    for (int i = 0; i < 30; ++i) {
+        QByteArray key = "multi" + QByteArray::number(QDateTime::currentMSecsSinceEpoch()) + "_" + QByteArray::number(i);
+        items.insert(key, randomString(Tf::random(1, 8192)).toLatin1());
+        keys << key;
+    }
+
+    TRedis redis;
+    QCOMPARE(redis.msetEx(items, 10), items.count());
+    auto values = redis.mget(keys + QByteArrayList {"multinotfound"});
+    QCOMPARE(values.count(), keys.count() + 1);
+    for (int i = 0; i < keys.count(); ++i) {
+        QCOMPARE(values[i], items[keys[i]]);
+    }
+    QVERIFY(values.last().isNull());
+    QCOMPARE(redis.del(keys), (int)keys.count());
+}
+
+
+void TestRedis::expire()
+{
+    QByteArray key = "expire" + QByteArray::number(QDateTime::currentMSecsSinceEpoch());
+    TRedis redis;
+    QVERIFY(redis.setEx(key, "touch", 1));
+    QVERIFY(redis.expire(key, 10));
+    QTest::qSleep(2000);
+    QVERIFY(redis.exists(key));  // extended
+    QVERIFY(!redis.expire(key + "notfound", 10));
+    redis.del(key);
+}
+
+
+void TestRedis::sessionTouch()
+{
+    TSessionRedisStore store;
+    TSession session(QByteArray::number(QDateTime::currentMSecsSinceEpoch()));
+    session.insert("user", "foo");
+    QVERIFY(store.store(session));
+
+    // Expires in a second unless touched
+    TRedis redis;
+    QVERIFY(redis.expire('_' + session.id(), 1));
+    QVERIFY(store.touch(session));
+    QTest::qSleep(2000);
+    QCOMPARE(store.find(session.id()).value("user").toString(), QString("foo"));
+
+    // Stores the session not found
+    TSession missing(session.id() + "missing");
+    missing.insert("user", "bar");
+    QVERIFY(store.touch(missing));
+    QCOMPARE(store.find(missing.id()).value("user").toString(), QString("bar"));
+    QVERIFY(store.remove(session.id()));
+    QVERIFY(store.remove(missing.id()));
+}
+
+
 TF_TEST_MAIN(TestRedis)
 #include "redis.moc"
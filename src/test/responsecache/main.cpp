@@ -0,0 +1,143 @@
+#include <TfTest/TfTest>
+#include <QtCore>
+#include <THttpRequest>
+#include <atomic>
+#include <thread>
+#include "tresponsecache.h"
+#include "turlroute.h"
+
+const int NUM_THREADS = 8;
+
+
+class TestResponseCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void init();
+    void key();
+    void storeAndAcquire();
+    void gzipNotServedToIdentityClient();
+    void coalescing();
+};
+
+
+static THttpRequestHeader requestHeader(const QByteArray &path, const QByteArray &acceptEncoding = QByteArray())
+{
+    QByteArray raw = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n";
+    if (!acceptEncoding.isEmpty()) {
+        raw += "Accept-Encoding: " + acceptEncoding + "\r\n";
+    }
+    raw += "\r\n";
+    return THttpRequestHeader(raw);
+}
+
+static TRouting cachedRouting()
+{
+    TRouting routing("bookcontroller", "index");
+    routing.cache.seconds = 10;
+    routing.cache.queryItems << "page";
+    return routing;
+}
+
+
+void TestResponseCache::init()
+{
+    TResponseCache::instance().clear();
+}
+
+
+void TestResponseCache::key()
+{
+    TRouting routing = cachedRouting();
+    THttpRequest req1(requestHeader("/Book?page=1&sort=title"), QByteArray(), QHostAddress(), nullptr);
+    THttpRequest req2(requestHeader("/Book?page=1"), QByteArray(), QHostAddress(), nullptr);
+    THttpRequest req3(requestHeader("/Book?page=2"), QByteArray(), QHostAddress(), nullptr);
+    THttpRequest req4(requestHeader("/Book?page=1", "gzip, deflate"), QByteArray(), QHostAddress(), nullptr);
+
+    QCOMPARE(TResponseCache::key(routing, req1), TResponseCache::key(routing, req2));
+    QVERIFY(TResponseCache::key(routing, req2) != TResponseCache::key(routing, req3));
+    QVERIFY(TResponseCache::key(routing, req2) != TResponseCache::key(routing, req4));
+}
+
+
+void TestResponseCache::storeAndAcquire()
+{
+    QByteArray key = "/Book\t";
+    bool renderer;
+
+    QVERIFY(!TResponseCache::instance().acquire(key, &renderer));
+    QVERIFY(renderer);
+
+    THttpResponseHeader header;
+    header.setContentType("text/html");
+    TResponseCache::instance().store(key, header, "<html>book</html>", 10);
+    TResponseCache::instance().release(key);
+
+    auto entry = TResponseCache::instance().acquire(key, &renderer);
+    QVERIFY(entry);
+    QVERIFY(!renderer);
+    QCOMPARE(entry->body, QByteArray("<html>book</html>"));
+    QCOMPARE(TResponseCache::instance().count(), 1);
+}
+
+
+void TestResponseCache::gzipNotServedToIdentityClient()
+{
+    // A gzipped body as stored by renderOnCache() for a gzip client
+    TRouting routing = cachedRouting();
+    THttpRequest gzipReq(requestHeader("/Book?page=1", "gzip"), QByteArray(), QHostAddress(), nullptr);
+    THttpRequest identityReq(requestHeader("/Book?page=1"), QByteArray(), QHostAddress(), nullptr);
+    QByteArray gzipKey = TResponseCache::key(routing, gzipReq);
+    QByteArray identityKey = TResponseCache::key(routing, identityReq);
+    bool renderer;
+
+    QVERIFY(!TResponseCache::instance().acquire(gzipKey, &renderer));
+    THttpResponseHeader header;
+    header.setRawHeader("Content-Encoding", "gzip");
+    TResponseCache::instance().store(gzipKey, header, Tf::gzipCompress("<html>book</html>"), 10);
+    TResponseCache::instance().release(gzipKey);
+
+    auto entry = TResponseCache::instance().acquire(identityKey, &renderer);
+    QVERIFY(!entry);
+    QVERIFY(renderer);  // renders the identity body
+    TResponseCache::instance().release(identityKey);
+
+    entry = TResponseCache::instance().acquire(gzipKey, &renderer);
+    QVERIFY(entry);
+    QCOMPARE(entry->header.rawHeader("Content-Encoding"), QByteArray("gzip"));
+}
+
+
+void TestResponseCache::coalescing()
+{
+    const QByteArray key = "/Book\tgzip";
+    const QByteArray body = "<html>rendered once</html>";
+    std::atomic<int> renderers {0};
+    std::atomic<int> hits {0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([&]() {
+            bool renderer;
+            auto entry = TResponseCache::instance().acquire(key, &renderer);
+            if (renderer) {
+                // Keeps the others waiting while rendering
+                renderers++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                TResponseCache::instance().store(key, THttpResponseHeader(), body, 10);
+                TResponseCache::instance().release(key);
+            } else if (entry && entry->body == body) {
+                hits++;
+            }
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+
+    QCOMPARE(renderers.load(), 1);
+    QCOMPARE(hits.load(), NUM_THREADS - 1);
+}
+
+TF_TEST_SQLLESS_MAIN(TestResponseCache)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = responsecache
+SOURCES = main.cpp
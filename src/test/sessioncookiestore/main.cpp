@@ -0,0 +1,202 @@
+#include <TfTest/TfTest>
+#include <QtCore>
+#include "tsessioncookiestore.h"
+
+const QByteArray SECRET = "0a1b2c3d4e5f6g7h8i9j0k1l2m3n4o5p6q7r8s9t";
+const QByteArray PREVIOUS_SECRET = "previous-secret-2";
+
+
+class TestSessionCookieStore : public QObject
+{
+    Q_OBJECT
+private slots:
+    void storeAndFind();
+    void compression();
+    void tampered();
+    void previousSecret();
+    void legacyFormat();
+    void storedTime();
+    void bench_store();
+    void bench_find();
+    void bench_find_legacy();
+};
+
+
+static TSession createSession(int size = 16)
+{
+    TSession session;
+    session.insert("user", QStringLiteral("foo あいう"));
+    session.insert("count", -123);
+    session.insert("id", Q_INT64_C(1234567890123));
+    session.insert("rate", 0.25);
+    session.insert("login", true);
+    session.insert("null", QVariant());
+    session.insert("data", QByteArray(size, 'x'));
+    session.insert("date", QDateTime(QDate(2026, 1, 2), QTime(3, 4, 5)));
+    return session;
+}
+
+static QVariantMap variantMap(const TSession &session)
+{
+    return *static_cast<const QVariantMap *>(&session);
+}
+
+// Cookie in the format of the former versions
+static QByteArray legacyCookie(const TSession &session)
+{
+    QByteArray ba;
+    QDataStream ds(&ba, QIODevice::WriteOnly);
+    ds << variantMap(session);
+    ba = Tf::lz4Compress(ba);
+    QByteArray digest = QMessageAuthenticationCode::hash(ba, SECRET, QCryptographicHash::Sha3_256);
+    return ba.toBase64() + "_" + digest.toBase64();
+}
+
+
+void TestSessionCookieStore::storeAndFind()
+{
+    TSessionCookieStore store;
+    TSession session = createSession();
+    QVERIFY(store.store(session));
+    QVERIFY(session.id().contains('.'));
+
+    TSession found = store.find(session.id());
+    QCOMPARE(variantMap(found), variantMap(session));
+    QCOMPARE(found.value("count").typeId(), (int)QMetaType::Int);
+    QCOMPARE(found.value("id").typeId(), (int)QMetaType::LongLong);
+
+    TSession empty;
+    QVERIFY(store.store(empty));
+    QVERIFY(empty.id().isEmpty());
+}
+
+
+void TestSessionCookieStore::compression()
+{
+    TSessionCookieStore store;
+    TSession small = createSession(16);
+    TSession large = createSession(2000);
+    QVERIFY(store.store(small));
+    QVERIFY(store.store(large));
+
+    // Compressed only above the threshold
+    QByteArray data = QByteArray::fromBase64(large.id().split('.').value(0), QByteArray::Base64UrlEncoding);
+    QVERIFY((uchar)data[0] & 0x80);
+    QVERIFY(data.length() < 1000);
+    data = QByteArray::fromBase64(small.id().split('.').value(0), QByteArray::Base64UrlEncoding);
+    QVERIFY(!((uchar)data[0] & 0x80));
+
+    QCOMPARE(variantMap(store.find(large.id())), variantMap(large));
+}
+
+
+void TestSessionCookieStore::tampered()
+{
+    TSessionCookieStore store;
+    TSession session = createSession();
+    QVERIFY(store.store(session));
+
+    QByteArray cookie = session.id();
+    cookie[3] = (cookie[3] == 'A') ? 'B' : 'A';
+    QVERIFY(store.find(cookie).isEmpty());
+    QVERIFY(store.find(cookie.left(cookie.indexOf('.') + 1)).isEmpty());
+    QVERIFY(store.find("foo.bar").isEmpty());
+    QVERIFY(store.find("foo_bar").isEmpty());
+}
+
+
+void TestSessionCookieStore::previousSecret()
+{
+    TSessionCookieStore store;
+    TSession session = createSession();
+    QVERIFY(store.store(session));
+
+    // Signs again by the previous secret
+    QByteArray encoded = session.id().split('.').value(0);
+    QByteArray data = QByteArray::fromBase64(encoded, QByteArray::Base64UrlEncoding);
+    QByteArray digest = QMessageAuthenticationCode::hash(data, PREVIOUS_SECRET, QCryptographicHash::Sha256);
+    QByteArray cookie = encoded + '.' + digest.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    QVERIFY(cookie != session.id());
+    QCOMPARE(variantMap(store.find(cookie)), variantMap(session));
+
+    digest = QMessageAuthenticationCode::hash(data, "unknown-secret", QCryptographicHash::Sha256);
+    cookie = encoded + '.' + digest.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    QVERIFY(store.find(cookie).isEmpty());
+}
+
+
+void TestSessionCookieStore::legacyFormat()
+{
+    TSessionCookieStore store;
+    TSession session = createSession();
+    QCOMPARE(variantMap(store.find(legacyCookie(session))), variantMap(session));
+}
+
+
+void TestSessionCookieStore::storedTime()
+{
+    TSessionCookieStore store;
+    TSession session = createSession();
+    QVERIFY(store.store(session));
+
+    // Decoded with the time stored, which throttles the touch
+    TSession found = store.find(session.id());
+    QVERIFY(found.storedDateTime().isValid());
+    QVERIFY(qAbs(found.storedDateTime().secsTo(QDateTime::currentDateTime())) <= 1);
+
+    // Unknown in the former format
+    QVERIFY(!store.find(legacyCookie(session)).storedDateTime().isValid());
+}
+
+
+void TestSessionCookieStore::bench_store()
+{
+    TSessionCookieStore store;
+    TSession session = createSession();
+    QBENCHMARK {
+        for (int i = 0; i < 1000; ++i) {
+            session.insert("count", i);
+            store.store(session);
+        }
+    }
+}
+
+
+void TestSessionCookieStore::bench_find()
+{
+    TSessionCookieStore store;
+    QByteArrayList cookies;
+    for (int i = 0; i < 1000; ++i) {
+        TSession session = createSession();
+        session.insert("count", i);
+        store.store(session);
+        cookies << session.id();
+    }
+
+    QBENCHMARK {
+        for (auto &cookie : cookies) {
+            store.find(cookie);
+        }
+    }
+}
+
+
+void TestSessionCookieStore::bench_find_legacy()
+{
+    TSessionCookieStore store;
+    QByteArrayList cookies;
+    for (int i = 0; i < 1000; ++i) {
+        TSession session = createSession();
+        session.insert("count", i);
+        cookies << legacyCookie(session);
+    }
+
+    QBENCHMARK {
+        for (auto &cookie : cookies) {
+            store.find(cookie);
+        }
+    }
+}
+
+TF_TEST_SQLLESS_MAIN(TestSessionCookieStore)
+#include "main.moc"
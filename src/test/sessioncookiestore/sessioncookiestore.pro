@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = sessioncookiestore
+SOURCES = main.cpp
@@ -0,0 +1,342 @@
+#include <TfTest/TfTest>
+#include <QtCore>
+#include <atomic>
+#include <thread>
+#include "tsessionfilestore.h"
+#include "tsessionmanager.h"
+
+const int NUM_THREADS = 16;
+const int NUM_SESSIONS = 200;
+
+
+class TestSessionFileStore : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void storeAndFind();
+    void touch();
+    void unmodifiedSession();
+    void modifiedSession();
+    void touchRequired();
+    void remove();
+    void invalidId();
+    void gc();
+    void gcBatchSweep();
+    void gcSettings();
+    void collectGarbageInBatches();
+    void noGcInRequests();
+    void concurrentStore();
+    void bench_store_multithread();
+    void bench_find_multithread();
+};
+
+
+static QByteArray sessionId(int thread, int i)
+{
+    return QCryptographicHash::hash(QByteArray::number(thread) + '-' + QByteArray::number(i), QCryptographicHash::Md5).toHex();
+}
+
+static TSession createSession(const QByteArray &id)
+{
+    TSession session(id);
+    session.insert("user", QString::fromLatin1(id));
+    session.insert("count", 123);
+    session.insert("data", QByteArray(512, 'x'));
+    return session;
+}
+
+static QString sessionFilePath(const QByteArray &id)
+{
+    QDirIterator it(TSessionFileStore::sessionDirPath(), {QString::fromLatin1(id)}, QDir::Files, QDirIterator::Subdirectories);
+    return it.hasNext() ? it.next() : QString();
+}
+
+static bool setModified(const QString &filePath, const QDateTime &modified)
+{
+    QFile file(filePath);
+    return file.open(QIODevice::ReadOnly) && file.setFileTime(modified, QFileDevice::FileModificationTime);
+}
+
+// Runs the function concurrently in the threads as the multi-threaded MPM does
+template <class Function>
+static void runThreads(Function func)
+{
+    std::vector<std::thread> threads;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        threads.emplace_back([t, &func]() { func(t); });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+}
+
+
+void TestSessionFileStore::initTestCase()
+{
+    QDir(TSessionFileStore::sessionDirPath()).removeRecursively();
+}
+
+
+void TestSessionFileStore::storeAndFind()
+{
+    TSessionFileStore store;
+    TSession session = createSession(sessionId(0, 0));
+    QVERIFY(store.store(session));
+
+    TSession found = store.find(session.id());
+    QCOMPARE(found.id(), session.id());
+    QCOMPARE(*static_cast<QVariantMap *>(&found), *static_cast<QVariantMap *>(&session));
+    QVERIFY(found.storedDateTime().isValid());
+
+    // Overwrites
+    session.insert("count", 456);
+    QVERIFY(store.store(session));
+    QCOMPARE(store.find(session.id()).value("count").toInt(), 456);
+
+    QVERIFY(store.find(sessionId(0, 1)).isEmpty());
+}
+
+
+void TestSessionFileStore::touch()
+{
+    TSessionFileStore store;
+    TSession session = createSession(sessionId(0, 2));
+    QVERIFY(store.store(session));
+
+    QString path = sessionFilePath(session.id());
+    QVERIFY(!path.isEmpty());
+    QVERIFY(setModified(path, QDateTime::currentDateTime().addSecs(-60)));
+
+    QVERIFY(store.touch(session));
+    QVERIFY(QFileInfo(path).lastModified() > QDateTime::currentDateTime().addSecs(-10));
+}
+
+
+void TestSessionFileStore::unmodifiedSession()
+{
+    auto &manager = TSessionManager::instance();
+    TSession session = createSession(manager.generateId());
+    QVERIFY(session.isModified());
+    QVERIFY(manager.store(session));
+    QVERIFY(!session.isModified());
+
+    QString path = sessionFilePath(session.id());
+    QDateTime modified = QDateTime::currentDateTime().addSecs(-5);
+    QVERIFY(setModified(path, modified));
+
+    // Found just after stored; neither re-stored nor touched
+    TSession found = manager.findSession(session.id());
+    QCOMPARE(found.id(), session.id());
+    QVERIFY(!found.isModified());
+    QVERIFY(!manager.isTouchRequired(found));
+
+    // Setting the same value is not a modification
+    found.insert("count", 123);
+    QVERIFY(!found.isModified());
+    QCOMPARE(QFileInfo(path).lastModified().toSecsSinceEpoch(), modified.toSecsSinceEpoch());
+}
+
+
+void TestSessionFileStore::modifiedSession()
+{
+    auto &manager = TSessionManager::instance();
+    TSession session = createSession(manager.generateId());
+    QVERIFY(manager.store(session));
+
+    TSession found = manager.findSession(session.id());
+    found.insert("count", 456);
+    QVERIFY(found.isModified());
+    QVERIFY(manager.store(found));
+    QVERIFY(!found.isModified());
+    QCOMPARE(manager.findSession(session.id()).value("count").toInt(), 456);
+
+    found.remove("data");
+    QVERIFY(found.isModified());
+    QVERIFY(manager.store(found));
+    QVERIFY(!manager.findSession(session.id()).contains("data"));
+}
+
+
+void TestSessionFileStore::touchRequired()
+{
+    auto &manager = TSessionManager::instance();
+    TSession session = createSession(manager.generateId());
+    QVERIFY(manager.store(session));
+
+    // Stored more than a tenth of Session.GcMaxLifeTime ago
+    QString path = sessionFilePath(session.id());
+    QVERIFY(setModified(path, QDateTime::currentDateTime().addSecs(-600)));
+
+    TSession found = manager.findSession(session.id());
+    QVERIFY(!found.isModified());
+    QVERIFY(manager.isTouchRequired(found));
+
+    // Extends the expiry without changing the data
+    QVERIFY(manager.touch(found));
+    QVERIFY(!manager.isTouchRequired(found));
+    QVERIFY(QFileInfo(path).lastModified() > QDateTime::currentDateTime().addSecs(-10));
+    TSession touched = manager.findSession(session.id());
+    QCOMPARE(*static_cast<QVariantMap *>(&touched), *static_cast<QVariantMap *>(&session));
+    QVERIFY(!manager.isTouchRequired(touched));
+}
+
+
+void TestSessionFileStore::remove()
+{
+    TSessionFileStore store;
+    TSession session = createSession(sessionId(0, 3));
+    QVERIFY(store.store(session));
+    QVERIFY(store.remove(session.id()));
+    QVERIFY(store.find(session.id()).isEmpty());
+}
+
+
+void TestSessionFileStore::invalidId()
+{
+    TSessionFileStore store;
+    TSession session = createSession("../session");
+    QVERIFY(!store.store(session));
+    QVERIFY(store.find("../session").isEmpty());
+    QVERIFY(store.find(".hidden").isEmpty());
+}
+
+
+void TestSessionFileStore::gc()
+{
+    TSessionFileStore store;
+    for (int i = 0; i < 10; ++i) {
+        TSession session = createSession(sessionId(1, i));
+        QVERIFY(store.store(session));
+    }
+
+    QDateTime expire = QDateTime::currentDateTime().addSecs(10);
+    QCOMPARE(store.gcBatch(expire, 3), 3);
+    QVERIFY(store.gc(expire) >= 7);
+    QCOMPARE(store.gc(expire), 0);
+}
+
+
+void TestSessionFileStore::gcBatchSweep()
+{
+    TSessionFileStore store;
+    store.gc(QDateTime::currentDateTime().addSecs(10));  // removes all
+
+    const QDateTime expired = QDateTime::currentDateTime().addSecs(-3600);
+    for (int i = 0; i < 10; ++i) {
+        TSession session = createSession(sessionId(5, i));
+        QVERIFY(store.store(session));
+        if (i % 2 == 0) {
+            QVERIFY(setModified(sessionFilePath(session.id()), expired));
+        }
+    }
+
+    // Batches resuming the pass over the directory: 2 + 2 + 1
+    const QDateTime expire = QDateTime::currentDateTime().addSecs(-60);
+    QCOMPARE(store.gcBatch(expire, 2), 2);
+    QCOMPARE(store.gcBatch(expire, 2), 2);
+    QCOMPARE(store.gcBatch(expire, 2), 1);
+    for (int i = 1; i < 10; i += 2) {
+        QVERIFY(!store.find(sessionId(5, i)).isEmpty());
+    }
+
+    // Swept to the end; the next batch starts a new pass
+    TSession session = createSession(sessionId(5, 10));
+    QVERIFY(store.store(session));
+    QVERIFY(setModified(sessionFilePath(session.id()), expired));
+    QCOMPARE(store.gcBatch(expire, 2), 1);
+}
+
+
+void TestSessionFileStore::gcSettings()
+{
+    QCOMPARE(TSessionManager::gcInterval(), 60);
+    QCOMPARE(TSessionManager::gcBatchSize(), 3);
+}
+
+
+void TestSessionFileStore::collectGarbageInBatches()
+{
+    TSessionFileStore store;
+    store.gcBatch(QDateTime::currentDateTime().addSecs(10), 0);  // removes all
+
+    // Expired by Session.GcMaxLifeTime
+    const QDateTime expired = QDateTime::currentDateTime().addSecs(-3600);
+    for (int i = 0; i < 10; ++i) {
+        TSession session = createSession(sessionId(3, i));
+        QVERIFY(store.store(session));
+        QVERIFY(setModified(sessionFilePath(session.id()), expired));
+    }
+    TSession alive = createSession(sessionId(3, 10));
+    QVERIFY(store.store(alive));
+
+    // 3 + 3 + 3 + 1
+    QCOMPARE(TSessionManager::instance().collectGarbageInBatches(TSessionManager::gcBatchSize()), 10);
+    for (int i = 0; i < 10; ++i) {
+        QVERIFY(sessionFilePath(sessionId(3, i)).isEmpty());
+    }
+    QVERIFY(!store.find(alive.id()).isEmpty());
+    QCOMPARE(TSessionManager::instance().collectGarbageInBatches(TSessionManager::gcBatchSize()), 0);
+}
+
+
+void TestSessionFileStore::noGcInRequests()
+{
+    TSessionFileStore store;
+    TSession session = createSession(sessionId(4, 0));
+    QVERIFY(store.store(session));
+    QVERIFY(setModified(sessionFilePath(session.id()), QDateTime::currentDateTime().addSecs(-3600)));
+
+    // Left to the background GC
+    TSessionManager::instance().collectGarbage();
+    QVERIFY(!sessionFilePath(session.id()).isEmpty());
+    QVERIFY(store.remove(session.id()));
+}
+
+
+void TestSessionFileStore::concurrentStore()
+{
+    std::atomic<int> failed {0};
+
+    runThreads([&](int) {
+        TSessionFileStore store;
+        for (int i = 0; i < 50; ++i) {
+            // All threads write the same sessions
+            TSession session = createSession(sessionId(2, i % 5));
+            if (!store.store(session) || store.find(session.id()).value("count").toInt() != 123) {
+                failed++;
+            }
+        }
+    });
+    QCOMPARE(failed.load(), 0);
+}
+
+
+void TestSessionFileStore::bench_store_multithread()
+{
+    QBENCHMARK {
+        runThreads([](int t) {
+            TSessionFileStore store;
+            for (int i = 0; i < NUM_SESSIONS; ++i) {
+                TSession session = createSession(sessionId(t, i));
+                store.store(session);
+            }
+        });
+    }
+}
+
+
+void TestSessionFileStore::bench_find_multithread()
+{
+    QBENCHMARK {
+        runThreads([](int t) {
+            TSessionFileStore store;
+            for (int i = 0; i < NUM_SESSIONS; ++i) {
+                store.find(sessionId(t, i));
+            }
+        });
+    }
+}
+
+TF_TEST_SQLLESS_MAIN(TestSessionFileStore)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = sessionfilestore
+SOURCES = main.cpp
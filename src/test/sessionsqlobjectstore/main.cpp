@@ -0,0 +1,195 @@
+#include <TfTest/TfTest>
+#include <QtCore>
+#include <TCriteria>
+#include <TSqlORMapper>
+#include "tsessionmanager.h"
+#include "tsessionobject.h"
+#include "tsessionsqlobjectstore.h"
+
+
+class TestSessionSqlObjectStore : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void storeAndFind();
+    void unmodifiedSession();
+    void modifiedSession();
+    void touch();
+    void touchRequired();
+    void gcBatch();
+    void collectGarbageInBatches();
+};
+
+
+static TSession createSession(const QByteArray &id)
+{
+    TSession session(id);
+    session.insert("user", QString::fromLatin1(id));
+    session.insert("count", 123);
+    return session;
+}
+
+static QDateTime updatedAt(const QByteArray &id)
+{
+    TSqlORMapper<TSessionObject> mapper;
+    return mapper.findFirst(TCriteria(TSessionObject::Id, TSql::Equal, id)).updated_at;
+}
+
+static int sessionCount()
+{
+    return TSqlORMapper<TSessionObject>().findCount();
+}
+
+static bool setUpdatedAt(const QByteArray &id, const QDateTime &updated)
+{
+    TSqlORMapper<TSessionObject> mapper;
+    return mapper.updateAll(TCriteria(TSessionObject::Id, TSql::Equal, id), TSessionObject::UpdatedAt, updated) == 1;
+}
+
+
+void TestSessionSqlObjectStore::initTestCase()
+{
+    // Creates the table and removes the sessions of the last run
+    TSessionSqlObjectStore store;
+    TSession session = createSession("initial");
+    QVERIFY(store.store(session));
+    TSqlORMapper<TSessionObject>().removeAll();
+}
+
+
+void TestSessionSqlObjectStore::storeAndFind()
+{
+    TSessionSqlObjectStore store;
+    TSession session = createSession("storeandfind");
+    QVERIFY(store.store(session));
+
+    TSession found = store.find(session.id());
+    QCOMPARE(found.id(), session.id());
+    QCOMPARE(*static_cast<QVariantMap *>(&found), *static_cast<QVariantMap *>(&session));
+    QVERIFY(found.storedDateTime().isValid());
+
+    // Expired
+    QVERIFY(setUpdatedAt(session.id(), QDateTime::currentDateTime().addSecs(-3600)));
+    QVERIFY(store.find(session.id()).isEmpty());
+}
+
+
+void TestSessionSqlObjectStore::unmodifiedSession()
+{
+    auto &manager = TSessionManager::instance();
+    TSession session = createSession(manager.generateId());
+    QVERIFY(session.isModified());
+    QVERIFY(manager.store(session));
+    QVERIFY(!session.isModified());
+
+    QDateTime updated = QDateTime::currentDateTime().addSecs(-5);
+    QVERIFY(setUpdatedAt(session.id(), updated));
+
+    // Found just after stored; neither re-stored nor touched
+    TSession found = manager.findSession(session.id());
+    QCOMPARE(found.id(), session.id());
+    QVERIFY(!found.isModified());
+    QVERIFY(!manager.isTouchRequired(found));
+
+    // Setting the same value is not a modification
+    found.insert("count", 123);
+    QVERIFY(!found.isModified());
+    QCOMPARE(updatedAt(session.id()).toSecsSinceEpoch(), updated.toSecsSinceEpoch());
+}
+
+
+void TestSessionSqlObjectStore::modifiedSession()
+{
+    auto &manager = TSessionManager::instance();
+    TSession session = createSession(manager.generateId());
+    QVERIFY(manager.store(session));
+
+    TSession found = manager.findSession(session.id());
+    found.insert("count", 456);
+    QVERIFY(found.isModified());
+    QVERIFY(manager.store(found));
+    QVERIFY(!found.isModified());
+    QCOMPARE(manager.findSession(session.id()).value("count").toInt(), 456);
+}
+
+
+void TestSessionSqlObjectStore::touch()
+{
+    TSessionSqlObjectStore store;
+    TSession session = createSession("touch");
+    QVERIFY(store.store(session));
+
+    QVERIFY(setUpdatedAt(session.id(), QDateTime::currentDateTime().addSecs(-60)));
+    QVERIFY(store.touch(session));
+    QVERIFY(updatedAt(session.id()) > QDateTime::currentDateTime().addSecs(-10));
+
+    // Stores the session not found
+    TSession missing = createSession("touchmissing");
+    QVERIFY(store.touch(missing));
+    QCOMPARE(store.find(missing.id()).value("user").toString(), QString("touchmissing"));
+}
+
+
+void TestSessionSqlObjectStore::touchRequired()
+{
+    auto &manager = TSessionManager::instance();
+    TSession session = createSession(manager.generateId());
+    QVERIFY(manager.store(session));
+
+    // Stored more than a tenth of Session.GcMaxLifeTime ago
+    QVERIFY(setUpdatedAt(session.id(), QDateTime::currentDateTime().addSecs(-600)));
+
+    TSession found = manager.findSession(session.id());
+    QVERIFY(!found.isModified());
+    QVERIFY(manager.isTouchRequired(found));
+
+    // Extends the expiry without changing the data
+    QVERIFY(manager.touch(found));
+    QVERIFY(!manager.isTouchRequired(found));
+    TSession touched = manager.findSession(session.id());
+    QCOMPARE(*static_cast<QVariantMap *>(&touched), *static_cast<QVariantMap *>(&session));
+    QVERIFY(!manager.isTouchRequired(touched));
+}
+
+
+void TestSessionSqlObjectStore::gcBatch()
+{
+    TSqlORMapper<TSessionObject>().removeAll();
+    TSessionSqlObjectStore store;
+    for (int i = 0; i < 10; ++i) {
+        TSession session = createSession("gcbatch" + QByteArray::number(i));
+        QVERIFY(store.store(session));
+    }
+
+    QDateTime expire = QDateTime::currentDateTime().addSecs(10);
+    QCOMPARE(store.gcBatch(expire, 3), 3);
+    QCOMPARE(sessionCount(), 7);
+    QCOMPARE(store.gcBatch(expire, 5), 5);
+    QCOMPARE(store.gcBatch(expire, 5), 2);
+    QCOMPARE(store.gcBatch(expire, 5), 0);
+}
+
+
+void TestSessionSqlObjectStore::collectGarbageInBatches()
+{
+    TSqlORMapper<TSessionObject>().removeAll();
+    TSessionSqlObjectStore store;
+
+    // Expired by Session.GcMaxLifeTime
+    for (int i = 0; i < 10; ++i) {
+        TSession session = createSession("expired" + QByteArray::number(i));
+        QVERIFY(store.store(session));
+        QVERIFY(setUpdatedAt(session.id(), QDateTime::currentDateTime().addSecs(-3600)));
+    }
+    TSession alive = createSession("alive");
+    QVERIFY(store.store(alive));
+
+    QCOMPARE(TSessionManager::gcBatchSize(), 3);
+    QCOMPARE(TSessionManager::instance().collectGarbageInBatches(TSessionManager::gcBatchSize()), 10);
+    QCOMPARE(sessionCount(), 1);
+    QVERIFY(!store.find(alive.id()).isEmpty());
+}
+
+TF_TEST_MAIN(TestSessionSqlObjectStore)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = sessionsqlobjectstore
+SOURCES = main.cpp
@@ -2,10 +2,14 @@
 #include "tsharedmemorykvs.h"
 #include "tglobal.h"
 #include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
 
 
 static QMap<QByteArray, QByteArray> qmap;
 const QByteArray ckey = QUuid::createUuid().toByteArray();
+const int NUM_PROCESSES = 8;
+const int NUM_KEYS = 1000;
 
 class TestSharedMemoryHash : public QObject
 {
@@ -25,6 +29,8 @@ private slots:
     void bench2();
     void testCompareWithQMap();
     void testCompareIterator();
+    void testMultiProcess();
+    void bench_multiprocess();
 };
 
 
@@ -378,5 +384,75 @@ void TestSharedMemoryHash::bench2()
     QCOMPARE(smhash.count(), 0U);
 }
 
+// Runs the function in the forked processes, which share the segment
+// with this process; returns the number of the processes failed
+template <class Function>
+static int runProcesses(Function func)
+{
+    QList<pid_t> pids;
+    for (int p = 0; p < NUM_PROCESSES; ++p) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            _exit(func(p) ? 0 : 1);
+        }
+        pids << pid;
+    }
+
+    int failed = 0;
+    for (auto pid : pids) {
+        int status = 0;
+        if (pid < 0 || waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+// Gets and sets the keys in the ratio 9:1. The values are made of the
+// keys repeated, so that a torn read is detected.
+static bool mixedAccess(int proc, int count)
+{
+    TSharedMemoryKvs smhash;
+
+    for (int i = 0; i < count; ++i) {
+        QByteArray key = "mp" + QByteArray::number((Tf::random(NUM_KEYS - 1) + proc * 97) % NUM_KEYS);
+        QByteArray unit = key + '/';
+
+        if ((i + proc) % 10 == 0) {
+            if (!smhash.set(key, unit.repeated(Tf::random(1, 20)), 60)) {
+                return false;
+            }
+        } else {
+            QByteArray value = smhash.get(key);
+            if (!value.isEmpty() && value != unit.repeated(value.length() / unit.length())) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+void TestSharedMemoryHash::testMultiProcess()
+{
+    QCOMPARE(runProcesses([](int proc) { return mixedAccess(proc, 20000); }), 0);
+
+    TSharedMemoryKvs smhash;
+    smhash.clear();
+    QCOMPARE(smhash.count(), 0U);
+}
+
+
+void TestSharedMemoryHash::bench_multiprocess()
+{
+    QBENCHMARK {
+        runProcesses([](int proc) { return mixedAccess(proc, 10000); });
+    }
+
+    TSharedMemoryKvs smhash;
+    smhash.clear();
+    QCOMPARE(smhash.count(), 0U);
+}
+
 TF_TEST_MAIN(TestSharedMemoryHash)
 #include "sharedmemoryhash.moc"
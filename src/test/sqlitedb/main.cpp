@@ -4,6 +4,11 @@
 #include "tcachestore.h"
 #include "tcachefactory.h"
 #include "tcachesqlitestore.h"
+#include <TCache>
+#include "tdatabasecontext.h"
+#include <atomic>
+#include <thread>
+#include <vector>
 
 static int64_t FirstKey;
 const int NUM = 500;
@@ -18,6 +23,15 @@ private slots:
     void test();
     void insert_data();
     void insert();
+    void multi();
+    void add();
+    void getOrCompute();
+    void getOrComputeConcurrent();
+    void tags();
+    void tagsMulti();
+    void gc();
+    void bench_setMulti();
+    void bench_getMulti();
     void bench_insert_binary();
     void bench_value_binary();
     void bench_insert_binary_lz4();
@@ -121,6 +135,215 @@ void TestCache::insert()
 }
 
 
+void TestCache::multi()
+{
+    TCacheStore *cache = TCacheFactory::create("sqlite");
+    cache->open();
+    cache->clear();
+
+    QMap<QByteArray, QByteArray> items;
+    QByteArrayList keys;
+    for (int i = 0; i < 600; i++) {  // more than the rows of a query
+        QByteArray key = "multi" + QByteArray::number(i);
+        items.insert(key, genval(key));
+        keys << key;
+    }
+
+    QCOMPARE(cache->setMulti(items, 5), items.count());
+    QCOMPARE(cache->getMulti(keys + QByteArrayList {"notfound"}), items);
+    QCOMPARE(cache->removeMulti(keys.mid(0, 300)), 300);
+    QCOMPARE(cache->getMulti(keys).count(), 300);
+    QVERIFY(cache->get("multi0").isEmpty());
+    QCOMPARE(cache->get("multi599"), items["multi599"]);
+
+    cache->clear();
+    TCacheFactory::destroy("sqlite", cache);
+}
+
+
+void TestCache::add()
+{
+    TCacheStore *cache = TCacheFactory::create("sqlite");
+    cache->open();
+    cache->remove("addkey");
+
+    QVERIFY(cache->add("addkey", "value1", 1));
+    QVERIFY(!cache->add("addkey", "value2", 1));
+    QCOMPARE(cache->get("addkey"), QByteArray("value1"));
+    Tf::msleep(1100);
+    QVERIFY(cache->add("addkey", "value3", 1));  // expired
+    QCOMPARE(cache->get("addkey"), QByteArray("value3"));
+    TCacheFactory::destroy("sqlite", cache);
+}
+
+
+void TestCache::getOrCompute()
+{
+    TCache cache;
+    cache.remove("goc");
+    int count = 0;
+    auto compute = [&]() {
+        count++;
+        return "value" + QByteArray::number(count);
+    };
+
+    QCOMPARE(cache.getOrCompute("goc", 1, compute, 10), QByteArray("value1"));
+    QCOMPARE(cache.getOrCompute("goc", 1, compute, 10), QByteArray("value1"));
+    QCOMPARE(count, 1);
+
+    // Stale, refreshed by the caller holding the lease
+    Tf::msleep(1100);
+    QCOMPARE(cache.getOrCompute("goc", 1, compute, 10), QByteArray("value2"));
+    QCOMPARE(count, 2);
+
+    // Empty value is not stored
+    QCOMPARE(cache.getOrCompute("goc2", 10, []() { return QByteArray(); }), QByteArray());
+    QVERIFY(cache.get("goc2").isEmpty());
+}
+
+void TestCache::getOrComputeConcurrent()
+{
+    constexpr int NUM_THREADS = 8;
+    TCache().remove("gocc");
+    std::atomic<int> count {0};
+    auto compute = [&]() {
+        count++;
+        Tf::msleep(200);
+        return QByteArray("computed");
+    };
+
+    QByteArrayList values(NUM_THREADS);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_THREADS; ++i) {
+        threads.emplace_back([&, i]() {
+            TDatabaseContext context;
+            TDatabaseContext::setCurrentDatabaseContext(&context);
+            values[i] = TCache().getOrCompute("gocc", 60, compute);
+            TDatabaseContext::setCurrentDatabaseContext(nullptr);
+        });
+    }
+    for (auto &th : threads) {
+        th.join();
+    }
+
+    // Computed once; the followers get the value of the leader
+    QCOMPARE(count.load(), 1);
+    for (auto &value : values) {
+        QCOMPARE(value, QByteArray("computed"));
+    }
+}
+
+void TestCache::tags()
+{
+    TCache cache;
+    QVERIFY(cache.set("tagged1", "foo", 60, {"post.1", "posts"}));
+    QVERIFY(cache.set("tagged2", "bar", 60, {"post.2", "posts"}));
+    QCOMPARE(cache.get("tagged1"), QByteArray("foo"));
+    QCOMPARE(cache.getMulti({"tagged1", "tagged2"}).count(), 2);
+
+    cache.invalidateTag("post.1");
+    QVERIFY(cache.get("tagged1").isNull());
+    QCOMPARE(cache.get("tagged2"), QByteArray("bar"));
+
+    cache.invalidateTag("posts");
+    QVERIFY(cache.get("tagged2").isNull());
+    QVERIFY(cache.getMulti({"tagged1", "tagged2"}).isEmpty());
+
+    // Stored again with the new generations
+    QVERIFY(cache.set("tagged1", "baz", 60, {"post.1", "posts"}));
+    QCOMPARE(cache.get("tagged1"), QByteArray("baz"));
+}
+
+void TestCache::tagsMulti()
+{
+    TCache cache;
+    QByteArrayList keys;
+    for (int i = 0; i < 20; i++) {
+        QByteArray key = "multitagged" + QByteArray::number(i);
+        QByteArray tag = (i % 2) ? "odd" : "even";
+        QVERIFY(cache.set(key, "value", 60, {tag, "numbers"}));
+        keys << key;
+    }
+    QVERIFY(cache.set("multiuntagged", "value", 60));
+    keys << "multiuntagged";
+    QCOMPARE(cache.getMulti(keys).count(), 21);
+
+    cache.invalidateTag("odd");
+    auto values = cache.getMulti(keys);
+    QCOMPARE(values.count(), 11);
+    QVERIFY(values.contains("multitagged0"));
+    QVERIFY(!values.contains("multitagged1"));
+    QVERIFY(values.contains("multiuntagged"));
+
+    // A generation once made is kept
+    cache.remove("tf.tag.newtag");
+    const auto generations = cache.tagGenerations({"newtag", "numbers"});
+    QCOMPARE(generations.count(), 2);
+    QVERIFY(!generations[0].isEmpty());
+    QCOMPARE(cache.tagGenerations({"newtag", "numbers"}), generations);
+}
+
+void TestCache::gc()
+{
+    TCacheSQLiteStore *cache = dynamic_cast<TCacheSQLiteStore *>(TCacheFactory::create("sqlite"));
+    QVERIFY(cache);
+    cache->open();
+    cache->clear();
+
+    QMap<QByteArray, QByteArray> items;
+    for (int i = 0; i < 2500; i++) {  // more than a batch of GC
+        items.insert("gc" + QByteArray::number(i), "value");
+    }
+    QCOMPARE(cache->setMulti(items, 1), items.count());
+    QVERIFY(cache->set("gckeep", "value", 60));
+
+    Tf::msleep(2100);
+    cache->gc();
+    QCOMPARE(cache->count(), 1);
+    QCOMPARE(cache->get("gckeep"), QByteArray("value"));
+
+    cache->clear();
+    TCacheFactory::destroy("sqlite", cache);
+}
+
+static QMap<QByteArray, QByteArray> multiItems()
+{
+    QMap<QByteArray, QByteArray> items;
+    for (int i = 0; i < 30; i++) {
+        QByteArray key = "bench" + QByteArray::number(i);
+        items.insert(key, genval(key));
+    }
+    return items;
+}
+
+
+void TestCache::bench_setMulti()
+{
+    TCacheStore *cache = TCacheFactory::create("sqlite");
+    cache->open();
+    const auto items = multiItems();
+
+    QBENCHMARK {
+        cache->setMulti(items, 60);
+    }
+    TCacheFactory::destroy("sqlite", cache);
+}
+
+
+void TestCache::bench_getMulti()
+{
+    TCacheStore *cache = TCacheFactory::create("sqlite");
+    cache->open();
+    const auto items = multiItems();
+    const auto keys = items.keys();
+    cache->setMulti(items, 60);
+
+    QBENCHMARK {
+        cache->getMulti(keys);
+    }
+    TCacheFactory::destroy("sqlite", cache);
+}
+
 void TestCache::bench_insert_binary()
 {
     TCacheStore *cache = TCacheFactory::create("sqlite");
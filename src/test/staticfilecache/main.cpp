@@ -0,0 +1,250 @@
+#include <TfTest/TfTest>
+#include <QtCore>
+#include <THttpRequest>
+#include <THttpResponseHeader>
+#include "tstaticfilecache.h"
+#include "tactioncontext.h"
+
+
+// Executes requests and keeps the response written
+class TestContext : public TActionContext
+{
+public:
+    QByteArray body;
+    QByteArray rawData;
+
+    void get(const QByteArray &path)
+    {
+        QByteArray raw = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+        body.clear();
+        rawData.clear();
+        THttpRequest request(THttpRequestHeader(raw), QByteArray(), QHostAddress(), this);
+        execute(request);
+        release();
+    }
+
+protected:
+    int64_t writeResponse(THttpResponseHeader &header, QIODevice *body) override
+    {
+        if (body && (body->isOpen() || body->open(QIODevice::ReadOnly))) {
+            this->body = body->readAll();
+        }
+        return header.toByteArray().length() + this->body.length();
+    }
+
+    int64_t writeRawData(const QByteArray &data) override
+    {
+        rawData += data;
+        return data.length();
+    }
+};
+
+
+class TestStaticFileCache : public QObject
+{
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void maxFileSize();
+    void maxTotalSize();
+    void rejectedFile();
+    void lruEviction();
+    void modifiedBeforeInsert();
+    void invalidation();
+
+private:
+    static bool writeFile(const QString &path, int size, char c);
+    static std::shared_ptr<TStaticFileCache::Entry> createEntry(const QString &filePath);
+    QString filePath(const QString &name) const { return _tmpDir.path() + "/" + name; }
+    QTemporaryDir _tmpDir;
+    bool _createdPublic {false};
+};
+
+
+bool TestStaticFileCache::writeFile(const QString &path, int size, char c)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(QByteArray(size, c));
+    file.close();
+    return true;
+}
+
+
+std::shared_ptr<TStaticFileCache::Entry> TestStaticFileCache::createEntry(const QString &filePath)
+{
+    QFileInfo fi(filePath);
+    QFile file(filePath);
+    auto entry = std::make_shared<TStaticFileCache::Entry>();
+    entry->filePath = fi.absoluteFilePath();
+    entry->fileSize = fi.size();
+    entry->lastModifiedMSecs = fi.lastModified().toMSecsSinceEpoch();
+    entry->identity.body = file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    return entry;
+}
+
+
+void TestStaticFileCache::initTestCase()
+{
+    if (!TStaticFileCache::isEnabled()) {
+        QSKIP("StaticFileCache is not available");
+    }
+
+    // Written before the directories are watched, not to be invalidated
+    // by the late events
+    QVERIFY(_tmpDir.isValid());
+    for (auto name : {"a.txt", "b.txt", "c.txt"}) {
+        QVERIFY(writeFile(filePath(name), 1500, name[0]));
+    }
+    QVERIFY(writeFile(filePath("large.txt"), 5000, 'l'));
+    QVERIFY(writeFile(filePath("small.txt"), 1000, 's'));
+    QVERIFY(writeFile(filePath("stale.txt"), 1000, 's'));
+    QVERIFY(writeFile(filePath("modified.txt"), 1000, 'm'));
+
+    QDir appPublic(Tf::app()->publicPath());
+    if (!appPublic.exists()) {
+        QVERIFY(appPublic.mkpath("."));
+        _createdPublic = true;
+    }
+    QVERIFY(writeFile(Tf::app()->publicPath() + "tfsmall.txt", 512, 's'));
+    QVERIFY(writeFile(Tf::app()->publicPath() + "tflarge.txt", 2048, 'l'));
+}
+
+
+void TestStaticFileCache::cleanupTestCase()
+{
+    if (_createdPublic) {
+        QDir(Tf::app()->publicPath()).removeRecursively();
+    } else {
+        QFile::remove(Tf::app()->publicPath() + "tfsmall.txt");
+        QFile::remove(Tf::app()->publicPath() + "tflarge.txt");
+    }
+}
+
+
+void TestStaticFileCache::init()
+{
+    TStaticFileCache::instance().clear();
+}
+
+
+void TestStaticFileCache::maxFileSize()
+{
+    auto &cache = TStaticFileCache::instance();
+    QCOMPARE(TStaticFileCache::maxFileSize(), (int64_t)1024);
+    TestContext context;
+
+    // Cached when sent from the file, and sent from memory next time
+    context.get("/tfsmall.txt");
+    QCOMPARE(context.body, QByteArray(512, 's'));
+    QVERIFY(cache.find("/tfsmall.txt"));
+    QCOMPARE(cache.count(), 1);
+
+    context.get("/tfsmall.txt?v=1");
+    QVERIFY(context.body.isEmpty());
+    QVERIFY(context.rawData.startsWith("HTTP/1.1 200 OK\r\n"));
+    QVERIFY(context.rawData.endsWith("\r\n\r\n" + QByteArray(512, 's')));
+
+    // Larger than StaticFileCache.MaxFileSize
+    context.get("/tflarge.txt");
+    QCOMPARE(context.body, QByteArray(2048, 'l'));
+    QVERIFY(!cache.find("/tflarge.txt"));
+    QCOMPARE(cache.count(), 1);
+
+    context.get("/tflarge.txt");
+    QCOMPARE(context.body, QByteArray(2048, 'l'));
+    QVERIFY(context.rawData.isEmpty());
+}
+
+
+void TestStaticFileCache::maxTotalSize()
+{
+    auto &cache = TStaticFileCache::instance();
+    QVERIFY(cache.insert("/small.txt", createEntry(filePath("small.txt"))));
+
+    // Larger than StaticFileCache.MaxTotalSize, not evicting the others
+    QVERIFY(!cache.insert("/large.txt", createEntry(filePath("large.txt"))));
+    QVERIFY(!cache.find("/large.txt"));
+    QVERIFY(cache.find("/small.txt"));
+    QCOMPARE(cache.count(), 1);
+    QCOMPARE(cache.totalSize(), (int64_t)1000);
+}
+
+
+void TestStaticFileCache::rejectedFile()
+{
+    auto &cache = TStaticFileCache::instance();
+    auto entry = createEntry(filePath("large.txt"));
+    QVERIFY(!cache.isRejected("/large.txt", entry->fileSize, entry->lastModifiedMSecs));
+    QVERIFY(!cache.insert("/large.txt", entry));
+
+    // Remembered until the file is modified
+    QVERIFY(cache.isRejected("/large.txt", entry->fileSize, entry->lastModifiedMSecs));
+    QVERIFY(!cache.isRejected("/large.txt", entry->fileSize - 1, entry->lastModifiedMSecs));
+    QVERIFY(!cache.isRejected("/large.txt", entry->fileSize, entry->lastModifiedMSecs + 1000));
+    QVERIFY(!cache.isRejected("/other.txt", entry->fileSize, entry->lastModifiedMSecs));
+
+    // Forgotten when cached under the same path
+    QVERIFY(cache.insert("/large.txt", createEntry(filePath("small.txt"))));
+    QVERIFY(!cache.isRejected("/large.txt", entry->fileSize, entry->lastModifiedMSecs));
+}
+
+
+void TestStaticFileCache::lruEviction()
+{
+    auto &cache = TStaticFileCache::instance();
+    QVERIFY(cache.insert("/a.txt", createEntry(filePath("a.txt"))));
+    QVERIFY(cache.insert("/b.txt", createEntry(filePath("b.txt"))));
+    QVERIFY(cache.find("/a.txt"));  // b.txt is the least recently used
+
+    QVERIFY(cache.insert("/c.txt", createEntry(filePath("c.txt"))));
+    QVERIFY(!cache.find("/b.txt"));
+    QCOMPARE(cache.count(), 2);
+    QCOMPARE(cache.totalSize(), (int64_t)3000);
+
+    QVERIFY(cache.find("/a.txt"));
+    QVERIFY(cache.find("/c.txt"));  // a.txt is the least recently used
+    QVERIFY(cache.insert("/b.txt", createEntry(filePath("b.txt"))));
+    QVERIFY(!cache.find("/a.txt"));
+    QVERIFY(cache.find("/b.txt"));
+    QVERIFY(cache.find("/c.txt"));
+    QCOMPARE(cache.totalSize(), (int64_t)3000);
+}
+
+
+void TestStaticFileCache::modifiedBeforeInsert()
+{
+    auto &cache = TStaticFileCache::instance();
+    auto entry = createEntry(filePath("stale.txt"));
+    QVERIFY(writeFile(filePath("stale.txt"), 999, 's'));
+
+    // Neither cached nor remembered as failed
+    QVERIFY(!cache.insert("/stale.txt", entry));
+    QVERIFY(!cache.find("/stale.txt"));
+    QVERIFY(!cache.isRejected("/stale.txt", entry->fileSize, entry->lastModifiedMSecs));
+}
+
+
+void TestStaticFileCache::invalidation()
+{
+    auto &cache = TStaticFileCache::instance();
+    QVERIFY(cache.insert("/a.txt", createEntry(filePath("a.txt"))));
+    QVERIFY(cache.insert("/a2.txt", createEntry(filePath("a.txt"))));
+    cache.invalidate(QFileInfo(filePath("a.txt")).absoluteFilePath());
+    QVERIFY(!cache.find("/a.txt"));
+    QVERIFY(!cache.find("/a2.txt"));
+    QCOMPARE(cache.totalSize(), (int64_t)0);
+
+    // Through the watcher thread
+    QVERIFY(cache.insert("/modified.txt", createEntry(filePath("modified.txt"))));
+    QVERIFY(writeFile(filePath("modified.txt"), 1001, 'm'));
+    QTRY_VERIFY_WITH_TIMEOUT(!cache.find("/modified.txt"), 5000);
+    QCOMPARE(cache.count(), 0);
+}
+
+TF_TEST_MAIN(TestStaticFileCache)
+#include "main.moc"
@@ -0,0 +1,3 @@
+include(../test.pri)
+TARGET = staticfilecache
+SOURCES = main.cpp
@@ -2,9 +2,10 @@ TEMPLATE = subdirs
 CONFIG  += testcase
 SUBDIRS  = htmlescape httpheader htmlparser
 SUBDIRS += mailmessage multipartformdata  smtpmailer viewhelper paginator
-SUBDIRS += fieldnametovariablename rand urlrouter urlrouter2
+SUBDIRS += fieldnametovariablename jsonwriter rand urlrouter urlrouter2
 SUBDIRS += buildtest stack queue forlist
-SUBDIRS += jscontext compression sqlitedb url malloc
+SUBDIRS += jscontext compression sqlitedb sessionfilestore sessioncookiestore sessionsqlobjectstore localcache cachecompressor url malloc
+SUBDIRS += responsecache assetmanifest actioncontext staticfilecache
 SUBDIRS += sharedmemory sharedmemoryhash sharedmemorymutex
 unix {
   SUBDIRS += redis memcached
@@ -1,5 +1,6 @@
 #include "../../tactioncontroller.h"
 #include <TfTest/TfTest>
+#include <THttpUtility>
 
 
 class BookController : public TActionController
@@ -19,6 +20,10 @@ private slots:
 
     void url_correctly_data();
     void url_correctly();
+    void fromUrlEncoding_data();
+    void fromUrlEncoding();
+    void benchmark_fromUrlEncoding_plain();
+    void benchmark_fromUrlEncoding_encoded();
 };
 
 void TestUrl::init()
@@ -57,5 +62,51 @@ void TestUrl::url_correctly()
     QCOMPARE(res, url);
 }
 
+
+void TestUrl::fromUrlEncoding_data()
+{
+    QTest::addColumn<QByteArray>("encoded");
+    QTest::addColumn<QString>("decoded");
+
+    QTest::newRow("1") << QByteArray("hello") << "hello";
+    QTest::newRow("2") << QByteArray("hello+world") << "hello world";
+    QTest::newRow("3") << QByteArray("a%26b%3Dc%2bd") << "a&b=c+d";
+    QTest::newRow("4") << QByteArray("%E3%81%93%E3%82%93%E3%81%AB%E3%81%A1%E3%81%AF") << QString::fromUtf8(u8"こんにちは");
+    QTest::newRow("5") << QByteArray("100%") << "100%";
+    QTest::newRow("6") << QByteArray("%zz%4") << "%zz%4";
+    QTest::newRow("7") << QByteArray("0123456789abcdef0123456789abcdef%20+") << "0123456789abcdef0123456789abcdef  ";
+    QTest::newRow("8") << QByteArray() << QString();
+}
+
+
+void TestUrl::fromUrlEncoding()
+{
+    QFETCH(QByteArray, encoded);
+    QFETCH(QString, decoded);
+
+    QCOMPARE(THttpUtility::fromUrlEncoding(encoded), decoded);
+    QCOMPARE(THttpUtility::fromUrlEncodingUtf8(encoded), decoded.toUtf8());
+}
+
+
+void TestUrl::benchmark_fromUrlEncoding_plain()
+{
+    const QByteArray encoded = QByteArray("the_quick_brown_fox_jumps_over_the_lazy_dog.").repeated(20);
+    QBENCHMARK {
+        QString decoded = THttpUtility::fromUrlEncoding(encoded);
+        QCOMPARE(decoded.length(), encoded.length());
+    }
+}
+
+
+void TestUrl::benchmark_fromUrlEncoding_encoded()
+{
+    const QByteArray encoded = THttpUtility::toUrlEncoding(QString::fromUtf8(u8"the quick brown fox & こんにちは = ").repeated(20));
+    QBENCHMARK {
+        QString decoded = THttpUtility::fromUrlEncoding(encoded);
+        QVERIFY(decoded.length() < encoded.length());
+    }
+}
+
 TF_TEST_MAIN(TestUrl)
 #include "main.moc"
@@ -36,6 +36,12 @@ private slots:
 
     void should_not_create_route_if_destination_empty_and_route_does_not_accept_controller_and_action();
     void should_not_create_route_if_bad_param();
+    void should_route_to_first_declared_route();
+    void should_find_url_of_first_declared_route();
+    void should_route_with_cache_policy();
+    void should_not_create_route_if_bad_option();
+    void benchmark_find_routing_last_route();
+    void benchmark_find_routing_no_route();
     // void should_not_create_route_if_it_does_not_accept_action_parameter_and_no_default_is_given();
     // void should_not_create_route_if_it_accepts_controller_but_not_action_and_no_default_given();
     // void should_create_route_if_it_accepts_controller_but_not_action_but_default_given();
@@ -50,6 +56,9 @@ private slots:
     // void should_not_route_if_controller_given_but_action_is_not();
     // void should_route_correctly_when_controller_parameter_given_and_does_not_accept_action_parameter();
     // void should_parse_params_correctly_even_if_preceding_parameter_is_empty();
+
+private:
+    void addManyRoutes();
 };
 
 void TestUrlRouter::init()
@@ -310,6 +319,82 @@ void TestUrlRouter::should_not_create_route_if_bad_param()
     QCOMPARE(result, false);
 }
 
+void TestUrlRouter::should_route_to_first_declared_route()
+{
+    addRouteFromString("GET  /foo/:param 'dummy.index'");
+    addRouteFromString("GET  /foo/bar    'dummy.bar'");
+    addRouteFromString("GET  /:params    'dummy.all'");
+
+    TRouting r = findRouting(Tf::Get, TUrlRoute::splitPath("/foo/bar"));
+    QCOMPARE(QString(r.action), QString("index"));
+    QCOMPARE(r.params, QStringList() << "bar");
+
+    r = findRouting(Tf::Get, TUrlRoute::splitPath("/foo/bar/baz"));
+    QCOMPARE(QString(r.action), QString("all"));
+    QCOMPARE(r.params, QStringList() << "foo" << "bar" << "baz");
+}
+
+void TestUrlRouter::should_find_url_of_first_declared_route()
+{
+    addRouteFromString("GET  /foo/:param       'dummy.index'");
+    addRouteFromString("GET  /bar/:param/:param 'dummy.index'");
+    addRouteFromString("GET  /baz/:params      'dummy.index'");
+
+    QCOMPARE(findUrl("dummy", "index", QStringList() << "1"), QString("/foo/1"));
+    QCOMPARE(findUrl("Dummy", "index", QStringList() << "1" << "2"), QString("/bar/1/2"));
+    QCOMPARE(findUrl("dummy", "index", QStringList() << "1" << "2" << "3"), QString("/baz/1/2/3"));
+    QCOMPARE(findUrl("dummy", "show", QStringList() << "1"), QString());
+}
+
+void TestUrlRouter::should_route_with_cache_policy()
+{
+    addRouteFromString("GET  /foo/:param 'dummy.index' cache=10 query=page,sort header=Accept-Language");
+    addRouteFromString("GET  /bar        'dummy.bar'");
+
+    TRouting r = findRouting(Tf::Get, TUrlRoute::splitPath("/foo/1"));
+    QCOMPARE(r.cache.seconds, 10);
+    QCOMPARE(r.cache.queryItems, QStringList() << "page" << "sort");
+    QCOMPARE(r.cache.headers, QByteArrayList() << "Accept-Language");
+
+    r = findRouting(Tf::Get, TUrlRoute::splitPath("/bar"));
+    QCOMPARE(r.cache.seconds, 0);
+}
+
+void TestUrlRouter::should_not_create_route_if_bad_option()
+{
+    QCOMPARE(addRouteFromString("GET /foo 'dummy.index' cache=ten"), false);
+    QCOMPARE(addRouteFromString("GET /foo 'dummy.index' expire=10"), false);
+}
+
+void TestUrlRouter::addManyRoutes()
+{
+    for (int i = 0; i < 500; ++i) {
+        addRouteFromString(QString("GET  /resource%1/:param/items/:param 'resource%1.show'").arg(i));
+    }
+}
+
+void TestUrlRouter::benchmark_find_routing_last_route()
+{
+    addManyRoutes();
+    const QStringList components = TUrlRoute::splitPath("/resource499/12/items/34");
+
+    QBENCHMARK {
+        TRouting r = findRouting(Tf::Get, components);
+        QVERIFY(r.exists);
+    }
+}
+
+void TestUrlRouter::benchmark_find_routing_no_route()
+{
+    addManyRoutes();
+    const QStringList components = TUrlRoute::splitPath("/unknown/12/items/34");
+
+    QBENCHMARK {
+        TRouting r = findRouting(Tf::Get, components);
+        QVERIFY(!r.exists);
+    }
+}
+
 // void TestUrlRouter::should_create_route_if_destination_is_empty_but_controller_and_action_parameters_given()
 // {
 //     QString route = "GET /:controller/:action";
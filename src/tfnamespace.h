@@ -206,6 +206,32 @@ enum AppAttribute {
     SqlQueryLogFilePath,
     SqlQueryLogLayout,
     SqlQueryLogDateTimeFormat,
+    //
+    HttpCompressionEnable,
+    HttpCompressionLevel,
+    HttpCompressionMinimumSize,
+    HttpCompressionMimeTypes,
+    HttpCompressionPrecompressedFiles,
+    //
+    StaticFileCacheEnable,
+    StaticFileCacheMaxFileSize,
+    StaticFileCacheMaxTotalSize,
+    //
+    AssetManifestEnable,
+    AssetManifestAutoReload,
+    //
+    ReactRenderCacheSeconds,
+    //
+    SessionGcInterval,
+    SessionGcBatchSize,
+    SessionFileSyncInterval,
+    SessionPreviousSecrets,
+    SessionCookieCompressionThreshold,
+    //
+    CacheLocalMaxTotalSize,
+    CacheLocalMaxAge,
+    CacheCompressionThreshold,
+    CacheCompressionDictionary,
 };
 
 // Reason codes why a web socket has been closed
@@ -0,0 +1,81 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tfragmentcache.h"
+#include <TCache>
+
+constexpr auto FRAGMENT_KEY_PREFIX = "tf.fragment.";
+
+/*!
+  \class TFragmentCache
+  \brief The TFragmentCache class caches the fragments of views rendered
+  by the cache blocks of ERB and Otama templates.
+
+  A fragment can be associated with tags, which share the generations
+  with the tags of TCache; removing a tag invalidates both the fragments
+  and the cache items stored with it.
+  \sa TActionController::removeFragmentsByTag(), TCache::invalidateTag()
+*/
+
+/*!
+  Returns the current version of the \a tags; made from the generations
+  of the tags.
+*/
+QByteArray TFragmentCache::tagVersion(const QByteArrayList &tags)
+{
+    QByteArray version;
+
+    for (auto &generation : Tf::cache()->tagGenerations(tags)) {
+        version += generation;
+        version += ',';
+    }
+    return version;
+}
+
+/*!
+  Returns the fragment cached with the \a key if it was stored with the
+  tag version \a tagVersion; otherwise returns a null byte array.
+*/
+QByteArray TFragmentCache::get(const QByteArray &key, const QByteArray &tagVersion)
+{
+    QByteArray value = Tf::cache()->get(FRAGMENT_KEY_PREFIX + key);
+    int idx = value.indexOf('\n');
+    if (idx < 0 || QByteArrayView(value.constData(), idx) != tagVersion) {
+        return QByteArray();
+    }
+    return value.mid(idx + 1);
+}
+
+/*!
+  Stores the \a fragment with the \a key for \a seconds seconds; the
+  \a tagVersion must be the one obtained before rendering the fragment.
+*/
+bool TFragmentCache::set(const QByteArray &key, const QByteArray &fragment, int seconds, const QByteArray &tagVersion)
+{
+    QByteArray value;
+    value.reserve(tagVersion.length() + fragment.length() + 1);
+    value += tagVersion;
+    value += '\n';
+    value += fragment;
+    return Tf::cache()->set(FRAGMENT_KEY_PREFIX + key, value, seconds);
+}
+
+/*!
+  Removes the fragment with the \a key from the cache.
+*/
+void TFragmentCache::remove(const QByteArray &key)
+{
+    Tf::cache()->remove(FRAGMENT_KEY_PREFIX + key);
+}
+
+/*!
+  Invalidates all the fragments associated with the \a tag.
+*/
+void TFragmentCache::removeTag(const QByteArray &tag)
+{
+    Tf::cache()->invalidateTag(tag);
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <QByteArray>
+#include <QByteArrayList>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TFragmentCache {
+public:
+    static QByteArray tagVersion(const QByteArrayList &tags);
+    static QByteArray get(const QByteArray &key, const QByteArray &tagVersion);
+    static bool set(const QByteArray &key, const QByteArray &fragment, int seconds, const QByteArray &tagVersion);
+    static void remove(const QByteArray &key);
+    static void removeTag(const QByteArray &tag);
+
+private:
+    TFragmentCache();
+    T_DISABLE_COPY(TFragmentCache)
+    T_DISABLE_MOVE(TFragmentCache)
+};
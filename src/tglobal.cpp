@@ -28,6 +28,7 @@
 #define NOMINMAX
 #include <windows.h>
 #endif
+#include <array>
 #include <climits>
 #include <cstdlib>
 #include <random>
@@ -324,6 +325,66 @@ QByteArray Tf::lz4Uncompress(const QByteArray &data) noexcept
     return Tf::lz4Uncompress(data.data(), data.length());
 }
 
+/*!
+  Compresses the \a data into the zlib format (RFC 1950), which is what
+  the "deflate" content-coding of HTTP means.
+*/
+QByteArray Tf::deflateCompress(const QByteArray &data, int compressionLevel) noexcept
+{
+    // qCompress() prepends the uncompressed length in 4 bytes
+    QByteArray comp = qCompress(data, compressionLevel);
+    if (comp.length() < 4 + 6) {
+        return QByteArray();
+    }
+    return comp.mid(4);
+}
+
+/*!
+  Compresses the \a data into the gzip format (RFC 1952).
+*/
+QByteArray Tf::gzipCompress(const QByteArray &data, int compressionLevel) noexcept
+{
+    static const auto crcTable = []() {
+        std::array<uint32_t, 256> table;
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return table;
+    }();
+
+    // Raw deflate data is in the zlib stream, between the 2-byte header
+    // and the 4-byte Adler-32 trailer
+    QByteArray zlib = deflateCompress(data, compressionLevel);
+    if (zlib.length() < 6) {
+        return QByteArray();
+    }
+
+    uint32_t crc = 0xFFFFFFFFU;
+    for (auto c : data) {
+        crc = crcTable[(crc ^ (uint8_t)c) & 0xFF] ^ (crc >> 8);
+    }
+    crc ^= 0xFFFFFFFFU;
+
+    auto appendLE32 = [](QByteArray &ba, uint32_t n) {
+        for (int i = 0; i < 4; i++) {
+            ba += (char)((n >> (i * 8)) & 0xFF);
+        }
+    };
+
+    static const char header[] = {'\x1f', '\x8b', '\x08', 0, 0, 0, 0, 0, 0, '\xff'};
+    QByteArray gzip;
+    gzip.reserve(sizeof(header) + zlib.length() + 2);
+    gzip.append(header, sizeof(header));
+    gzip.append(zlib.constData() + 2, zlib.length() - 6);
+    appendLE32(gzip, crc);
+    appendLE32(gzip, (uint32_t)data.length());  // ISIZE, modulo 2^32
+    return gzip;
+}
+
 
 int64_t Tf::getMSecsSinceEpoch()
 {
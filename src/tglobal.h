@@ -342,6 +342,10 @@ T_CORE_EXPORT QByteArray lz4Compress(const QByteArray &data, int compressionLeve
 T_CORE_EXPORT QByteArray lz4Uncompress(const char *data, int nbytes) noexcept;
 T_CORE_EXPORT QByteArray lz4Uncompress(const QByteArray &data) noexcept;
 
+// Content-codings of HTTP
+T_CORE_EXPORT QByteArray deflateCompress(const QByteArray &data, int compressionLevel = 6) noexcept;
+T_CORE_EXPORT QByteArray gzipCompress(const QByteArray &data, int compressionLevel = 6) noexcept;
+
 inline bool strcmp(const QByteArray &str1, const QByteArray &str2)
 {
     return str1.length() == str2.length() && !std::strncmp(str1.data(), str2.data(), str1.length());
@@ -543,6 +543,41 @@ QList<TCookie> THttpRequest::cookies() const
     return d->header.cookies();
 }
 
+/*!
+  Returns true if the content-coding \a coding, such as "gzip", is
+  acceptable according to the Accept-Encoding header; otherwise
+  returns false.
+ */
+bool THttpRequest::acceptsEncoding(const QByteArray &coding) const
+{
+    const QByteArray acceptEncoding = d->header.rawHeader(QByteArrayLiteral("Accept-Encoding"));
+    if (acceptEncoding.isEmpty()) {
+        return false;
+    }
+
+    bool wildcard = false;
+    const QList<QByteArray> codings = acceptEncoding.split(',');
+    for (auto &c : codings) {
+        QList<QByteArray> params = c.split(';');
+        QByteArray name = params.value(0).trimmed().toLower();
+        double q = 1.0;
+        for (int i = 1; i < params.count(); i++) {
+            QByteArray p = params[i].trimmed();
+            if (p.startsWith("q=")) {
+                q = p.mid(2).toDouble();
+            }
+        }
+
+        if (name == coding) {
+            return q > 0;
+        }
+        if (name == "*") {
+            wildcard = (q > 0);
+        }
+    }
+    return wildcard;
+}
+
 /*!
   Returns a map of all form data.
  */
@@ -76,6 +76,7 @@ public:
     TMultipartFormData &multipartFormData();
     QByteArray cookie(const QString &name) const;
     QList<TCookie> cookies() const;
+    bool acceptsEncoding(const QByteArray &coding) const;
     QHostAddress clientAddress() const { return d->clientAddress; }
     QHostAddress originatingClientAddress() const;
     QIODevice *rawBody();
@@ -11,8 +11,12 @@
 #include <QMap>
 #include <QUrl>
 #include <QStringEncoder>
+#include <bit>
 #include <chrono>
 #include <format>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #if defined(Q_OS_WIN)
 #include <qt_windows.h>
@@ -70,6 +74,138 @@ const QMap<int, QByteArray> reasonPhrase = {
     {(int)Tf::StatusCode::HTTPVersionNotSupported, "HTTP Version Not Supported"},
 };
 
+namespace {
+
+// Characters to be converted by htmlEscape(); a quote not to be converted
+// is substituted by '&' so as not to branch by the flag.
+class EscapeChars {
+public:
+    explicit EscapeChars(Tf::EscapeFlag flag) :
+        dquot((flag == Tf::Compatible || flag == Tf::Quotes) ? '"' : '&'),
+        squot((flag == Tf::Quotes) ? '\'' : '&') { }
+
+    bool contains(char16_t c) const { return c == '&' || c == '<' || c == '>' || c == dquot || c == squot; }
+
+    const char16_t dquot;
+    const char16_t squot;
+};
+
+
+inline const char *entity(char16_t c)
+{
+    switch (c) {
+    case '&':
+        return "&amp;";
+    case '<':
+        return "&lt;";
+    case '>':
+        return "&gt;";
+    case '"':
+        return "&quot;";
+    default:
+        return "&#039;";
+    }
+}
+
+// Returns the first character to be escaped in [p, end), or end
+const char *findEscapeChar(const char *p, const char *end, const EscapeChars &chars)
+{
+#if defined(__SSE2__)
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i dquot = _mm_set1_epi8((char)chars.dquot);
+    const __m128i squot = _mm_set1_epi8((char)chars.squot);
+
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, amp), _mm_cmpeq_epi8(v, lt)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, gt), _mm_or_si128(_mm_cmpeq_epi8(v, dquot), _mm_cmpeq_epi8(v, squot))));
+        uint mask = _mm_movemask_epi8(m);
+        if (mask) {
+            return p + std::countr_zero(mask);
+        }
+    }
+#endif
+
+    for (; p < end; ++p) {
+        if (chars.contains((uchar)*p)) {
+            break;
+        }
+    }
+    return p;
+}
+
+// Returns the first character to be escaped in [p, end), or end
+const char16_t *findEscapeChar(const char16_t *p, const char16_t *end, const EscapeChars &chars)
+{
+#if defined(__SSE2__)
+    const __m128i amp = _mm_set1_epi16('&');
+    const __m128i lt = _mm_set1_epi16('<');
+    const __m128i gt = _mm_set1_epi16('>');
+    const __m128i dquot = _mm_set1_epi16(chars.dquot);
+    const __m128i squot = _mm_set1_epi16(chars.squot);
+
+    for (; end - p >= 8; p += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi16(v, amp), _mm_cmpeq_epi16(v, lt)),
+            _mm_or_si128(_mm_cmpeq_epi16(v, gt), _mm_or_si128(_mm_cmpeq_epi16(v, dquot), _mm_cmpeq_epi16(v, squot))));
+        uint mask = _mm_movemask_epi8(m);
+        if (mask) {
+            return p + std::countr_zero(mask) / 2;
+        }
+    }
+#endif
+
+    for (; p < end; ++p) {
+        if (chars.contains(*p)) {
+            break;
+        }
+    }
+    return p;
+}
+
+// Returns the first '%' or '+' in [p, end), or end
+const char *findEncodedChar(const char *p, const char *end)
+{
+#if defined(__SSE2__)
+    const __m128i percent = _mm_set1_epi8('%');
+    const __m128i plus = _mm_set1_epi8('+');
+
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        uint mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, percent), _mm_cmpeq_epi8(v, plus)));
+        if (mask) {
+            return p + std::countr_zero(mask);
+        }
+    }
+#endif
+
+    for (; p < end; ++p) {
+        if (*p == '%' || *p == '+') {
+            break;
+        }
+    }
+    return p;
+}
+
+
+inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+}
+
 
 /*!
   \class THttpUtility
@@ -83,9 +219,49 @@ const QMap<int, QByteArray> reasonPhrase = {
 */
 QString THttpUtility::fromUrlEncoding(const QByteArray &enc)
 {
-    QByteArray d = enc;
-    d = QByteArray::fromPercentEncoding(d.replace("+", "%20"));
-    return QString::fromUtf8(d.constData(), d.length());
+    return QString::fromUtf8(fromUrlEncodingUtf8(enc));
+}
+
+/*!
+  Returns a decoded copy of \a enc as bytes, without converting them from
+  UTF-8. If \a enc contains neither '%' nor '+', \a enc itself is returned.
+  A '%' not followed by two hexadecimal digits is left as it is.
+  @sa fromUrlEncoding(const QByteArray &)
+*/
+QByteArray THttpUtility::fromUrlEncodingUtf8(const QByteArray &enc)
+{
+    const char *begin = enc.constData();
+    const char *end = begin + enc.length();
+    const char *p = findEncodedChar(begin, end);
+    if (p == end) {
+        return enc;  // nothing to decode
+    }
+
+    QByteArray decoded;
+    decoded.reserve(enc.length());
+    const char *start = begin;
+
+    while (p < end) {
+        decoded.append(start, p - start);
+        if (*p == '+') {
+            decoded += ' ';
+            ++p;
+        } else {
+            int hi = (end - p > 2) ? hexValue(p[1]) : -1;
+            int lo = (hi >= 0) ? hexValue(p[2]) : -1;
+            if (lo >= 0) {
+                decoded += (char)((hi << 4) | lo);
+                p += 3;
+            } else {
+                decoded += '%';
+                ++p;
+            }
+        }
+        start = p;
+        p = findEncodedChar(p, end);
+    }
+    decoded.append(start, end - start);
+    return decoded;
 }
 
 /*!
@@ -130,34 +306,25 @@ QList<QPair<QString, QString>> THttpUtility::fromFormUrlEncoded(const QByteArray
 */
 QString THttpUtility::htmlEscape(const QString &input, Tf::EscapeFlag flag)
 {
-    const QLatin1Char amp('&');
-    const QLatin1Char lt('<');
-    const QLatin1Char gt('>');
-    const QLatin1Char dquot('"');
-    const QLatin1Char squot('\'');
-    const QLatin1String eamp("&amp;");
-    const QLatin1String elt("&lt;");
-    const QLatin1String egt("&gt;");
-    const QString edquot("&quot;");
-    const QString esquot("&#039;");
+    const EscapeChars chars(flag);
+    const char16_t *begin = reinterpret_cast<const char16_t *>(input.utf16());
+    const char16_t *end = begin + input.length();
+    const char16_t *p = findEscapeChar(begin, end, chars);
+    if (p == end) {
+        return input;  // nothing to escape
+    }
 
     QString escaped;
-    escaped.reserve(int(input.length() * 1.1));
-    for (int i = 0; i < input.length(); ++i) {
-        if (input.at(i) == amp) {
-            escaped += eamp;
-        } else if (input.at(i) == lt) {
-            escaped += elt;
-        } else if (input.at(i) == gt) {
-            escaped += egt;
-        } else if (input.at(i) == dquot) {
-            escaped += (flag == Tf::Compatible || flag == Tf::Quotes) ? edquot : input.at(i);
-        } else if (input.at(i) == squot) {
-            escaped += (flag == Tf::Quotes) ? esquot : input.at(i);
-        } else {
-            escaped += input.at(i);
-        }
+    escaped.reserve(input.length() + input.length() / 8 + 8);
+    const char16_t *start = begin;
+
+    while (p < end) {
+        escaped += QStringView(start, p);
+        escaped += QLatin1String(entity(*p));
+        start = ++p;
+        p = findEscapeChar(p, end, chars);
     }
+    escaped += QStringView(start, end);
     return escaped;
 }
 
@@ -166,7 +333,7 @@ QString THttpUtility::htmlEscape(const QString &input, Tf::EscapeFlag flag)
 */
 QString THttpUtility::htmlEscape(const char *input, Tf::EscapeFlag flag)
 {
-    return htmlEscape(QString(input), flag);
+    return QString::fromUtf8(htmlEscapeUtf8(QByteArray::fromRawData(input, qstrlen(input)), flag));
 }
 
 /*!
@@ -174,7 +341,36 @@ QString THttpUtility::htmlEscape(const char *input, Tf::EscapeFlag flag)
 */
 QString THttpUtility::htmlEscape(const QByteArray &input, Tf::EscapeFlag flag)
 {
-    return htmlEscape(QString(input), flag);
+    return QString::fromUtf8(htmlEscapeUtf8(input, flag));
+}
+
+/*!
+  Returns a converted copy of the UTF-8 string \a input in the same way
+  as htmlEscape(const QString &, Tf::EscapeFlag), without converting it
+  to QString. If nothing is to be converted, \a input itself is returned.
+*/
+QByteArray THttpUtility::htmlEscapeUtf8(const QByteArray &input, Tf::EscapeFlag flag)
+{
+    const EscapeChars chars(flag);
+    const char *begin = input.constData();
+    const char *end = begin + input.length();
+    const char *p = findEscapeChar(begin, end, chars);
+    if (p == end) {
+        return input;  // nothing to escape
+    }
+
+    QByteArray escaped;
+    escaped.reserve(input.length() + input.length() / 8 + 8);
+    const char *start = begin;
+
+    while (p < end) {
+        escaped.append(start, p - start);
+        escaped += entity((uchar)*p);
+        start = ++p;
+        p = findEscapeChar(p, end, chars);
+    }
+    escaped.append(start, end - start);
+    return escaped;
 }
 
 /*!
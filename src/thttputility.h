@@ -10,6 +10,7 @@
 class T_CORE_EXPORT THttpUtility {
 public:
     static QString fromUrlEncoding(const QByteArray &enc);
+    static QByteArray fromUrlEncodingUtf8(const QByteArray &enc);
     static QByteArray toUrlEncoding(const QString &input, const QByteArray &exclude = "-._");
     static QList<QPair<QString, QString>> fromFormUrlEncoded(const QByteArray &enc);
     static QString htmlEscape(const QString &input, Tf::EscapeFlag flag = Tf::Quotes);
@@ -23,6 +24,7 @@ public:
     static QString htmlEscape(const char *input, Tf::EscapeFlag flag = Tf::Quotes);
     static QString htmlEscape(const QByteArray &input, Tf::EscapeFlag flag = Tf::Quotes);
     static QString htmlEscape(const QVariant &input, Tf::EscapeFlag flag = Tf::Quotes);
+    static QByteArray htmlEscapeUtf8(const QByteArray &input, Tf::EscapeFlag flag = Tf::Quotes);
     static QString jsonEscape(const QString &input);
     static QString jsonEscape(const char *input);
     static QString jsonEscape(const QByteArray &input);
@@ -7,13 +7,19 @@
 
 #include "tjsloader.h"
 #include "tsystemglobal.h"
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QReadWriteLock>
 #include <QTextStream>
 #include <TWebApplication>
+#include <memory>
+
+constexpr int MAX_COMPILED_JSX_COUNT = 1024;
 
 // #define tSystemError(fmt, ...)  printf(fmt "\n", ## __VA_ARGS__)
 // #define tSystemDebug(fmt, ...)  printf(fmt "\n", ## __VA_ARGS__)
@@ -28,6 +34,8 @@ namespace {
 QMap<QString, TJSModule *> jsContexts;
 QStringList defaultPaths;
 QRecursiveMutex gMutex;
+QReadWriteLock compiledJsxLock;
+QHash<QByteArray, QString> compiledJsx;  // SHA-1 of JSX to JavaScript
 }
 
 
@@ -141,29 +149,53 @@ TJSModule *TJSLoader::load(bool reload)
     }
 
     if (!context) {
-        context = new TJSModule();
-        QJSValue res;
-
-        for (auto &p : (const QList<QPair<QString, QString>> &)_importFiles) {
-            // Imports as JavaScript
-            res = TJSLoader(p.first, p.second, Default).importTo(context, false);
-             if (res.isError() || res.isNull()) {
-                context->deleteLater();
-                return nullptr;
-             }
+        context = createModule();
+        if (context) {
+            jsContexts.insert(key, context);
         }
+    }
+    return context;
+}
+
+/*!
+  Creates a new JavaScript context loading the module, which is not
+  shared by load().
+*/
+TJSModule *TJSLoader::createModule() const
+{
+    auto *context = new TJSModule();
+    QJSValue res;
 
-        res = importTo(context, true);
+    for (auto &p : (const QList<QPair<QString, QString>> &)_importFiles) {
+        // Imports as JavaScript
+        res = TJSLoader(p.first, p.second, Default).importTo(context, false);
         if (res.isError() || res.isNull()) {
-            context->deleteLater();
-            context = nullptr;
-        } else {
-            jsContexts.insert(key, context);
+            delete context;
+            return nullptr;
         }
     }
+
+    res = importTo(context, true);
+    if (res.isError() || res.isNull()) {
+        delete context;
+        return nullptr;
+    }
     return context;
 }
 
+/*!
+  Returns a key identifying the module with its imports and search paths.
+*/
+QString TJSLoader::moduleKey() const
+{
+    QString key = _member + QLatin1Char(';') + _module + QLatin1Char(';') + QString::number(_altJs);
+    for (auto &p : _importFiles) {
+        key += QLatin1Char(';') + p.first + QLatin1Char('=') + p.second;
+    }
+    key += QLatin1Char(';') + _searchPaths.join(QLatin1Char(':'));
+    return key;
+}
+
 
 QString TJSLoader::search(const QString &moduleName, AltJS alt) const
 {
@@ -403,10 +435,41 @@ void TJSLoader::replaceRequire(TJSModule *context, QString &content, const QDir
 }
 
 
+/*!
+  Compiles the \a jsx into JavaScript. The results are cached by the
+  hash of JSX. The JSXTransformer is loaded into a JavaScript engine
+  owned by the calling thread, since the engine must not be used by
+  other threads.
+*/
 QString TJSLoader::compileJsx(const QString &jsx)
 {
-    auto *transform = TJSLoader("JSXTransformer", "JSXTransformer").load();
+    const QByteArray hash = QCryptographicHash::hash(QByteArrayView((const char *)jsx.constData(), jsx.length() * sizeof(QChar)), QCryptographicHash::Sha1);
+    {
+        QReadLocker locker(&compiledJsxLock);
+        auto it = compiledJsx.constFind(hash);
+        if (it != compiledJsx.constEnd()) {
+            return it.value();
+        }
+    }
+
+    // Destroyed at the thread exit
+    thread_local std::unique_ptr<TJSModule> transform;
+    if (!transform) {
+        transform.reset(TJSLoader("JSXTransformer", "JSXTransformer").createModule());
+        if (!transform) {
+            return QString();
+        }
+    }
+
     QJSValue jscode = transform->call("JSXTransformer.transform", QJSValue(jsx));
     //tSystemDebug("code:{}", qUtf8Printable(jscode.property("code").toString()));
-    return jscode.property("code").toString();
+    QString code = jscode.property("code").toString();
+    if (!jscode.isError() && !code.isEmpty()) {
+        QWriteLocker locker(&compiledJsxLock);
+        if (compiledJsx.count() >= MAX_COMPILED_JSX_COUNT) {
+            compiledJsx.clear();
+        }
+        compiledJsx.insert(hash, code);
+    }
+    return code;
 }
@@ -31,6 +31,8 @@ protected:
     QString search(const QString &moduleName, AltJS alt) const;
     QString absolutePath(const QString &moduleName, const QDir &dir, AltJS alt) const;
     void replaceRequire(TJSModule *context, QString &content, const QDir &dir) const;
+    TJSModule *createModule() const;
+    QString moduleKey() const;
 
 private:
     QString _module;
@@ -40,5 +42,6 @@ private:
     QList<QPair<QString, QString>> _importFiles;
 
     friend class TJSModule;
+    friend class TReactComponent;
 };
 
@@ -0,0 +1,364 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tjsonwriter.h"
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocale>
+#include <QMetaProperty>
+#include <QReadWriteLock>
+#include <QUuid>
+#include <TAbstractModel>
+#include <TModelObject>
+#include <cmath>
+
+/*!
+  \class TJsonWriter
+  \brief The TJsonWriter class writes models and variants as compact
+  JSON in UTF-8 directly into a byte array.
+
+  Unlike TAbstractModel::toJsonObject() and QJsonDocument::toJson(), it
+  reads the properties of the models and writes the escaped values
+  without building intermediate QVariantMap and QJsonObject. The values
+  are converted as QJsonValue::fromVariant() does. The properties of
+  models are written in the declaration order.
+*/
+
+namespace {
+
+class PropertyName {
+public:
+    int index {0};
+    QString name;  // variable name
+    QByteArray key;  // JSON key followed by a colon
+};
+
+QReadWriteLock propertyNamesLock;
+QHash<const QMetaObject *, QList<PropertyName>> propertyNamesMap;
+
+// Returns the property names of the meta-object, which are converted to
+// the variable names of models and cached
+QList<PropertyName> propertyNames(const QMetaObject *metaObj)
+{
+    {
+        QReadLocker locker(&propertyNamesLock);
+        auto it = propertyNamesMap.constFind(metaObj);
+        if (it != propertyNamesMap.constEnd()) {
+            return it.value();
+        }
+    }
+
+    QList<PropertyName> names;
+    for (int i = metaObj->propertyOffset(); i < metaObj->propertyCount(); ++i) {
+        QString name = TAbstractModel::fieldNameToVariableName(QLatin1String(metaObj->property(i).name()));
+        if (name.isEmpty()) {
+            continue;
+        }
+
+        QByteArray key;
+        TJsonWriter(key).write(name);
+        key += ':';
+        names.append(PropertyName {i, name, key});
+    }
+
+    QWriteLocker locker(&propertyNamesLock);
+    propertyNamesMap.insert(metaObj, names);
+    return names;
+}
+
+
+inline char hexDigit(int n)
+{
+    return "0123456789abcdef"[n & 0xF];
+}
+
+}
+
+
+TJsonWriter::TJsonWriter(QByteArray &buffer) :
+    _buffer(buffer)
+{
+}
+
+/*!
+  Writes the \a model as a JSON object. If \a properties is not empty,
+  writes only the properties listed.
+*/
+void TJsonWriter::write(const TAbstractModel &model, const QStringList &properties)
+{
+    const TModelObject *obj = model.modelData();
+    if (obj) {
+        write(*obj, properties);
+    } else {
+        write(model.toVariantMap(properties));
+    }
+}
+
+/*!
+  Writes the model object \a object as a JSON object, whose keys are the
+  property names converted as TAbstractModel::fieldNameToVariableName().
+  If \a properties is not empty, writes only the properties listed.
+*/
+void TJsonWriter::write(const TModelObject &object, const QStringList &properties)
+{
+    const QMetaObject *metaObj = object.metaObject();
+    bool first = true;
+
+    _buffer += '{';
+    for (const auto &prop : propertyNames(metaObj)) {
+        if (!properties.isEmpty() && !properties.contains(prop.name)) {
+            continue;
+        }
+
+        if (!first) {
+            _buffer += ',';
+        }
+        first = false;
+        _buffer += prop.key;
+        write(metaObj->property(prop.index).read(&object));
+    }
+    _buffer += '}';
+}
+
+/*!
+  Writes the \a value as a JSON value.
+*/
+void TJsonWriter::write(const QVariant &value)
+{
+    switch (value.typeId()) {
+    case QMetaType::UnknownType:
+    case QMetaType::Nullptr:
+        _buffer += "null";
+        break;
+
+    case QMetaType::Bool:
+        _buffer += value.toBool() ? "true" : "false";
+        break;
+
+    case QMetaType::Int:
+    case QMetaType::Short:
+    case QMetaType::Char:
+    case QMetaType::SChar:
+    case QMetaType::Long:
+    case QMetaType::LongLong:
+        _buffer += QByteArray::number(value.toLongLong());
+        break;
+
+    case QMetaType::UInt:
+    case QMetaType::UShort:
+    case QMetaType::UChar:
+    case QMetaType::ULong:
+    case QMetaType::ULongLong:
+        _buffer += QByteArray::number(value.toULongLong());
+        break;
+
+    case QMetaType::Float:
+    case QMetaType::Double: {
+        double d = value.toDouble();
+        if (std::isfinite(d)) {
+            _buffer += QByteArray::number(d, 'g', QLocale::FloatingPointShortest);
+        } else {
+            _buffer += "null";
+        }
+        break;
+    }
+
+    case QMetaType::QString:
+        writeString(*static_cast<const QString *>(value.constData()));
+        break;
+
+    case QMetaType::QByteArray:
+        writeString(QString::fromUtf8(*static_cast<const QByteArray *>(value.constData())));
+        break;
+
+    case QMetaType::QStringList:
+        write(*static_cast<const QStringList *>(value.constData()));
+        break;
+
+    case QMetaType::QVariantMap:
+        write(*static_cast<const QVariantMap *>(value.constData()));
+        break;
+
+    case QMetaType::QVariantList:
+        write(*static_cast<const QVariantList *>(value.constData()));
+        break;
+
+    case QMetaType::QVariantHash: {
+        const auto &hash = *static_cast<const QVariantHash *>(value.constData());
+        QVariantMap map;
+        for (auto it = hash.constBegin(); it != hash.constEnd(); ++it) {
+            map.insert(it.key(), it.value());
+        }
+        write(map);
+        break;
+    }
+
+    case QMetaType::QDateTime:
+    case QMetaType::QDate:
+    case QMetaType::QTime: {
+        // Null date/time as null, not an empty string
+        QString str = value.toString();
+        if (str.isEmpty()) {
+            _buffer += "null";
+        } else {
+            writeString(str);
+        }
+        break;
+    }
+
+    case QMetaType::QUuid:
+        writeString(value.toUuid().toString(QUuid::WithoutBraces));
+        break;
+
+    case QMetaType::QJsonValue:
+    case QMetaType::QJsonObject:
+    case QMetaType::QJsonArray:
+    case QMetaType::QJsonDocument:
+        write(QJsonValue::fromVariant(value).toVariant());
+        break;
+
+    default:
+        if (value.canConvert<QString>()) {
+            writeString(value.toString());
+        } else {
+            _buffer += "null";
+        }
+        break;
+    }
+}
+
+/*!
+  Writes the \a map as a JSON object.
+*/
+void TJsonWriter::write(const QVariantMap &map)
+{
+    bool first = true;
+    _buffer += '{';
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        if (!first) {
+            _buffer += ',';
+        }
+        first = false;
+        writeString(it.key());
+        _buffer += ':';
+        write(it.value());
+    }
+    _buffer += '}';
+}
+
+/*!
+  Writes the \a list as a JSON array.
+*/
+void TJsonWriter::write(const QVariantList &list)
+{
+    bool first = true;
+    _buffer += '[';
+    for (const auto &value : list) {
+        if (!first) {
+            _buffer += ',';
+        }
+        first = false;
+        write(value);
+    }
+    _buffer += ']';
+}
+
+/*!
+  Writes the \a list as a JSON array of strings.
+*/
+void TJsonWriter::write(const QStringList &list)
+{
+    bool first = true;
+    _buffer += '[';
+    for (const auto &str : list) {
+        if (!first) {
+            _buffer += ',';
+        }
+        first = false;
+        writeString(str);
+    }
+    _buffer += ']';
+}
+
+/*!
+  Writes the \a str as a JSON string.
+*/
+void TJsonWriter::write(const QString &str)
+{
+    writeString(str);
+}
+
+/*!
+  Returns the \a model as a JSON object.
+*/
+QByteArray TJsonWriter::toJson(const TAbstractModel &model, const QStringList &properties)
+{
+    QByteArray json;
+    json.reserve(256);
+    TJsonWriter(json).write(model, properties);
+    return json;
+}
+
+// Writes the string quoted and escaped, encoding the runs of characters
+// not to be escaped into UTF-8 directly in the buffer
+void TJsonWriter::writeString(QStringView str)
+{
+    const char16_t *p = str.utf16();
+    const char16_t *end = p + str.size();
+
+    _buffer += '"';
+    while (p < end) {
+        const char16_t *run = p;
+        while (p < end && *p >= 0x20 && *p != u'"' && *p != u'\\') {
+            ++p;
+        }
+
+        if (p > run) {
+            qsizetype len = _buffer.size();
+            _buffer.resize(len + _encoder.requiredSpace(p - run));
+            char *out = _encoder.appendToBuffer(_buffer.data() + len, QStringView(run, p));
+            _buffer.truncate(out - _buffer.constData());
+        }
+
+        if (p == end) {
+            break;
+        }
+
+        switch (*p) {
+        case u'"':
+            _buffer += "\\\"";
+            break;
+        case u'\\':
+            _buffer += "\\\\";
+            break;
+        case u'\b':
+            _buffer += "\\b";
+            break;
+        case u'\f':
+            _buffer += "\\f";
+            break;
+        case u'\n':
+            _buffer += "\\n";
+            break;
+        case u'\r':
+            _buffer += "\\r";
+            break;
+        case u'\t':
+            _buffer += "\\t";
+            break;
+        default: {
+            const char esc[] = {'\\', 'u', '0', '0', hexDigit(*p >> 4), hexDigit(*p)};
+            _buffer.append(esc, sizeof(esc));
+            break;
+        }
+        }
+        ++p;
+    }
+    _buffer += '"';
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include <QByteArray>
+#include <QStringConverter>
+#include <QStringList>
+#include <QVariant>
+#include <TGlobal>
+
+class TAbstractModel;
+class TModelObject;
+
+
+class T_CORE_EXPORT TJsonWriter {
+public:
+    TJsonWriter(QByteArray &buffer);
+
+    void write(const TAbstractModel &model, const QStringList &properties = QStringList());
+    void write(const TModelObject &object, const QStringList &properties = QStringList());
+    void write(const QVariant &value);
+    void write(const QVariantMap &map);
+    void write(const QVariantList &list);
+    void write(const QStringList &list);
+    void write(const QString &str);
+    template <class Container>
+    void writeArray(const Container &container, const QStringList &properties = QStringList());
+
+    static QByteArray toJson(const TAbstractModel &model, const QStringList &properties = QStringList());
+    template <class Container>
+    static QByteArray toJsonArray(const Container &container, const QStringList &properties = QStringList());
+
+private:
+    void writeString(QStringView str);
+
+    QByteArray &_buffer;
+    QStringEncoder _encoder {QStringConverter::Utf8};
+
+    T_DISABLE_COPY(TJsonWriter)
+    T_DISABLE_MOVE(TJsonWriter)
+};
+
+
+/*!
+  Writes the elements of the \a container, such as QList of models or
+  TSqlORMapper, as a JSON array.
+*/
+template <class Container>
+inline void TJsonWriter::writeArray(const Container &container, const QStringList &properties)
+{
+    bool first = true;
+    _buffer += '[';
+    for (const auto &item : container) {
+        if (!first) {
+            _buffer += ',';
+        }
+        first = false;
+        write(item, properties);
+    }
+    _buffer += ']';
+}
+
+/*!
+  Returns the elements of the \a container as a JSON array.
+*/
+template <class Container>
+inline QByteArray TJsonWriter::toJsonArray(const Container &container, const QStringList &properties)
+{
+    QByteArray json;
+    TJsonWriter(json).writeArray(container, properties);
+    return json;
+}
@@ -0,0 +1,178 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tlocalcache.h"
+#include <TAppSettings>
+
+/*!
+  \class TLocalCache
+  \brief The TLocalCache class keeps the values of TCache in memory of
+  the application server process in front of the cache backend.
+
+  The values are held uncompressed in LRU lists of 16 shards, each of
+  which is guarded by its own lock. A value is kept for at most
+  Cache.LocalMaxAge seconds, which bounds its staleness even if an
+  invalidation from other processes is missed.
+*/
+
+TLocalCache::TLocalCache()
+{
+    _maxShardSize = Tf::appSettings()->value(Tf::CacheLocalMaxTotalSize).toLongLong() / NUM_SHARDS;
+}
+
+/*!
+  Returns a global TLocalCache object.
+*/
+TLocalCache &TLocalCache::instance()
+{
+    static TLocalCache cache;
+    return cache;
+}
+
+/*!
+  Returns true if the local cache is enabled by the settings
+  Cache.LocalMaxTotalSize and Cache.LocalMaxAge; otherwise returns false.
+*/
+bool TLocalCache::isEnabled()
+{
+    static const bool enable = Tf::appSettings()->value(Tf::CacheLocalMaxTotalSize).toLongLong() > 0 && maxAge() > 0;
+    return enable;
+}
+
+/*!
+  Returns the maximum number of seconds for which a value is kept.
+*/
+int TLocalCache::maxAge()
+{
+    static const int age = Tf::appSettings()->value(Tf::CacheLocalMaxAge).toInt();
+    return age;
+}
+
+/*!
+  Looks up the value associated with the \a key and sets it to \a value.
+  Returns true if found; otherwise returns false.
+*/
+bool TLocalCache::get(const QByteArray &key, QByteArray &value)
+{
+    auto &sh = shard(key);
+    QMutexLocker locker(&sh.mutex);
+
+    auto it = sh.entries.find(key);
+    if (it == sh.entries.end()) {
+        return false;
+    }
+
+    if (it->expire <= Tf::getMSecsSinceEpoch()) {
+        sh.removeEntry(it);
+        return false;
+    }
+
+    sh.lru.splice(sh.lru.begin(), sh.lru, it->lruPos);
+    value = it->value;
+    return true;
+}
+
+/*!
+  Keeps the \a value with the \a key for \a seconds, but no longer than
+  Cache.LocalMaxAge seconds.
+*/
+void TLocalCache::insert(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    const int64_t size = key.size() + value.size();
+    if (seconds <= 0 || size > _maxShardSize / 8) {
+        remove(key);  // too large to be kept
+        return;
+    }
+
+    const int64_t expire = Tf::getMSecsSinceEpoch() + qMin(seconds, maxAge()) * 1000LL;
+    auto &sh = shard(key);
+    QMutexLocker locker(&sh.mutex);
+
+    auto it = sh.entries.find(key);
+    if (it != sh.entries.end()) {
+        sh.totalSize += size - (key.size() + it->value.size());
+        it->value = value;
+        it->expire = expire;
+        sh.lru.splice(sh.lru.begin(), sh.lru, it->lruPos);
+    } else {
+        sh.lru.push_front(key);
+        sh.entries.insert(key, Entry {value, expire, sh.lru.begin()});
+        sh.totalSize += size;
+    }
+
+    // Evicts the least recently used values
+    while (sh.totalSize > _maxShardSize && !sh.lru.empty()) {
+        sh.removeEntry(sh.entries.find(sh.lru.back()));
+    }
+}
+
+/*!
+  Removes the value associated with the \a key.
+*/
+void TLocalCache::remove(const QByteArray &key)
+{
+    auto &sh = shard(key);
+    QMutexLocker locker(&sh.mutex);
+
+    auto it = sh.entries.find(key);
+    if (it != sh.entries.end()) {
+        sh.removeEntry(it);
+    }
+}
+
+/*!
+  Removes all values.
+*/
+void TLocalCache::clear()
+{
+    for (auto &sh : _shards) {
+        QMutexLocker locker(&sh.mutex);
+        sh.entries.clear();
+        sh.lru.clear();
+        sh.totalSize = 0;
+    }
+}
+
+/*!
+  Returns the number of values kept.
+*/
+int TLocalCache::count() const
+{
+    int cnt = 0;
+    for (auto &sh : _shards) {
+        QMutexLocker locker(&sh.mutex);
+        cnt += sh.entries.count();
+    }
+    return cnt;
+}
+
+/*!
+  Returns the total bytes of the keys and values kept.
+*/
+int64_t TLocalCache::totalSize() const
+{
+    int64_t size = 0;
+    for (auto &sh : _shards) {
+        QMutexLocker locker(&sh.mutex);
+        size += sh.totalSize;
+    }
+    return size;
+}
+
+
+TLocalCache::Shard &TLocalCache::shard(const QByteArray &key)
+{
+    return _shards[qHash(key) % NUM_SHARDS];
+}
+
+
+void TLocalCache::Shard::removeEntry(QHash<QByteArray, Entry>::iterator it)
+{
+    totalSize -= it.key().size() + it->value.size();
+    lru.erase(it->lruPos);
+    entries.erase(it);
+}
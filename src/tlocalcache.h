@@ -0,0 +1,49 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <TGlobal>
+#include <list>
+
+
+class T_CORE_EXPORT TLocalCache {
+public:
+    static TLocalCache &instance();
+    static bool isEnabled();
+    static int maxAge();
+
+    bool get(const QByteArray &key, QByteArray &value);
+    void insert(const QByteArray &key, const QByteArray &value, int seconds);
+    void remove(const QByteArray &key);
+    void clear();
+    int count() const;
+    int64_t totalSize() const;
+
+private:
+    class Entry {
+    public:
+        QByteArray value;
+        int64_t expire {0};  // msecs since epoch
+        std::list<QByteArray>::iterator lruPos;
+    };
+
+    class Shard {
+    public:
+        mutable QMutex mutex;
+        QHash<QByteArray, Entry> entries;
+        std::list<QByteArray> lru;  // front is the most recently used
+        int64_t totalSize {0};
+
+        void removeEntry(QHash<QByteArray, Entry>::iterator it);
+    };
+
+    TLocalCache();
+    Shard &shard(const QByteArray &key);
+
+    static constexpr int NUM_SHARDS = 16;
+    Shard _shards[NUM_SHARDS];
+    int64_t _maxShardSize {0};
+
+    T_DISABLE_COPY(TLocalCache)
+    T_DISABLE_MOVE(TLocalCache)
+};
@@ -43,6 +43,42 @@ inline bool containsWhiteSpace(const QByteArray &string)
     return false;
 }
 
+// Parses the VALUE lines of a reply of the get command. Returns true if
+// the reply is complete.
+bool parseValues(const QByteArray &reply, QMap<QByteArray, QByteArray> *values)
+{
+    int pos = 0;
+    for (;;) {
+        int to = reply.indexOf(Tf::CRLF, pos);
+        if (to < 0) {
+            return false;
+        }
+
+        QByteArray line = reply.mid(pos, to - pos);
+        if (!line.startsWith("VALUE ")) {
+            return true;  // END or error
+        }
+
+        auto strs = line.split(' ');
+        int bytes = strs.value(3).toInt();
+        int start = to + 2;
+        if (reply.length() < start + bytes + 2) {
+            return false;
+        }
+
+        if (values) {
+            values->insert(strs.value(1), reply.mid(start, bytes));
+        }
+        pos = start + bytes + 2;
+    }
+}
+
+// Returns true if the reply has the number of lines
+bool hasLines(const QByteArray &reply, int lines)
+{
+    return reply.count(Tf::CRLF) >= lines;
+}
+
 }
 
 /*!
@@ -83,6 +119,35 @@ QByteArray TMemcached::get(const QByteArray &key, uint *flags)
 }
 
 
+/*!
+  Returns the values associated with the \a keys, retrieved by one
+  request. The keys not found are not contained.
+ */
+QMap<QByteArray, QByteArray> TMemcached::get(const QByteArrayList &keys)
+{
+    QMap<QByteArray, QByteArray> values;
+    QByteArray message = "get";
+
+    for (auto &key : keys) {
+        if (key.isEmpty() || containsWhiteSpace(key)) {
+            Tf::error("Value error, key: {}", key.data());
+            return values;
+        }
+        message += ' ';
+        message += key;
+    }
+
+    if (keys.isEmpty() || !isOpen()) {
+        return values;
+    }
+
+    message += Tf::CRLF;
+    QByteArray reply = driver()->request(message, [](const QByteArray &reply) { return parseValues(reply, nullptr); });
+    parseValues(reply, &values);
+    return values;
+}
+
+
 int64_t TMemcached::getNumber(const QByteArray &key, bool *ok, uint *flags)
 {
     QByteArray res = get(key, flags);
@@ -112,6 +177,43 @@ bool TMemcached::set(const QByteArray &key, int64_t value, int seconds, uint fla
 }
 
 
+/*!
+  Stores the \a items which expire after \a seconds by one request.
+  Returns the number of items stored.
+ */
+int TMemcached::set(const QMap<QByteArray, QByteArray> &items, int seconds, uint flags)
+{
+    QByteArray message;
+
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        if (it.key().isEmpty() || containsWhiteSpace(it.key())) {
+            Tf::error("Value error, key: {}", it.key().data());
+            return 0;
+        }
+
+        message += "set ";
+        message += it.key();
+        message += ' ';
+        message += QByteArray::number(flags);
+        message += ' ';
+        message += QByteArray::number(seconds);
+        message += ' ';
+        message += QByteArray::number(it.value().length());
+        message += Tf::CRLF;
+        message += it.value();
+        message += Tf::CRLF;
+    }
+
+    if (items.isEmpty() || !isOpen()) {
+        return 0;
+    }
+
+    const int count = items.count();
+    QByteArray reply = driver()->request(message, [count](const QByteArray &reply) { return hasLines(reply, count); });
+    return reply.count("STORED\r\n") - reply.count("NOT_STORED\r\n");
+}
+
+
 bool TMemcached::add(const QByteArray &key, const QByteArray &value, int seconds, uint flags)
 {
     QByteArray res = request("add", key, value, flags, seconds, false);
@@ -160,6 +262,42 @@ bool TMemcached::remove(const QByteArray &key)
 }
 
 
+/*!
+  Removes the items with the \a keys by one request. Returns the number
+  of items removed.
+ */
+int TMemcached::remove(const QByteArrayList &keys)
+{
+    QByteArray message;
+
+    for (auto &key : keys) {
+        if (key.isEmpty() || containsWhiteSpace(key)) {
+            Tf::error("Value error, key: {}", key.data());
+            return 0;
+        }
+
+        message += "delete ";
+        message += key;
+        message += Tf::CRLF;
+    }
+
+    if (keys.isEmpty() || !isOpen()) {
+        return 0;
+    }
+
+    const int count = keys.count();
+    QByteArray reply = driver()->request(message, [count](const QByteArray &reply) { return hasLines(reply, count); });
+    return reply.count("DELETED\r\n");
+}
+
+
+bool TMemcached::touch(const QByteArray &key, int seconds)
+{
+    QByteArray res = requestLine("touch", key, QByteArray::number(seconds), false);
+    return res.startsWith("TOUCHED");
+}
+
+
 uint64_t TMemcached::incr(const QByteArray &key, uint64_t value, bool *ok)
 {
     QByteArray res = requestLine("incr", key, QByteArray::number((qulonglong)value), false);
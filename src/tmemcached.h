@@ -1,5 +1,6 @@
 #pragma once
 #include <QByteArray>
+#include <QMap>
 #include <QStringList>
 #include <TGlobal>
 #include <TKvsDatabase>
@@ -15,9 +16,11 @@ public:
 
     bool isOpen() const;
     QByteArray get(const QByteArray &key, uint *flags = nullptr);
+    QMap<QByteArray, QByteArray> get(const QByteArrayList &keys);
     int64_t getNumber(const QByteArray &key, bool *ok = nullptr, uint *flags = nullptr);
     bool set(const QByteArray &key, const QByteArray &value, int seconds, uint flags = 0);
     bool set(const QByteArray &key, int64_t value, int seconds, uint flags = 0);
+    int set(const QMap<QByteArray, QByteArray> &items, int seconds, uint flags = 0);
     bool add(const QByteArray &key, const QByteArray &value, int seconds, uint flags = 0);
     bool add(const QByteArray &key, int64_t value, int seconds, uint flags = 0);
     bool replace(const QByteArray &key, const QByteArray &value, int seconds, uint flags = 0);
@@ -25,6 +28,8 @@ public:
     bool append(const QByteArray &key, const QByteArray &value, int seconds, uint flags = 0);
     bool prepend(const QByteArray &key, const QByteArray &value, int seconds, uint flags = 0);
     bool remove(const QByteArray &key);
+    int remove(const QByteArrayList &keys);
+    bool touch(const QByteArray &key, int seconds);
     uint64_t incr(const QByteArray &key, uint64_t value, bool *ok = nullptr);
     uint64_t decr(const QByteArray &key, uint64_t value, bool *ok = nullptr);
     bool flushAll();
@@ -47,3 +47,32 @@ QByteArray TMemcachedDriver::request(const QByteArray &command, int msecs)
 
     return readReply(msecs);
 }
+
+/*!
+  Sends the \a command and reads the reply until \a isComplete returns
+  true for the whole reply received, such as one of several commands
+  sent at a time.
+*/
+QByteArray TMemcachedDriver::request(const QByteArray &command, const std::function<bool(const QByteArray &)> &isComplete, int msecs)
+{
+    if (Q_UNLIKELY(!isOpen())) {
+        tSystemError("Not open memcached session  [{}:{}]", __FILE__, __LINE__);
+        return QByteArray();
+    }
+
+    if (!writeCommand(command)) {
+        tSystemError("memcached write error  [{}:{}]", __FILE__, __LINE__);
+        close();
+        return QByteArray();
+    }
+
+    QByteArray reply;
+    do {
+        QByteArray buf = readReply(msecs);
+        if (buf.isEmpty()) {
+            break;  // timeout or error
+        }
+        reply += buf;
+    } while (!isComplete(reply));
+    return reply;
+}
@@ -4,6 +4,7 @@
 #include <QtGlobal>
 #include <TGlobal>
 #include <TKvsDriver>
+#include <functional>
 
 #ifdef Q_OS_LINUX
 class TTcpSocket;
@@ -24,6 +25,7 @@ public:
     bool isOpen() const override;
     void moveToThread(QThread *thread) override;
     QByteArray request(const QByteArray &command, int msecs = 5000);
+    QByteArray request(const QByteArray &command, const std::function<bool(const QByteArray &)> &isComplete, int msecs = 5000);
 
 protected:
     bool writeCommand(const QByteArray &command);
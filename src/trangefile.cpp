@@ -0,0 +1,198 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "trangefile.h"
+#include "tsystemglobal.h"
+#include <cstring>
+
+constexpr int MAX_RANGE_COUNT = 32;
+
+/*!
+  \class TRangeFile
+  \brief The TRangeFile class is a read-only device which produces one or
+  more byte ranges of a file, each one optionally preceded by a prologue,
+  followed by an epilogue. It is used to send partial content (206) of
+  static files and sendFile() responses.
+*/
+
+TRangeFile::TRangeFile(const QString &fileName, const QList<Range> &ranges, const QByteArray &epilogue) :
+    QIODevice(),
+    _file(fileName),
+    _ranges(ranges),
+    _epilogue(epilogue)
+{
+}
+
+
+TRangeFile::~TRangeFile()
+{
+    close();
+}
+
+/*!
+  Returns the total number of bytes produced by this device.
+*/
+int64_t TRangeFile::totalLength() const
+{
+    int64_t total = _epilogue.length();
+    for (auto &r : _ranges) {
+        total += r.prologue.length() + r.length;
+    }
+    return total;
+}
+
+
+bool TRangeFile::open(OpenMode mode)
+{
+    if (mode & (QIODevice::WriteOnly | QIODevice::Append)) {
+        tSystemError("TRangeFile is read-only: {}", _file.fileName());
+        return false;
+    }
+
+    if (!_file.open(QIODevice::ReadOnly)) {
+        tSystemError("file open failed: {}", _file.fileName());
+        return false;
+    }
+
+    _index = 0;
+    _pos = 0;
+    return QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+}
+
+
+void TRangeFile::close()
+{
+    _file.close();
+    QIODevice::close();
+}
+
+
+bool TRangeFile::atEnd() const
+{
+    return _index >= _ranges.count() && _pos >= _epilogue.length();
+}
+
+
+qint64 TRangeFile::readData(char *data, qint64 maxSize)
+{
+    qint64 total = 0;
+
+    while (total < maxSize && !atEnd()) {
+        if (_index >= _ranges.count()) {
+            // Epilogue
+            int64_t len = std::min<int64_t>(_epilogue.length() - _pos, maxSize - total);
+            std::memcpy(data + total, _epilogue.data() + _pos, len);
+            _pos += len;
+            total += len;
+            continue;
+        }
+
+        const Range &range = _ranges[_index];
+        const int64_t plen = range.prologue.length();
+
+        if (_pos < plen) {
+            // Prologue of the range
+            int64_t len = std::min<int64_t>(plen - _pos, maxSize - total);
+            std::memcpy(data + total, range.prologue.data() + _pos, len);
+            _pos += len;
+            total += len;
+
+        } else if (_pos < plen + range.length) {
+            int64_t offset = range.offset + (_pos - plen);
+            if (_file.pos() != offset && !_file.seek(offset)) {
+                tSystemError("file seek error: {}", _file.fileName());
+                return (total > 0) ? total : -1;
+            }
+
+            int64_t len = std::min<int64_t>(plen + range.length - _pos, maxSize - total);
+            len = _file.read(data + total, len);
+            if (len <= 0) {
+                tSystemError("file read error: {}", _file.fileName());
+                return (total > 0) ? total : -1;
+            }
+            _pos += len;
+            total += len;
+
+        } else {
+            // Next range
+            ++_index;
+            _pos = 0;
+        }
+    }
+    return total;
+}
+
+/*!
+  Parses the value of a Range header \a rangeHeader for a representation
+  of \a fileSize bytes and returns the list of satisfiable ranges as pairs
+  of offset and length. If the header is not a valid byte-ranges-specifier,
+  *\a ok is set to false and the header should be ignored. If the returned
+  list is empty while *\a ok is true, none of the ranges is satisfiable.
+*/
+QList<QPair<int64_t, int64_t>> TRangeFile::parseByteRanges(const QByteArray &rangeHeader, int64_t fileSize, bool *ok)
+{
+    QList<QPair<int64_t, int64_t>> ranges;
+    QByteArray value = rangeHeader.trimmed();
+
+    if (ok) {
+        *ok = false;
+    }
+
+    if (!value.startsWith("bytes=")) {
+        return ranges;
+    }
+
+    const QList<QByteArray> specs = value.mid(6).split(',');
+    if (specs.count() > MAX_RANGE_COUNT) {
+        return ranges;
+    }
+
+    for (auto &s : specs) {
+        QByteArray spec = s.trimmed();
+        int idx = spec.indexOf('-');
+        if (idx < 0) {
+            ranges.clear();
+            return ranges;
+        }
+
+        bool okf = true, okl = true;
+        QByteArray first = spec.left(idx).trimmed();
+        QByteArray last = spec.mid(idx + 1).trimmed();
+        int64_t start, end;
+
+        if (first.isEmpty()) {
+            // Suffix range, "-500"
+            int64_t suffix = last.toLongLong(&okl);
+            if (!okl || suffix < 0) {
+                ranges.clear();
+                return ranges;
+            }
+            if (suffix == 0 || fileSize == 0) {
+                continue;  // unsatisfiable
+            }
+            start = std::max<int64_t>(fileSize - suffix, 0);
+            end = fileSize - 1;
+        } else {
+            start = first.toLongLong(&okf);
+            end = (last.isEmpty()) ? fileSize - 1 : last.toLongLong(&okl);
+            if (!okf || !okl || start < 0 || (!last.isEmpty() && end < start)) {
+                ranges.clear();
+                return ranges;
+            }
+            if (start >= fileSize) {
+                continue;  // unsatisfiable
+            }
+            end = std::min(end, fileSize - 1);
+        }
+        ranges << qMakePair(start, end - start + 1);
+    }
+
+    if (ok) {
+        *ok = true;
+    }
+    return ranges;
+}
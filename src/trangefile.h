@@ -0,0 +1,47 @@
+#pragma once
+#include <QFile>
+#include <QIODevice>
+#include <QList>
+#include <QPair>
+#include <TGlobal>
+
+
+class T_CORE_EXPORT TRangeFile : public QIODevice {
+public:
+    class Range {
+    public:
+        int64_t offset {0};
+        int64_t length {0};
+        QByteArray prologue;  // bytes sent before the range (multipart headers)
+    };
+
+    TRangeFile(const QString &fileName, const QList<Range> &ranges, const QByteArray &epilogue = QByteArray());
+    ~TRangeFile();
+
+    QString fileName() const { return _file.fileName(); }
+    const QList<Range> &ranges() const { return _ranges; }
+    const QByteArray &epilogue() const { return _epilogue; }
+    int64_t totalLength() const;
+
+    bool open(OpenMode mode) override;
+    void close() override;
+    bool isSequential() const override { return true; }
+    qint64 size() const override { return totalLength(); }
+    bool atEnd() const override;
+
+    static QList<QPair<int64_t, int64_t>> parseByteRanges(const QByteArray &rangeHeader, int64_t fileSize, bool *ok = nullptr);
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    QFile _file;
+    QList<Range> _ranges;
+    QByteArray _epilogue;
+    int _index {0};  // index of current range
+    int64_t _pos {0};  // position in current range, including its prologue
+
+    T_DISABLE_COPY(TRangeFile)
+    T_DISABLE_MOVE(TRangeFile)
+};
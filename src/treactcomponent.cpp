@@ -6,12 +6,118 @@
  */
 
 #include "tsystemglobal.h"
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QThreadPool>
+#include <TAppSettings>
 #include <TJSLoader>
+#include <TJSModule>
 #include <TReactComponent>
+#include <algorithm>
+#include <future>
 
 //#define tSystemError(fmt, ...)  printf(fmt "\n", ## __VA_ARGS__)
 //#define tSystemDebug(fmt, ...)  printf(fmt "\n", ## __VA_ARGS__)
 
+constexpr int MODIFICATION_CHECK_INTERVAL_MSECS = 1000;
+constexpr int MAX_RENDER_CACHE_COUNT = 1024;
+
+namespace {
+
+class WarmModule {
+public:
+    TJSModule *module {nullptr};
+    QDateTime loadedTime;
+    int64_t lastChecked {0};  // msecs since epoch
+};
+
+// Preloaded JavaScript engines owned by each render thread, since a JS
+// engine must be used in the thread that created it
+class ThreadModules {
+public:
+    ~ThreadModules()
+    {
+        for (auto &warm : modules) {
+            delete warm.module;
+        }
+    }
+
+    QHash<QString, WarmModule> modules;
+};
+
+thread_local ThreadModules threadModules;
+
+
+// Threads rendering the components, which never expire so that their
+// engines are kept warm; the threads of the thread MPM are started for
+// each connection and would load React every time
+QThreadPool *renderThreadPool()
+{
+    static QThreadPool *pool = []() {
+        auto *p = new QThreadPool;  // Never destroyed
+        p->setMaxThreadCount(std::max(QThread::idealThreadCount(), 1));
+        p->setExpiryTimeout(-1);
+        return p;
+    }();
+    return pool;
+}
+
+
+class RenderCache {
+public:
+    QString value(const QString &key)
+    {
+        QMutexLocker locker(&mutex);
+        auto it = entries.constFind(key);
+        if (it != entries.constEnd() && it.value().second > QDateTime::currentMSecsSinceEpoch()) {
+            return it.value().first;
+        }
+        return QString();
+    }
+
+    void insert(const QString &key, const QString &html, int seconds)
+    {
+        const int64_t now = QDateTime::currentMSecsSinceEpoch();
+        QMutexLocker locker(&mutex);
+        if (entries.count() >= MAX_RENDER_CACHE_COUNT) {
+            // Removes expired ones
+            for (auto it = entries.begin(); it != entries.end();) {
+                if (it.value().second <= now) {
+                    it = entries.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+            if (entries.count() >= MAX_RENDER_CACHE_COUNT) {
+                entries.clear();
+            }
+        }
+        entries.insert(key, qMakePair(html, now + seconds * 1000LL));
+    }
+
+private:
+    QMutex mutex;
+    QHash<QString, QPair<QString, int64_t>> entries;  // HTML and its expiry
+};
+
+RenderCache renderCache;
+
+}
+
+/*!
+  \class TReactComponent
+  \brief The TReactComponent class renders React components on the
+  server side.
+
+  The components are rendered by a pool of threads living until the
+  process exits. The JavaScript engine loading the component is created
+  at the first rendering in each of the threads and kept for later
+  renderings, so that React and the component are not evaluated for
+  every request. The engine is recreated when the module file is
+  modified.
+*/
+
 
 TReactComponent::TReactComponent(const QString &moduleName, const QStringList &searchPaths) :
     jsLoader(new TJSLoader(moduleName, TJSLoader::Jsx)), loadedTime()
@@ -24,6 +130,12 @@ TReactComponent::TReactComponent(const QString &moduleName, const QStringList &s
 }
 
 
+TReactComponent::~TReactComponent()
+{
+    delete jsLoader;
+}
+
+
 void TReactComponent::import(const QString &moduleName)
 {
     jsLoader->import(moduleName);
@@ -36,27 +148,86 @@ void TReactComponent::import(const QString &defaultMember, const QString &module
 }
 
 
+/*!
+  Renders the \a component in JSX, such as "<Hello name='foo' />", into
+  an HTML string. If React.RenderCacheSeconds in application.ini is
+  positive, the result is cached for the seconds.
+*/
 QString TReactComponent::renderToString(const QString &component)
 {
-    auto *context = jsLoader->load();
+    static const int cacheSeconds = Tf::appSettings()->value(Tf::ReactRenderCacheSeconds).toInt();
 
-    if (loadedTime.isNull()) {
-        loadedTime = QDateTime::currentDateTime();
-    } else {
-        if (context) {
-            QFileInfo fi(context->modulePath());
-            if (context->modulePath().isEmpty() || (fi.exists() && fi.lastModified() > loadedTime)) {
-                context = jsLoader->load(true);
-                loadedTime = QDateTime::currentDateTime();
-            }
+    QString cacheKey;
+    if (cacheSeconds > 0) {
+        cacheKey = jsLoader->moduleKey() + QLatin1Char('\n') + component;
+        QString html = renderCache.value(cacheKey);
+        if (!html.isNull()) {
+            return html;
         }
     }
 
+    // Waits for a render thread
+    std::promise<QString> promise;
+    auto future = promise.get_future();
+    renderThreadPool()->start([&]() {
+        promise.set_value(render(component));
+    });
+
+    QString html = future.get();
+    if (!html.isNull() && cacheSeconds > 0) {
+        renderCache.insert(cacheKey, html, cacheSeconds);
+    }
+    return html;
+}
+
+// Called in a render thread
+QString TReactComponent::render(const QString &component)
+{
+    auto *context = module();
     if (!context) {
         return QString();
     }
 
     QString func = QLatin1String("ReactDOMServer.renderToString(") + TJSLoader::compileJsx(component) + QLatin1String(");");
     tSystemDebug("TReactComponent func: {}", func);
-    return context->evaluate(func).toString();
+    QJSValue result = context->evaluate(func);
+    if (result.isError()) {
+        return QString();
+    }
+    return result.toString();
+}
+
+/*!
+  Returns the JavaScript engine of this thread loading the module,
+  which is created at the first call and recreated if the module file
+  has been modified.
+*/
+TJSModule *TReactComponent::module()
+{
+    const QString key = jsLoader->moduleKey();
+    const int64_t now = QDateTime::currentMSecsSinceEpoch();
+    WarmModule &warm = threadModules.modules[key];
+
+    if (warm.module && now - warm.lastChecked >= MODIFICATION_CHECK_INTERVAL_MSECS) {
+        warm.lastChecked = now;
+        QFileInfo fi(warm.module->modulePath());
+        if (warm.module->modulePath().isEmpty() || (fi.exists() && fi.lastModified() > warm.loadedTime)) {
+            tSystemDebug("Reloads React component: {}", warm.module->modulePath());
+            delete warm.module;
+            warm.module = nullptr;
+        }
+    }
+
+    if (!warm.module) {
+        warm.module = jsLoader->createModule();
+        if (!warm.module) {
+            threadModules.modules.remove(key);
+            return nullptr;
+        }
+        warm.loadedTime = QDateTime::currentDateTime();
+        warm.lastChecked = now;
+    }
+
+    loadedTime = warm.loadedTime;
+    return warm.module;
 }
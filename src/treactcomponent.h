@@ -4,12 +4,13 @@
 #include <TGlobal>
 
 class TJSLoader;
+class TJSModule;
 
 
 class T_CORE_EXPORT TReactComponent {
 public:
     TReactComponent(const QString &moduleName, const QStringList &searchPaths = QStringList());
-    virtual ~TReactComponent() { }
+    virtual ~TReactComponent();
 
     void import(const QString &moduleName);
     void import(const QString &defaultMember, const QString &moduleName);
@@ -17,6 +18,9 @@ public:
     QDateTime loadedDateTime() const { return loadedTime; }
 
 private:
+    QString render(const QString &component);
+    TJSModule *module();
+
     TJSLoader *jsLoader;
     QDateTime loadedTime;
 
@@ -107,6 +107,23 @@ bool TRedis::exists(const QByteArray &key)
     return (res && resp.value(0).toInt() == 1);
 }
 
+/*!
+  Sets a timeout of \a seconds seconds on the \a key. Returns true if
+  the timeout was set; otherwise returns false, such as if the key does
+  not exist.
+ */
+bool TRedis::expire(const QByteArray &key, int seconds)
+{
+    if (!driver()) {
+        return false;
+    }
+
+    QVariantList resp;
+    QByteArrayList command = {"EXPIRE", key, QByteArray::number(seconds)};
+    bool res = driver()->request(command, resp);
+    return (res && resp.value(0).toInt() == 1);
+}
+
 /*!
   Returns the value associated with the \a key; otherwise
   returns an empty byte array.
@@ -170,6 +187,23 @@ bool TRedis::setNx(const QByteArray &key, const QByteArray &value)
     return (res && resp.value(0).toInt() == 1);
 }
 
+/*!
+  Sets the \a key to hold the \a value and set the key to timeout after
+  a given number of \a seconds, only if the key does not exist. Returns
+  true if set.
+ */
+bool TRedis::setNxEx(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    if (!driver()) {
+        return false;
+    }
+
+    QVariantList resp;
+    QByteArrayList command = {"SET", key, value, "NX", "EX", QByteArray::number(seconds)};
+    bool res = driver()->request(command, resp);
+    return (res && resp.isEmpty());  // simple string 'OK', or a null bulk string if not set
+}
+
 /*!
   Atomically sets the \a key to the \a value and returns the old value
   stored at the \a key.
@@ -186,6 +220,51 @@ QByteArray TRedis::getSet(const QByteArray &key, const QByteArray &value)
     return (res) ? resp.value(0).toByteArray() : QByteArray();
 }
 
+/*!
+  Returns the values associated with the \a keys in the same order. The
+  value of a key which does not exist is a null byte array.
+ */
+QByteArrayList TRedis::mget(const QByteArrayList &keys)
+{
+    QByteArrayList values;
+    if (!driver() || keys.isEmpty()) {
+        return values;
+    }
+
+    QVariantList resp;
+    QByteArrayList command = {"MGET"};
+    command << keys;
+    if (driver()->request(command, resp)) {
+        for (auto &val : resp) {
+            values << val.toByteArray();
+        }
+    }
+    return values;
+}
+
+/*!
+  Sets the keys of the \a items to hold the values and set them to
+  timeout after a given number of \a seconds, in one request. Returns
+  the number of items set.
+ */
+int TRedis::msetEx(const QMap<QByteArray, QByteArray> &items, int seconds)
+{
+    // SETEX of all keys by a script, replying once
+    static const QByteArray script = "for i, k in ipairs(KEYS) do redis.call('SETEX', k, ARGV[1], ARGV[i + 1]) end return #KEYS";
+
+    if (!driver() || items.isEmpty()) {
+        return 0;
+    }
+
+    QVariantList resp;
+    QByteArrayList command = {"EVAL", script, QByteArray::number(items.count())};
+    command << items.keys();
+    command << QByteArray::number(seconds);
+    command << items.values();
+    bool res = driver()->request(command, resp);
+    return (res) ? resp.value(0).toInt() : 0;
+}
+
 /*!
   Removes the specified \a key. A key is ignored if it does
   not exist.
@@ -1,5 +1,6 @@
 #pragma once
 #include <QByteArray>
+#include <QMap>
 #include <QStringList>
 #include <QVariant>
 #include <TGlobal>
@@ -16,13 +17,17 @@ public:
 
     bool isOpen() const;
     bool exists(const QByteArray &key);
+    bool expire(const QByteArray &key, int seconds);
 
     // binary
     QByteArray get(const QByteArray &key);
     bool set(const QByteArray &key, const QByteArray &value);
     bool setEx(const QByteArray &key, const QByteArray &value, int seconds);
     bool setNx(const QByteArray &key, const QByteArray &value);
+    bool setNxEx(const QByteArray &key, const QByteArray &value, int seconds);
     QByteArray getSet(const QByteArray &key, const QByteArray &value);
+    QByteArrayList mget(const QByteArrayList &keys);
+    int msetEx(const QMap<QByteArray, QByteArray> &items, int seconds);
 
     // string
     QString gets(const QByteArray &key);
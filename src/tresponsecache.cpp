@@ -0,0 +1,180 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tresponsecache.h"
+#include "tsystemglobal.h"
+#include "turlroute.h"
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <THttpRequest>
+
+constexpr int MAX_ENTRY_COUNT = 4096;
+constexpr int RENDERING_WAIT_MSECS = 10000;
+
+/*!
+  \class TResponseCache
+  \brief The TResponseCache class keeps the responses of the routes
+  declared with the 'cache' option in routes.cfg, for a short time.
+
+  A cached response is sent before the controller is dispatched. While a
+  response is being rendered, other requests for the same key wait for
+  it instead of rendering it again.
+*/
+
+/*!
+  Returns a global TResponseCache object.
+*/
+TResponseCache &TResponseCache::instance()
+{
+    static TResponseCache responseCache;
+    return responseCache;
+}
+
+/*!
+  Returns the cache key of the \a request for the \a routing; made from
+  the path, the values of the query items and request headers listed in
+  the cache policy of the route, and whether the client accepts gzip, as
+  the body can be stored gzipped by TActionController::renderOnCache().
+*/
+QByteArray TResponseCache::key(const TRouting &routing, const THttpRequest &request)
+{
+    const THttpRequestHeader &header = request.header();
+    const QByteArray &path = header.path();
+
+    QByteArray key;
+    key.reserve(path.length() + 64);
+    key += path.mid(0, path.indexOf('?'));
+
+    for (auto &name : routing.cache.queryItems) {
+        key += '\0';
+        key += name.toUtf8();
+        key += '=';
+        key += request.allQueryItemValues(name).join(QChar('\0')).toUtf8();
+    }
+
+    for (auto &name : routing.cache.headers) {
+        key += '\n';
+        key += header.rawHeader(name);
+    }
+
+    key += '\t';
+    if (request.acceptsEncoding(QByteArrayLiteral("gzip"))) {
+        key += QByteArrayLiteral("gzip");
+    }
+    return key;
+}
+
+/*!
+  Returns the response cached for the \a key if any. Otherwise, returns
+  a null pointer and sets *\a renderer to true if the caller is to render
+  the response and store() it, then release() the key. If another thread
+  is rendering the response, waits for it.
+*/
+std::shared_ptr<const TResponseCache::Entry> TResponseCache::acquire(const QByteArray &key, bool *renderer)
+{
+    QDeadlineTimer deadline(RENDERING_WAIT_MSECS);
+    bool waited = false;
+
+    *renderer = false;
+    QMutexLocker locker(&_mutex);
+
+    for (;;) {
+        auto entry = _entries.value(key);
+        if (entry && entry->expires > QDateTime::currentMSecsSinceEpoch()) {
+            return entry;
+        }
+
+        auto it = _rendering.constFind(key);
+        if (it == _rendering.constEnd()) {
+            if (waited) {
+                // The response was not cacheable
+                return nullptr;
+            }
+            _rendering.insert(key, QThread::currentThreadId());
+            *renderer = true;
+            return nullptr;
+        }
+
+        if (it.value() == QThread::currentThreadId()) {
+            // Rendering in this thread, such as in a nested event loop
+            return nullptr;
+        }
+
+        waited = true;
+        if (!_rendered.wait(&_mutex, deadline)) {
+            tSystemWarn("Timed out waiting for rendering: {}", key.data());
+            return nullptr;
+        }
+    }
+}
+
+/*!
+  Stores the response of the \a header and \a body for the \a key for
+  \a seconds seconds.
+*/
+void TResponseCache::store(const QByteArray &key, const THttpResponseHeader &header, const QByteArray &body, int seconds)
+{
+    const int64_t now = QDateTime::currentMSecsSinceEpoch();
+    auto entry = std::make_shared<Entry>();
+    entry->header = header;
+    entry->body = body;
+    entry->expires = now + seconds * 1000LL;
+
+    QMutexLocker locker(&_mutex);
+    purge(now);
+    if (_entries.count() >= MAX_ENTRY_COUNT && !_entries.contains(key)) {
+        tSystemWarn("Response cache is full: {}", key.data());
+        return;
+    }
+    _entries.insert(key, entry);
+}
+
+/*!
+  Finishes rendering of the \a key and wakes up the requests waiting
+  for it.
+*/
+void TResponseCache::release(const QByteArray &key)
+{
+    QMutexLocker locker(&_mutex);
+    _rendering.remove(key);
+    _rendered.wakeAll();
+}
+
+/*!
+  Removes all the responses.
+*/
+void TResponseCache::clear()
+{
+    QMutexLocker locker(&_mutex);
+    _entries.clear();
+}
+
+/*!
+  Returns the number of the responses.
+*/
+int TResponseCache::count() const
+{
+    QMutexLocker locker(&_mutex);
+    return _entries.count();
+}
+
+// Removes expired entries at most once a second
+void TResponseCache::purge(int64_t now)
+{
+    if (now - _lastPurge < 1000) {
+        return;
+    }
+    _lastPurge = now;
+
+    for (auto it = _entries.begin(); it != _entries.end();) {
+        if (it.value()->expires <= now) {
+            it = _entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <THttpResponseHeader>
+#include <TGlobal>
+#include <memory>
+
+class THttpRequest;
+class TRouting;
+
+
+class T_CORE_EXPORT TResponseCache {
+public:
+    class Entry {
+    public:
+        THttpResponseHeader header;
+        QByteArray body;
+        int64_t expires {0};  // msecs since epoch
+    };
+
+    static TResponseCache &instance();
+    static QByteArray key(const TRouting &routing, const THttpRequest &request);
+
+    std::shared_ptr<const Entry> acquire(const QByteArray &key, bool *renderer);
+    void store(const QByteArray &key, const THttpResponseHeader &header, const QByteArray &body, int seconds);
+    void release(const QByteArray &key);
+    void clear();
+    int count() const;
+
+private:
+    TResponseCache() { }
+    void purge(int64_t now);
+
+    mutable QMutex _mutex;
+    QWaitCondition _rendered;
+    QHash<QByteArray, std::shared_ptr<Entry>> _entries;
+    QHash<QByteArray, Qt::HANDLE> _rendering;  // keys being rendered and their threads
+    int64_t _lastPurge {0};
+
+    T_DISABLE_COPY(TResponseCache)
+    T_DISABLE_MOVE(TResponseCache)
+};
@@ -6,6 +6,7 @@
  */
 
 #include "tsendbuffer.h"
+#include "trangefile.h"
 #include "tsystemglobal.h"
 #include <TfCore>
 #include <QFile>
@@ -32,6 +33,18 @@ TSendBuffer::TSendBuffer(const QByteArray &header, const QFileInfo &file, bool a
 }
 
 
+TSendBuffer::TSendBuffer(const QByteArray &header, const TRangeFile &file, TAccessLogger &&logger) :
+    _arrayBuffer(header),
+    _accesslogger(std::move(logger))
+{
+    _bodyFile = new TRangeFile(file.fileName(), file.ranges(), file.epilogue());
+    if (!_bodyFile->open(QIODevice::ReadOnly)) {
+        tSystemWarn("file open failed: {}", file.fileName());
+        release();
+    }
+}
+
+
 TSendBuffer::TSendBuffer(const QByteArray &header) :
     _arrayBuffer(header)
 {
@@ -65,7 +78,9 @@ void TSendBuffer::release()
 {
     if (_bodyFile) {
         if (_fileRemove) {
-            _bodyFile->remove();
+            if (auto *file = qobject_cast<QFile *>(_bodyFile)) {
+                file->remove();
+            }
         }
         delete _bodyFile;
         _bodyFile = nullptr;
@@ -93,7 +108,9 @@ void *TSendBuffer::getData(int &size)
     _arrayBuffer.reserve(size);
     size = _bodyFile->read(_arrayBuffer.data(), size);
     if (Q_UNLIKELY(size < 0)) {
-        tSystemError("file read error: {}", _bodyFile->fileName());
+        auto *rangeFile = dynamic_cast<TRangeFile *>(_bodyFile);
+        auto *file = qobject_cast<QFile *>(_bodyFile);
+        tSystemError("file read error: {}", rangeFile ? rangeFile->fileName() : (file ? file->fileName() : QString()));
         size = 0;
         release();
         return nullptr;
@@ -3,10 +3,11 @@
 #include <TAccessLog>
 #include <TGlobal>
 
-class QFile;
+class QIODevice;
 class QFileInfo;
 class QHostAddress;
 class THttpHeader;
+class TRangeFile;
 
 
 class T_CORE_EXPORT TSendBuffer {
@@ -23,12 +24,13 @@ public:
 
 private:
     QByteArray _arrayBuffer;
-    QFile *_bodyFile {nullptr};
+    QIODevice *_bodyFile {nullptr};
     bool _fileRemove {false};
     TAccessLogger _accesslogger;
     int _startPos {0};
 
     TSendBuffer(const QByteArray &header, const QFileInfo &file, bool autoRemove, TAccessLogger &&logger);
+    TSendBuffer(const QByteArray &header, const TRangeFile &file, TAccessLogger &&logger);
     TSendBuffer(const QByteArray &header);
     TSendBuffer(Tf::StatusCode statusCode, const QHostAddress &address, const QByteArray &method);
     TSendBuffer();
@@ -59,6 +59,20 @@ QByteArray TSession::sessionName()
   Returns the ID.
 */
 
+/*!
+  \fn bool TSession::isModified() const
+  Returns true if the data or the ID has been changed since the session
+  was loaded from or written to the session store; otherwise returns
+  false. An unmodified session is not written to the store again.
+*/
+
+/*!
+  \fn QDateTime TSession::storedDateTime() const
+  Returns the date and time when the session was last written to or
+  touched in the session store, or a null QDateTime if the store does
+  not tell it.
+*/
+
 /*!
   \fn iterator TSession::insert(const Key &key, const T &value)
   Inserts a new item with the \a key and a value of \a value.
@@ -1,5 +1,6 @@
 #pragma once
 #include <QByteArray>
+#include <QDateTime>
 #include <QVariant>
 #include <TGlobal>
 
@@ -14,6 +15,8 @@ public:
     TSession &operator=(TSession &&other) = default;
 
     QByteArray id() const { return sessionId; }
+    bool isModified() const;
+    QDateTime storedDateTime() const;
     void reset();
     iterator insert(const QString &key, const QVariant &value);
     int remove(const QString &key);
@@ -24,9 +27,15 @@ public:
 
 private:
     QByteArray sessionId;
+    QByteArray storedId;
+    QVariantMap storedData;  // shares the data as stored
+    int64_t storedAt {0};  // secs since epoch, 0 if unknown
 
+    void setStored(int64_t time);
     void clear();  // disabled
     friend class TSessionCookieStore;
+    friend class TSessionManager;
+    friend class TSessionStore;
     friend class TActionContext;
 };
 
@@ -48,6 +57,23 @@ inline TSession::TSession(const QByteArray &id) :
 //     return *this;
 // }
 
+inline bool TSession::isModified() const
+{
+    return sessionId != storedId || *static_cast<const QVariantMap *>(this) != storedData;
+}
+
+inline QDateTime TSession::storedDateTime() const
+{
+    return (storedAt > 0) ? QDateTime::fromSecsSinceEpoch(storedAt) : QDateTime();
+}
+
+inline void TSession::setStored(int64_t time)
+{
+    storedId = sessionId;
+    storedData = *static_cast<const QVariantMap *>(this);
+    storedAt = time;
+}
+
 inline TSession::iterator TSession::insert(const QString &key, const QVariant &value)
 {
     return QVariantMap::insert(key, value);
@@ -10,66 +10,395 @@
 #include <TSystemGlobal>
 #include <QByteArray>
 #include <QDataStream>
+#include <QDateTime>
 #include <QCryptographicHash>
+#include <QHash>
 #include <QMessageAuthenticationCode>
+#include <QtEndian>
+#include <cstring>
+#include <memory>
+#include <vector>
 
 /*!
   \class TSessionCookieStore
   \brief The TSessionCookieStore class stores HTTP sessions into a cookie.
+
+  The session is encoded in a compact binary format, compressed only if
+  it is larger than Session.CookieCompressionThreshold in
+  application.ini, and signed with HMAC-SHA256 by Session.Secret. The
+  cookies signed by one of Session.PreviousSecrets are also accepted so
+  that the secret can be rotated. The time stored is encoded with the
+  session, so that the cookie is re-issued only once in a while to
+  extend its expiry. The cookies in the format of the former versions
+  are still read.
+
+  Cookie values verified once are memoized per thread, so that the
+  unchanged cookie sent again is not verified and decoded.
 */
 
+namespace {
+
+constexpr uchar FORMAT_VERSION = 0x03;  // with the time stored
+constexpr uchar FORMAT_VERSION_NO_TIME = 0x02;
+constexpr uchar FLAG_COMPRESSED = 0x80;
+constexpr int MAX_VERIFIED_COOKIES = 256;
 
-static const QByteArray &sessionSecret()
+// Type tags of the binary encoding
+enum ValueType : uchar {
+    Invalid = 0,
+    False,
+    True,
+    Int,
+    LongLong,
+    Double,
+    String,
+    ByteArray,
+    Variant,  // serialized by QDataStream
+};
+
+
+const QByteArray &sessionSecret()
 {
     static QByteArray secret = Tf::appSettings()->value(Tf::SessionSecret).toByteArray();
     return secret;
 }
 
 
-bool TSessionCookieStore::store(TSession &session)
+const QByteArrayList &previousSecrets()
 {
-    if (session.isEmpty()) {
-        session.sessionId = "";
-        return true;
+    static QByteArrayList secrets = []() {
+        QByteArrayList list;
+        const auto strs = Tf::appSettings()->value(Tf::SessionPreviousSecrets).toString().split(QLatin1Char(';'), Qt::SkipEmptyParts);
+        for (auto &str : strs) {
+            list << str.trimmed().toUtf8();
+        }
+        return list;
+    }();
+    return secrets;
+}
+
+
+int compressionThreshold()
+{
+    static int threshold = Tf::appSettings()->value(Tf::SessionCookieCompressionThreshold).toInt();
+    return threshold;
+}
+
+
+// HMAC-SHA256 with the keys of current and previous secrets, whose
+// objects are reused in the thread not to prepare the keys every time
+QByteArray messageDigest(const QByteArray &data, int keyIndex)
+{
+    thread_local std::vector<std::unique_ptr<QMessageAuthenticationCode>> macs;
+
+    if (macs.empty()) {
+        macs.emplace_back(new QMessageAuthenticationCode(QCryptographicHash::Sha256, sessionSecret()));
+        for (auto &secret : previousSecrets()) {
+            macs.emplace_back(new QMessageAuthenticationCode(QCryptographicHash::Sha256, secret));
+        }
+    }
+
+    auto &mac = *macs[keyIndex];
+    mac.reset();
+    mac.addData(data);
+    return mac.result();
+}
+
+
+// Compares in constant time
+bool equalDigest(const QByteArray &digest1, const QByteArray &digest2)
+{
+    if (digest1.length() != digest2.length()) {
+        return false;
+    }
+
+    uchar diff = 0;
+    for (int i = 0; i < digest1.length(); ++i) {
+        diff |= (uchar)digest1[i] ^ (uchar)digest2[i];
+    }
+    return diff == 0;
+}
+
+
+struct VerifiedCookie {
+    QVariantMap map;
+    int64_t storedAt {0};
+};
+
+
+QHash<QByteArray, VerifiedCookie> &verifiedCookies()
+{
+    thread_local QHash<QByteArray, VerifiedCookie> cookies;
+    return cookies;
+}
+
+
+void memoize(const QByteArray &cookie, const QVariantMap &map, int64_t storedAt)
+{
+    auto &cookies = verifiedCookies();
+    if (cookies.count() >= MAX_VERIFIED_COOKIES) {
+        cookies.clear();
+    }
+    cookies.insert(cookie, VerifiedCookie {map, storedAt});
+}
+
+
+class Encoder {
+public:
+    QByteArray buffer;
+    bool ok {true};
+
+    void writeVarint(quint64 n)
+    {
+        while (n >= 0x80) {
+            buffer += (char)((n & 0x7F) | 0x80);
+            n >>= 7;
+        }
+        buffer += (char)n;
     }
 
-#ifndef TF_NO_DEBUG
+    void writeBytes(const QByteArray &bytes)
     {
-        QByteArray badummy;
-        QDataStream dsdmy(&badummy, QIODevice::ReadWrite);
-        dsdmy << *static_cast<const QVariantMap *>(&session);
+        writeVarint(bytes.length());
+        buffer += bytes;
+    }
+
+    void writeValue(const QVariant &value)
+    {
+        switch (value.typeId()) {
+        case QMetaType::UnknownType:
+            buffer += (char)Invalid;
+            break;
 
-        TSession dummy;
-        dsdmy.device()->seek(0);
-        dsdmy >> *static_cast<QVariantMap *>(&dummy);
-        if (dsdmy.status() != QDataStream::Ok) {
-            tSystemError("Failed to store a session into the cookie store. Must set objects that can be serialized.");
+        case QMetaType::Bool:
+            buffer += (char)(value.toBool() ? True : False);
+            break;
+
+        case QMetaType::Int: {
+            qint64 n = value.toInt();
+            buffer += (char)Int;
+            writeVarint((quint64)((n << 1) ^ (n >> 63)));  // zigzag
+            break;
+        }
+
+        case QMetaType::LongLong: {
+            qint64 n = value.toLongLong();
+            buffer += (char)LongLong;
+            writeVarint((quint64)((n << 1) ^ (n >> 63)));
+            break;
+        }
+
+        case QMetaType::Double: {
+            double d = value.toDouble();
+            quint64 bits;
+            std::memcpy(&bits, &d, sizeof(bits));
+            bits = qToLittleEndian(bits);
+            buffer += (char)Double;
+            buffer.append((const char *)&bits, sizeof(bits));
+            break;
+        }
+
+        case QMetaType::QString:
+            buffer += (char)String;
+            writeBytes(value.toString().toUtf8());
+            break;
+
+        case QMetaType::QByteArray:
+            buffer += (char)ByteArray;
+            writeBytes(value.toByteArray());
+            break;
+
+        default: {
+            QByteArray ba;
+            QDataStream ds(&ba, QIODevice::WriteOnly);
+            ds.setVersion(QDataStream::Qt_6_0);
+            ds << value;
+            if (ds.status() != QDataStream::Ok) {
+                ok = false;
+            }
+            buffer += (char)Variant;
+            writeBytes(ba);
+            break;
+        }
         }
     }
-#endif
 
-    QByteArray ba;
-    QDataStream ds(&ba, QIODevice::WriteOnly);
-    ds << *static_cast<const QVariantMap *>(&session);
-    if (ds.status() != QDataStream::Ok) {
-        tSystemError("Failed to store session. Must set objects that can be serialized.");
+    void writeMap(const QVariantMap &map)
+    {
+        writeVarint(map.count());
+        for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+            writeBytes(it.key().toUtf8());
+            writeValue(it.value());
+        }
+    }
+};
+
+
+class Decoder {
+public:
+    Decoder(const QByteArray &data) :
+        _p(data.constData()), _end(data.constData() + data.length()) { }
+
+    bool ok {true};
+
+    quint64 readVarint()
+    {
+        quint64 n = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (_p >= _end) {
+                break;
+            }
+            uchar c = *_p++;
+            n |= (quint64)(c & 0x7F) << shift;
+            if (!(c & 0x80)) {
+                return n;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+
+    QByteArray readBytes()
+    {
+        quint64 len = readVarint();
+        if (!ok || len > (quint64)(_end - _p)) {
+            ok = false;
+            return QByteArray();
+        }
+        QByteArray bytes(_p, len);
+        _p += len;
+        return bytes;
+    }
+
+    QVariant readValue()
+    {
+        if (_p >= _end) {
+            ok = false;
+            return QVariant();
+        }
+
+        switch (*_p++) {
+        case Invalid:
+            return QVariant();
+
+        case False:
+            return QVariant(false);
+
+        case True:
+            return QVariant(true);
+
+        case Int: {
+            quint64 n = readVarint();
+            return QVariant((int)((n >> 1) ^ -(qint64)(n & 1)));
+        }
+
+        case LongLong: {
+            quint64 n = readVarint();
+            return QVariant((qint64)((n >> 1) ^ -(qint64)(n & 1)));
+        }
+
+        case Double: {
+            double d;
+            if (_end - _p < (qsizetype)sizeof(d)) {
+                ok = false;
+                return QVariant();
+            }
+            quint64 bits = qFromLittleEndian<quint64>(_p);
+            std::memcpy(&d, &bits, sizeof(d));
+            _p += sizeof(d);
+            return QVariant(d);
+        }
+
+        case String:
+            return QVariant(QString::fromUtf8(readBytes()));
+
+        case ByteArray:
+            return QVariant(readBytes());
+
+        case Variant: {
+            QByteArray ba = readBytes();
+            QDataStream ds(&ba, QIODevice::ReadOnly);
+            ds.setVersion(QDataStream::Qt_6_0);
+            QVariant value;
+            ds >> value;
+            if (ds.status() != QDataStream::Ok) {
+                ok = false;
+            }
+            return value;
+        }
+
+        default:
+            ok = false;
+            return QVariant();
+        }
+    }
+
+    QVariantMap readMap()
+    {
+        QVariantMap map;
+        quint64 count = readVarint();
+        for (quint64 i = 0; ok && i < count; ++i) {
+            QString key = QString::fromUtf8(readBytes());
+            QVariant value = readValue();
+            map.insert(key, value);
+        }
+        if (_p != _end) {
+            ok = false;
+        }
+        return map;
+    }
+
+private:
+    const char *_p {nullptr};
+    const char *_end {nullptr};
+};
+
+
+bool decodeCookie(const QByteArray &id, QVariantMap &map, int64_t &storedAt)
+{
+    int dot = id.indexOf('.');
+    if (dot <= 0 || dot == id.length() - 1) {
+        return false;
+    }
+
+    QByteArray data = QByteArray::fromBase64(id.left(dot), QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    QByteArray digest = QByteArray::fromBase64(id.mid(dot + 1), QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+
+    bool verified = false;
+    for (int i = 0; i <= previousSecrets().count() && !verified; ++i) {
+        verified = equalDigest(messageDigest(data, i), digest);
+    }
+
+    if (!verified) {
+        tSystemWarn("Recieved a tampered cookie or that of other web application.");
+        return false;
+    }
+
+    const uchar version = data.isEmpty() ? 0 : ((uchar)data[0] & ~FLAG_COMPRESSED);
+    if (version != FORMAT_VERSION && version != FORMAT_VERSION_NO_TIME) {
+        tSystemError("Failed to load a session from the cookie store. Unknown format.");
         return false;
     }
 
-    ba = Tf::lz4Compress(ba);
-    QByteArray digest = QMessageAuthenticationCode::hash(ba, sessionSecret(), QCryptographicHash::Sha3_256);
-    session.sessionId = ba.toBase64() + "_" + digest.toBase64();
+    QByteArray payload = data.mid(1);
+    if ((uchar)data[0] & FLAG_COMPRESSED) {
+        payload = Tf::lz4Uncompress(payload);
+    }
+
+    Decoder decoder(payload);
+    storedAt = (version == FORMAT_VERSION) ? (int64_t)decoder.readVarint() : 0;
+    map = decoder.readMap();
+    if (!decoder.ok) {
+        tSystemError("Failed to load a session from the cookie store.");
+        return false;
+    }
     return true;
 }
 
 
-TSession TSessionCookieStore::find(const QByteArray &id)
+// Decodes the format of the former versions
+bool decodeLegacyCookie(const QByteArray &id, QVariantMap &map)
 {
-    TSession session(id);
-    if (id.isEmpty()) {
-        return session;
-    }
-
     QByteArrayList balst = id.split('_');
 
     if (balst.count() == 2) {
@@ -80,22 +409,88 @@ TSession TSessionCookieStore::find(const QByteArray &id)
             QByteArray ba = QByteArray::fromBase64(data);
             QByteArray digest = QMessageAuthenticationCode::hash(ba, sessionSecret(), QCryptographicHash::Sha3_256);
 
-            if (!Tf::strcmp(digest, QByteArray::fromBase64(dgstr))) {
+            if (!equalDigest(digest, QByteArray::fromBase64(dgstr))) {
                 tSystemWarn("Recieved a tampered cookie or that of other web application.");
                 //throw SecurityException("Tampered with cookie", __FILE__, __LINE__);
-                return session;
+                return false;
             }
 
             ba = Tf::lz4Uncompress(ba);
             QDataStream ds(&ba, QIODevice::ReadOnly);
-            ds >> *static_cast<QVariantMap *>(&session);
+            ds >> map;
 
             if (ds.status() != QDataStream::Ok) {
                 tSystemError("Failed to load a session from the cookie store.");
-                session.reset();
+                return false;
             }
+            return true;
         }
     }
+    return false;
+}
+
+}
+
+
+bool TSessionCookieStore::store(TSession &session)
+{
+    if (session.isEmpty()) {
+        session.sessionId = "";
+        return true;
+    }
+
+    const QVariantMap &map = *static_cast<const QVariantMap *>(&session);
+    const int64_t storedAt = QDateTime::currentSecsSinceEpoch();
+    Encoder encoder;
+    encoder.buffer.reserve(256);
+    encoder.buffer += (char)FORMAT_VERSION;
+    encoder.writeVarint(storedAt);
+    encoder.writeMap(map);
+    if (!encoder.ok) {
+        tSystemError("Failed to store session. Must set objects that can be serialized.");
+        return false;
+    }
+
+    QByteArray data = encoder.buffer;
+    int threshold = compressionThreshold();
+    if (threshold >= 0 && data.length() > threshold) {
+        QByteArray compressed = Tf::lz4Compress(data.constData() + 1, data.length() - 1);
+        if (!compressed.isEmpty() && compressed.length() + 1 < data.length()) {
+            data = (char)(FORMAT_VERSION | FLAG_COMPRESSED) + compressed;
+        }
+    }
+
+    QByteArray digest = messageDigest(data, 0);
+    session.sessionId = data.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals) + '.'
+        + digest.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+    memoize(session.sessionId, map, storedAt);
+    return true;
+}
+
+
+TSession TSessionCookieStore::find(const QByteArray &id)
+{
+    TSession session(id);
+    if (id.isEmpty()) {
+        return session;
+    }
+
+    auto &cookies = verifiedCookies();
+    auto it = cookies.constFind(id);
+    if (it != cookies.constEnd()) {
+        *static_cast<QVariantMap *>(&session) = it->map;
+        session.storedAt = it->storedAt;
+        return session;
+    }
+
+    QVariantMap map;
+    int64_t storedAt = 0;
+    bool res = id.contains('.') ? decodeCookie(id, map, storedAt) : decodeLegacyCookie(id, map);
+    if (res) {
+        *static_cast<QVariantMap *>(&session) = map;
+        session.storedAt = storedAt;
+        memoize(id, map, storedAt);
+    }
     return session;
 }
 
@@ -8,74 +8,265 @@
 #include "tsessionfilestore.h"
 #include "tfcore.h"
 #include "tsystemglobal.h"
+#include <QCoreApplication>
 #include <QDataStream>
 #include <QDir>
+#include <QDirIterator>
 #include <QFile>
-#include <QReadWriteLock>
+#include <QMutex>
+#include <TAppSettings>
 #include <TWebApplication>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 constexpr auto SESSION_DIR_NAME = "session";
-
-static QReadWriteLock rwLock(QReadWriteLock::Recursive);  // Global read-write lock
+constexpr int NUM_SUBDIRS = 256;
+constexpr int NUM_LOCK_STRIPES = 64;
 
 /*!
   \class TSessionFileStore
   \brief The TSessionFileStore class stores HTTP sessions to files.
+
+  The session files are spread over 256 subdirectories by a hash of the
+  session ID. A session is written to a temporary file which then
+  replaces the session file atomically by renaming, so that it is read
+  without any lock. Writers of the same session in a process are
+  serialized by one of the striped locks.
+
+  If Session.FileSyncInterval in application.ini is positive, the
+  written files are flushed to the disk together at the interval and
+  store() waits for it.
 */
 
-bool TSessionFileStore::store(TSession &session)
+namespace {
+
+QMutex writeLocks[NUM_LOCK_STRIPES];
+std::atomic<uint> tmpFileCounter {0};
+
+// FNV-1a, stable across processes
+uint sessionHash(const QByteArray &id)
 {
-    QDir dir(sessionDirPath());
-    if (!dir.exists()) {
-        dir.mkpath(".");
+    uint h = 2166136261u;
+    for (char c : id) {
+        h ^= (uchar)c;
+        h *= 16777619u;
     }
+    return h;
+}
 
-    bool res = false;
-    QWriteLocker locker(&rwLock);  // lock for threads
-    QFile file(sessionDirPath() + session.id());
+QString subdirName(uint hash)
+{
+    return QString::number(hash % NUM_SUBDIRS, 16).rightJustified(2, QLatin1Char('0'));
+}
+
+// Rejects IDs which would point outside the session directory
+bool isValidId(const QByteArray &id)
+{
+    return !id.isEmpty() && !id.startsWith('.') && !id.contains('/') && !id.contains('\\');
+}
 
-    if (file.open(QIODevice::ReadWrite)) {
-        auto reslock = tf_lockfile(file.handle(), true, true);  // blocking flock for processes
-        int err = errno;
-        if (reslock < 0) {
-            tSystemWarn("flock error  errno:{}", err);
+QString sessionFilePath(const QByteArray &id)
+{
+    return TSessionFileStore::sessionDirPath() + subdirName(sessionHash(id)) + QLatin1Char('/') + QString::fromLatin1(id);
+}
+
+// Path of the session file in the flat directory of the former versions
+QString legacyFilePath(const QByteArray &id)
+{
+    return TSessionFileStore::sessionDirPath() + QString::fromLatin1(id);
+}
+
+bool replaceFile(const QString &from, const QString &to)
+{
+#ifdef Q_OS_WIN
+    return MoveFileExW((LPCWSTR)from.utf16(), (LPCWSTR)to.utf16(), MOVEFILE_REPLACE_EXISTING);
+#else
+    return ::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0;
+#endif
+}
+
+
+// Flushes the written session files to the disk together
+class FileSyncer {
+public:
+    static FileSyncer *instance()
+    {
+        static FileSyncer *syncer = []() -> FileSyncer * {
+            int interval = Tf::appSettings()->value(Tf::SessionFileSyncInterval).toInt();
+            return (interval > 0) ? new FileSyncer(interval) : nullptr;  // never deleted
+        }();
+        return syncer;
+    }
+
+    // Waits until the file is flushed
+    void sync(const QString &path)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _pending << path;
+        uint64_t round = _started + 1;  // flushed in the next round
+        _cond.wait(lock, [&]() { return _flushed >= round; });
+    }
+
+private:
+    FileSyncer(int interval) :
+        _interval(interval)
+    {
+        std::thread([this]() { run(); }).detach();
+    }
+
+    void run()
+    {
+        for (;;) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(_interval));
+
+            QStringList files;
+            uint64_t round;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                files.swap(_pending);
+                round = ++_started;
+            }
+
+            if (!files.isEmpty()) {
+                flush(files);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _flushed = round;
+            }
+            _cond.notify_all();
         }
+    }
 
-        QByteArray buffer;
-        QDataStream dsbuf(&buffer, QIODevice::WriteOnly);
-        dsbuf << *static_cast<const QVariantMap *>(&session);
-        buffer = Tf::lz4Compress(buffer);  // compress
+    static void flush(const QStringList &files)
+    {
+#if defined(Q_OS_LINUX)
+        // One call for the whole file system
+        int fd = ::open(QFile::encodeName(TSessionFileStore::sessionDirPath()).constData(), O_RDONLY | O_DIRECTORY);
+        if (fd >= 0) {
+            ::syncfs(fd);
+            tf_close(fd);
+        }
+#elif defined(Q_OS_UNIX)
+        for (auto &file : files) {
+            int fd = ::open(QFile::encodeName(file).constData(), O_RDONLY);
+            if (fd >= 0) {
+                ::fsync(fd);
+                tf_close(fd);
+            }
+        }
+#endif
+        tSystemDebug("Flushed session files: {}", files.count());
+    }
 
-        file.resize(0);  // truncate
-        QDataStream ds(&file);
-        ds << buffer;
-        file.close();
+    const int _interval;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    QStringList _pending;
+    uint64_t _started {0};
+    uint64_t _flushed {0};
+};
 
-        res = (ds.status() == QDataStream::Ok);
-        if (!res) {
-            tSystemError("Failed to store session. Must set objects that can be serialized.");
+// Removes at most limit files older than the expire, or all if limit is 0,
+// continuing the iteration
+int removeExpiredFiles(QDirIterator &it, const QDateTime &expire, int limit)
+{
+    int res = 0;
+    while ((limit <= 0 || res < limit) && it.hasNext()) {
+        it.next();
+        if (it.fileInfo().lastModified() < expire && QFile::remove(it.filePath())) {
+            res++;
         }
     }
     return res;
 }
 
+}
+
+
+TSessionFileStore::TSessionFileStore()
+{
+}
+
+
+TSessionFileStore::~TSessionFileStore()
+{
+}
+
+
+bool TSessionFileStore::store(TSession &session)
+{
+    if (!isValidId(session.id())) {
+        tSystemError("Invalid session ID: {}", session.id().data());
+        return false;
+    }
+
+    const uint hash = sessionHash(session.id());
+    const QString dirPath = sessionDirPath() + subdirName(hash) + QLatin1Char('/');
+    const QString filePath = dirPath + QString::fromLatin1(session.id());
+
+    QByteArray buffer;
+    QDataStream dsbuf(&buffer, QIODevice::WriteOnly);
+    dsbuf << *static_cast<const QVariantMap *>(&session);
+    if (dsbuf.status() != QDataStream::Ok) {
+        tSystemError("Failed to store session. Must set objects that can be serialized.");
+        return false;
+    }
+    buffer = Tf::lz4Compress(buffer);  // compress
+
+    // Temporary file unique among processes and threads
+    const QString tmpPath = dirPath + QLatin1Char('.') + QString::fromLatin1(session.id()) + QLatin1Char('.')
+        + QString::number(QCoreApplication::applicationPid()) + QLatin1Char('.') + QString::number(tmpFileCounter++);
+
+    QMutexLocker locker(&writeLocks[(hash / NUM_SUBDIRS) % NUM_LOCK_STRIPES]);  // lock for threads
+    QFile file(tmpPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::NewOnly)) {
+        if (!QDir(dirPath).mkpath(".") || !file.open(QIODevice::WriteOnly | QIODevice::NewOnly)) {
+            tSystemError("Failed to open a session file: {}", tmpPath);
+            return false;
+        }
+    }
+
+    QDataStream ds(&file);
+    ds << buffer;
+    file.close();
+
+    if (ds.status() != QDataStream::Ok || file.error() != QFileDevice::NoError || !replaceFile(tmpPath, filePath)) {
+        tSystemError("Failed to write a session file: {}", filePath);
+        QFile::remove(tmpPath);
+        return false;
+    }
+    locker.unlock();
+
+    auto *syncer = FileSyncer::instance();
+    if (syncer) {
+        syncer->sync(filePath);
+    }
+    return true;
+}
+
 
 TSession TSessionFileStore::find(const QByteArray &id)
 {
-    QFileInfo fi(sessionDirPath() + id);
+    if (!isValidId(id)) {
+        return TSession();
+    }
+
+    QFileInfo fi(sessionFilePath(id));
+    if (!fi.exists()) {
+        fi.setFile(legacyFilePath(id));
+    }
+
     QDateTime modified = QDateTime::currentDateTime().addSecs(-lifeTimeSecs());
 
     if (fi.exists() && fi.lastModified() >= modified) {
-        QReadLocker locker(&rwLock);  // lock for threads
+        // Needs no lock; the file is replaced by renaming
         QFile file(fi.filePath());
 
         if (file.open(QIODevice::ReadOnly)) {
-            auto reslock = tf_lockfile(file.handle(), false, true);  // blocking flock for processes
-            int err = errno;
-            if (reslock < 0) {
-                tSystemWarn("flock error  errno:{}", err);
-            }
-
             QDataStream ds(&file);
             QByteArray buffer;
             ds >> buffer;
@@ -92,6 +283,7 @@ TSession TSessionFileStore::find(const QByteArray &id)
             dsbuf >> *static_cast<QVariantMap *>(&result);
 
             if (ds.status() == QDataStream::Ok) {
+                setStoredDateTime(result, fi.lastModified());
                 return result;
             } else {
                 tSystemError("Failed to load a session from the file store.");
@@ -101,28 +293,62 @@ TSession TSessionFileStore::find(const QByteArray &id)
     return TSession();
 }
 
+/*!
+  Updates the modification time of the session file.
+*/
+bool TSessionFileStore::touch(TSession &session)
+{
+    if (!isValidId(session.id())) {
+        return false;
+    }
+
+    QFile file(sessionFilePath(session.id()));
+    if (file.open(QIODevice::ReadOnly | QIODevice::ExistingOnly)
+        && file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime)) {
+        return true;
+    }
+    return store(session);
+}
+
 
 bool TSessionFileStore::remove(const QByteArray &id)
 {
-    return QFile::remove(sessionDirPath() + id);
+    if (!isValidId(id)) {
+        return false;
+    }
+
+    bool res = QFile::remove(sessionFilePath(id));
+    return QFile::remove(legacyFilePath(id)) || res;
 }
 
 
 int TSessionFileStore::gc(const QDateTime &expire)
 {
-    int res = 0;
-    QDir dir(sessionDirPath());
-    if (dir.exists()) {
-        const QList<QFileInfo> lst = dir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
-        for (auto &fi : lst) {
-            if (fi.lastModified() < expire) {
-                if (dir.remove(fi.fileName())) {
-                    res++;
-                }
-            } else {
-                break;
-            }
-        }
+    return gcBatch(expire, 0);
+}
+
+/*!
+  Removes at most \a limit session files older than the \a expire
+  datetime. If \a limit is 0, removes all of them. The batches of the
+  same \a expire make one pass over the directory; each batch resumes
+  where the last one stopped.
+*/
+int TSessionFileStore::gcBatch(const QDateTime &expire, int limit)
+{
+    if (limit <= 0) {
+        QDirIterator it(sessionDirPath(), QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+        return removeExpiredFiles(it, expire, 0);
+    }
+
+    QMutexLocker locker(&_gcMutex);
+    if (!_gcIterator || expire != _gcExpire) {
+        _gcIterator = std::make_unique<QDirIterator>(sessionDirPath(), QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+        _gcExpire = expire;
+    }
+
+    int res = removeExpiredFiles(*_gcIterator, expire, limit);
+    if (res < limit) {
+        _gcIterator.reset();  // swept to the end
     }
     return res;
 }
@@ -1,15 +1,29 @@
 #pragma once
+#include <QMutex>
 #include <TSessionStore>
+#include <memory>
+
+class QDirIterator;
 
 
 class T_CORE_EXPORT TSessionFileStore : public TSessionStore {
 public:
+    TSessionFileStore();
+    ~TSessionFileStore();
+
     QString key() const { return QStringLiteral("file"); }
     TSession find(const QByteArray &id) override;
     bool store(TSession &session) override;
+    bool touch(TSession &session) override;
     bool remove(const QByteArray &id) override;
     int gc(const QDateTime &expire) override;
+    int gcBatch(const QDateTime &expire, int limit) override;
 
     static QString sessionDirPath();
+
+private:
+    QMutex _gcMutex;
+    std::unique_ptr<QDirIterator> _gcIterator;  // sweep of gcBatch() in progress
+    QDateTime _gcExpire;
 };
 
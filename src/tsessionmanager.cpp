@@ -14,7 +14,26 @@
 #include <QThread>
 #include <TAppSettings>
 #include <TAtomic>
+#include <TDatabaseContext>
+#include <TJobScheduler>
 #include <TSessionStore>
+#include <TWebApplication>
+
+constexpr int GC_BATCH_INTERVAL_MSECS = 10;
+
+namespace {
+
+// Removes expired sessions in batches on a background thread
+class SessionGarbageCollector : public TJobScheduler {
+protected:
+    void job() override
+    {
+        int total = TSessionManager::instance().collectGarbageInBatches(TSessionManager::gcBatchSize());
+        tSystemDebug("Session garbage collector removed {} sessions", total);
+    }
+};
+
+}
 
 
 TSessionManager::TSessionManager()
@@ -35,6 +54,7 @@ TSession TSessionManager::findSession(const QByteArray &id)
         TSessionStore *store = TSessionStoreFactory::create(storeType());
         if (Q_LIKELY(store)) {
             session = store->find(id);
+            session.setStored(session.storedAt);  // not modified
             TSessionStoreFactory::destroy(storeType(), store);
         } else {
             tSystemError("Session store not found: {}", storeType());
@@ -56,12 +76,67 @@ bool TSessionManager::store(TSession &session)
     if (Q_LIKELY(store)) {
         res = store->store(session);
         TSessionStoreFactory::destroy(storeType(), store);
+        if (res) {
+            session.setStored(QDateTime::currentSecsSinceEpoch());
+        }
     } else {
         tSystemError("Session store not found: {}", storeType());
     }
     return res;
 }
 
+/*!
+  Extends the expiry of the unmodified \a session in the session store
+  with a cheaper operation than store().
+*/
+bool TSessionManager::touch(TSession &session)
+{
+    if (session.id().isEmpty()) {
+        return false;
+    }
+
+    bool res = false;
+    TSessionStore *store = TSessionStoreFactory::create(storeType());
+    if (Q_LIKELY(store)) {
+        res = store->touch(session);
+        TSessionStoreFactory::destroy(storeType(), store);
+        if (res) {
+            session.setStored(QDateTime::currentSecsSinceEpoch());
+        }
+    } else {
+        tSystemError("Session store not found: {}", storeType());
+    }
+    return res;
+}
+
+/*!
+  Returns true if the expiry of the unmodified \a session is to be
+  extended by touch(); it is done when a tenth of the session lifetime
+  or the cookie max-age has passed since the session was stored, or on
+  every request if the store does not tell when it was stored.
+*/
+bool TSessionManager::isTouchRequired(const TSession &session) const
+{
+    static const int64_t cookieMaxAge = Tf::appSettings()->value(Tf::SessionCookieMaxAge).toString().trimmed().toLongLong();
+    static const int64_t interval = []() {
+        int64_t lifetime = TSessionStore::lifeTimeSecs();
+        if (cookieMaxAge > 0 && (lifetime <= 0 || cookieMaxAge < lifetime)) {
+            lifetime = cookieMaxAge;
+        }
+        return lifetime / 10;
+    }();
+
+    if (storeType() == QLatin1String("cookie") && cookieMaxAge <= 0) {
+        // The session cookie expires when the browser is closed
+        return false;
+    }
+
+    if (session.storedAt <= 0) {
+        return true;
+    }
+    return QDateTime::currentSecsSinceEpoch() - session.storedAt >= interval;
+}
+
 
 bool TSessionManager::remove(const QByteArray &id)
 {
@@ -112,10 +187,19 @@ QByteArray TSessionManager::generateId()
 }
 
 
+/*!
+  Starts the GC of sessions at the rate set by Session.GcProbability in
+  application.ini; called for each request. Does nothing if the GC runs
+  on the background thread by Session.GcInterval.
+*/
 void TSessionManager::collectGarbage()
 {
     static const int prob = Tf::appSettings()->value(Tf::SessionGcProbability).toInt();
 
+    if (gcInterval() > 0) {
+        return;
+    }
+
     if (prob > 0) {
         int r = Tf::random(0, prob - 1);
         tSystemDebug("Session garbage collector : rand = {}", r);
@@ -135,6 +219,84 @@ void TSessionManager::collectGarbage()
 }
 
 
+/*!
+  Removes the sessions expired by Session.GcMaxLifeTime, at most
+  \a batchSize sessions at a time, until no expired session is left, and
+  returns the number of removed sessions. The transactions of the current
+  thread are committed after each batch to release the locks. If
+  \a batchSize is 0, removes them at once. This is the job of the
+  background GC.
+*/
+int TSessionManager::collectGarbageInBatches(int batchSize)
+{
+    TSessionStore *store = TSessionStoreFactory::create(storeType());
+    if (!store) {
+        tSystemError("Session store not found: {}", storeType());
+        return 0;
+    }
+
+    int gclifetime = Tf::appSettings()->value(Tf::SessionGcMaxLifeTime).toInt();
+    QDateTime expire = QDateTime::currentDateTime().addSecs(-gclifetime);
+    int total = 0;
+
+    for (;;) {
+        int cnt = store->gcBatch(expire, batchSize);
+        auto *context = TDatabaseContext::currentDatabaseContext();
+        if (context) {
+            context->commitTransactions();
+        }
+        if (cnt > 0) {
+            total += cnt;
+        }
+
+        if (batchSize <= 0 || cnt < batchSize) {
+            break;
+        }
+        QThread::msleep(GC_BATCH_INTERVAL_MSECS);
+    }
+    TSessionStoreFactory::destroy(storeType(), store);
+    return total;
+}
+
+/*!
+  Returns the interval in seconds of the background GC of sessions set by
+  Session.GcInterval in application.ini, or 0 if the GC runs in requests.
+*/
+int TSessionManager::gcInterval()
+{
+    static const int interval = qMax(Tf::appSettings()->value(Tf::SessionGcInterval).toInt(), 0);
+    return interval;
+}
+
+/*!
+  Returns the maximum number of sessions removed at a time by the
+  background GC, set by Session.GcBatchSize in application.ini.
+*/
+int TSessionManager::gcBatchSize()
+{
+    static const int batchSize = qMax(Tf::appSettings()->value(Tf::SessionGcBatchSize).toInt(), 0);
+    return batchSize;
+}
+
+/*!
+  Starts the GC of sessions on a background thread at the interval set
+  by Session.GcInterval in application.ini. It runs only in the
+  application server whose ID is 0, so that one process sweeps.
+*/
+void TSessionManager::startGarbageCollector()
+{
+    static SessionGarbageCollector *collector = nullptr;
+
+    if (collector || gcInterval() <= 0 || Tf::app()->applicationServerId() != 0) {
+        return;
+    }
+
+    collector = new SessionGarbageCollector;
+    collector->start(gcInterval() * 1000);
+    tSystemDebug("Session garbage collector started  interval:{}s", gcInterval());
+}
+
+
 TSessionManager &TSessionManager::instance()
 {
     static TSessionManager manager;
@@ -10,14 +10,20 @@ public:
 
     TSession findSession(const QByteArray &id);
     bool store(TSession &session);
+    bool touch(TSession &session);
+    bool isTouchRequired(const TSession &session) const;
     bool remove(const QByteArray &id);
     QString storeType() const;
     QString csrfProtectionKey() const;
     QByteArray generateId();
     void collectGarbage();
+    int collectGarbageInBatches(int batchSize);
+    void startGarbageCollector();
 
     static TSessionManager &instance();
     static int sessionLifeTime();
+    static int gcInterval();
+    static int gcBatchSize();
 
 private:
     T_DISABLE_COPY(TSessionManager)
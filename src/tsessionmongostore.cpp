@@ -76,9 +76,21 @@ TSession TSessionMongoStore::find(const QByteArray &id)
     if (ds.status() != QDataStream::Ok) {
         tSystemError("Failed to load a session from the mongoobject store.");
     }
+    setStoredDateTime(session, so.updatedAt);
     return session;
 }
 
+/*!
+  Updates the updatedAt field of the session.
+*/
+bool TSessionMongoStore::touch(TSession &session)
+{
+    TMongoODMapper<TSessionMongoObject> mapper;
+    TCriteria cri(TSessionMongoObject::SessionId, TMongo::Equal, QString::fromUtf8(session.id()));
+    int cnt = mapper.updateAll(cri, TSessionMongoObject::UpdatedAt, QDateTime::currentDateTime());
+    return (cnt > 0) ? true : store(session);
+}
+
 
 bool TSessionMongoStore::remove(const QByteArray &id)
 {
@@ -8,6 +8,7 @@
 #include "tsessionredisstore.h"
 #include <QByteArray>
 #include <QDataStream>
+#include <QDateTime>
 #include <TAppSettings>
 #include <TRedis>
 #include <TSystemGlobal>
@@ -21,7 +22,8 @@ bool TSessionRedisStore::store(TSession &session)
 {
     QByteArray data;
     QDataStream ds(&data, QIODevice::WriteOnly);
-    ds << *static_cast<const QVariantMap *>(&session);
+    // Followed by the time stored, which older versions ignore
+    ds << *static_cast<const QVariantMap *>(&session) << (qint64)QDateTime::currentSecsSinceEpoch();
     data = Tf::lz4Compress(data);
 
 #ifndef TF_NO_DEBUG
@@ -58,6 +60,11 @@ TSession TSessionRedisStore::find(const QByteArray &id)
     QDataStream ds(data);
     TSession session(id);
     ds >> *static_cast<QVariantMap *>(&session);
+    if (!ds.atEnd()) {
+        qint64 storedAt;
+        ds >> storedAt;
+        setStoredDateTime(session, QDateTime::fromSecsSinceEpoch(storedAt));
+    }
 
     if (ds.status() != QDataStream::Ok) {
         tSystemError("Failed to load a session from the redis store.");
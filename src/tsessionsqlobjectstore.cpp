@@ -101,9 +101,23 @@ TSession TSessionSqlObjectStore::find(const QByteArray &id)
     if (ds.status() != QDataStream::Ok) {
         tSystemError("Failed to load a session from the sqlobject store.");
     }
+    setStoredDateTime(session, so.updated_at);
     return session;
 }
 
+/*!
+  Updates the updated_at column of the session.
+*/
+bool TSessionSqlObjectStore::touch(TSession &session)
+{
+    createSessionTable();
+
+    TSqlORMapper<TSessionObject> mapper;
+    TCriteria cri(TSessionObject::Id, TSql::Equal, session.id());
+    int cnt = mapper.updateAll(cri, TSessionObject::UpdatedAt, QDateTime::currentDateTime());
+    return (cnt > 0) ? true : store(session);
+}
+
 
 bool TSessionSqlObjectStore::remove(const QByteArray &id)
 {
@@ -120,3 +134,26 @@ int TSessionSqlObjectStore::gc(const QDateTime &expire)
     int cnt = mapper.removeAll(cri);
     return cnt;
 }
+
+/*!
+  Removes at most \a limit sessions older than the \a expire datetime
+  with a single DELETE statement, so that the table is not locked for a
+  long time.
+*/
+int TSessionSqlObjectStore::gcBatch(const QDateTime &expire, int limit)
+{
+    if (limit <= 0) {
+        return gc(expire);
+    }
+
+    // The derived table is for MySQL, which rejects LIMIT in an IN subquery
+    const QString table = TSessionObject().tableName();
+    QString sql = QStringLiteral("DELETE FROM %1 WHERE id IN (SELECT id FROM (SELECT id FROM %1 WHERE updated_at < ? LIMIT %2) AS expired)");
+    TSqlQuery query;
+    query.prepare(sql.arg(table).arg(limit));
+    query.addBind(expire);
+    if (!query.exec()) {
+        return 0;
+    }
+    return query.numRowsAffected();
+}
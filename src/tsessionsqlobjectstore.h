@@ -7,7 +7,9 @@ public:
     QString key() const { return "sqlobject"; }
     TSession find(const QByteArray &id) override;
     bool store(TSession &session) override;
+    bool touch(TSession &session) override;
     bool remove(const QByteArray &id) override;
     int gc(const QDateTime &expire) override;
+    int gcBatch(const QDateTime &expire, int limit) override;
 };
 
@@ -19,6 +19,37 @@ int64_t TSessionStore::lifeTimeSecs()
 }
 
 
+/*!
+  Removes at most \a limit sessions older than the \a expire datetime,
+  and returns the number of removed sessions. This implementation ignores
+  the \a limit and calls gc(expire); reimplement it for a store in which
+  a sweep of all the sessions takes long.
+*/
+int TSessionStore::gcBatch(const QDateTime &expire, int)
+{
+    return gc(expire);
+}
+
+/*!
+  Extends the expiry of the \a session in the session store without
+  changing its data. This implementation stores the whole session;
+  reimplement it with a cheaper operation of the store.
+*/
+bool TSessionStore::touch(TSession &session)
+{
+    return store(session);
+}
+
+/*!
+  Sets the date and time when the \a session was last written to the
+  session store, called from reimplementations of find() if the store
+  records it.
+*/
+void TSessionStore::setStoredDateTime(TSession &session, const QDateTime &dateTime)
+{
+    session.storedAt = dateTime.isValid() ? dateTime.toSecsSinceEpoch() : 0;
+}
+
 /*!
   \class TSessionStore
   \brief The TSessionStore is an abstract class that stores HTTP sessions.
@@ -13,7 +13,12 @@ public:
     virtual bool store(TSession &sesion) = 0;
     virtual bool remove(const QByteArray &id) = 0;
     virtual int gc(const QDateTime &expire) = 0;
+    virtual int gcBatch(const QDateTime &expire, int limit);
+    virtual bool touch(TSession &session);
 
     static int64_t lifeTimeSecs();
+
+protected:
+    static void setStoredDateTime(TSession &session, const QDateTime &dateTime);
 };
 
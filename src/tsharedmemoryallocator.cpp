@@ -8,10 +8,15 @@
 #include "tsharedmemoryallocator.h"
 #include "tsharedmemory.h"
 #include "tsystemglobal.h"
+#include <algorithm>
+#include <bit>
 #include <cstring>
 #include <cerrno>
 
 constexpr ushort CHECKDIGITS = 0x08C0;
+constexpr uint64_t LAYOUT_VERSION = 3;
+constexpr int NUM_SIZE_CLASSES = 27;  // power-of-two classes from 32 bytes
+constexpr int MAX_CLASS_SCAN = 16;  // free blocks looked at in the class of the size
 
 namespace Tf {
 
@@ -34,6 +39,8 @@ struct program_break_header_t {
     uintptr_t currentg {0};
     uint64_t checksum {0};
     alloc_table at;
+    uint32_t free_map {0};  // bitmap of the non-empty free lists
+    uintptr_t free_heads[NUM_SIZE_CLASSES] {};  // offsets of the first blocks of the free lists
 
     char *start() { return (char *)this + startg; }
     char *end() { return (char *)this + endg; }
@@ -57,10 +64,36 @@ struct alloc_header_t {
     void set_prev(alloc_header_t *p) { prevg = p ? (uintptr_t)p - (uintptr_t)this : 0; }
 };
 
+// Links of a free list, stored in the data area of a free block
+struct free_links_t {
+    uintptr_t nextg {0};  // offsets from the program break header
+    uintptr_t prevg {0};
+};
+
 } // namespace Tf
 
 const Tf::alloc_header_t INIT_HEADER;
 
+namespace {
+
+// Index of the free list for blocks of the size
+inline int sizeClass(uint size)
+{
+    return std::clamp((int)std::bit_width(size) - 6, 0, NUM_SIZE_CLASSES - 1);
+}
+
+inline Tf::free_links_t *links(Tf::alloc_header_t *block)
+{
+    return (Tf::free_links_t *)(block + 1);
+}
+
+inline uint64_t checksum(uint64_t size)
+{
+    return size * size + LAYOUT_VERSION;
+}
+
+}
+
 
 TSharedMemoryAllocator *TSharedMemoryAllocator::initialize(const QString &name, size_t size)
 {
@@ -142,13 +175,13 @@ void TSharedMemoryAllocator::setbrk(bool initial)
     tSystemDebug("addr = {:#x}", (quint64)_sharedMemory->data());
 
     // Checks checksum
-    uint64_t ck = (uint64_t)_sharedMemory->size() * (uint64_t)_sharedMemory->size();
+    uint64_t ck = _sharedMemory->size() ? checksum(_sharedMemory->size()) : 0;
     if (initial || pb_header->checksum != ck || !ck) {
         // new mmap
         std::memcpy(pb_header, &INIT_PB_HEADER, sizeof(Tf::program_break_header_t));
         pb_header->startg = pb_header->currentg = sizeof(Tf::program_break_header_t);
         pb_header->endg = _sharedMemory->size();
-        pb_header->checksum = (uint64_t)_sharedMemory->size() * (uint64_t)_sharedMemory->size();
+        pb_header->checksum = ck;
     }
     tSystemDebug("checksum = {}", (qint64)pb_header->checksum);
 
@@ -156,6 +189,9 @@ void TSharedMemoryAllocator::setbrk(bool initial)
 }
 
 
+// Finds a free block for the size from the segregated free lists; looks
+// for the best fit among the first blocks in the class of the size, or
+// takes the first block of the smallest larger class
 Tf::alloc_header_t *TSharedMemoryAllocator::free_block(uint size)
 {
     if (!pb_header) {
@@ -163,31 +199,93 @@ Tf::alloc_header_t *TSharedMemoryAllocator::free_block(uint size)
         return nullptr;
     }
 
+    const int cls = sizeClass(size);
     Tf::alloc_header_t *p = nullptr;
-    Tf::alloc_header_t *cur = pb_header->alloc_head();
+    Tf::alloc_header_t *cur = free_head(cls);
 
-    while (cur) {
-        if (cur->freed && cur->size >= size) {
+    for (int i = 0; cur && i < MAX_CLASS_SCAN; ++i) {
+        if (cur->size >= size) {
             if (size >= cur->size * 0.8) {
-                return cur;
+                p = cur;
+                break;
             }
 
             if (!p || cur->size < p->size) {
                 p = cur;
             }
         }
-        cur = cur->next();
+        cur = free_next(cur);
     }
 
-    if (p && p->size - size > sizeof(Tf::alloc_header_t) * 10) {
-        // If free space is more than 240 bytes
-        divide(p, size);
+    if (!p) {
+        // Any block of the larger classes fits
+        uint32_t map = pb_header->free_map & (~0u << (cls + 1));
+        if (!map) {
+            return nullptr;
+        }
+        p = free_head(std::countr_zero(map));
     }
 
+    remove_free(p);
+    if (p->size - size > sizeof(Tf::alloc_header_t) * 10) {
+        // If free space is more than 240 bytes
+        insert_free(divide(p, size));
+    }
     return p;
 }
 
 
+Tf::alloc_header_t *TSharedMemoryAllocator::free_head(int cls) const
+{
+    uintptr_t offset = pb_header->free_heads[cls];
+    return offset ? (Tf::alloc_header_t *)((char *)pb_header + offset) : nullptr;
+}
+
+
+Tf::alloc_header_t *TSharedMemoryAllocator::free_next(Tf::alloc_header_t *block) const
+{
+    uintptr_t offset = links(block)->nextg;
+    return offset ? (Tf::alloc_header_t *)((char *)pb_header + offset) : nullptr;
+}
+
+// Pushes the free block onto the list of its size class
+void TSharedMemoryAllocator::insert_free(Tf::alloc_header_t *block)
+{
+    const int cls = sizeClass(block->size);
+    const uintptr_t offset = (uintptr_t)block - (uintptr_t)pb_header;
+    Tf::alloc_header_t *head = free_head(cls);
+
+    links(block)->prevg = 0;
+    links(block)->nextg = pb_header->free_heads[cls];
+    if (head) {
+        links(head)->prevg = offset;
+    }
+    pb_header->free_heads[cls] = offset;
+    pb_header->free_map |= 1u << cls;
+}
+
+// Unlinks the free block from the list of its size class
+void TSharedMemoryAllocator::remove_free(Tf::alloc_header_t *block)
+{
+    const int cls = sizeClass(block->size);
+    auto *lk = links(block);
+
+    if (lk->prevg) {
+        links((Tf::alloc_header_t *)((char *)pb_header + lk->prevg))->nextg = lk->nextg;
+    } else {
+        pb_header->free_heads[cls] = lk->nextg;
+        if (!lk->nextg) {
+            pb_header->free_map &= ~(1u << cls);
+        }
+    }
+
+    if (lk->nextg) {
+        links((Tf::alloc_header_t *)((char *)pb_header + lk->nextg))->prevg = lk->prevg;
+    }
+    lk->nextg = lk->prevg = 0;
+}
+
+
 uint TSharedMemoryAllocator::allocSize(const void *ptr) const
 {
     if (!pb_header || !ptr) {
@@ -210,6 +308,32 @@ uint TSharedMemoryAllocator::allocSize(const void *ptr) const
 }
 
 
+/*!
+  Returns the size of the block allocated at \a ptr, or 0 if \a ptr does
+  not point to an allocated block within the data segment. Unlike
+  allocSize(), it does not assert and is used for reading without the
+  lock, where \a ptr can be stale.
+*/
+uint TSharedMemoryAllocator::peekAllocSize(const void *ptr) const
+{
+    if (!pb_header || !ptr || (uintptr_t)ptr % alignof(Tf::alloc_header_t)) {
+        return 0;
+    }
+
+    const char *current = pb_header->current();
+    if (ptr < pb_header->start() + sizeof(Tf::alloc_header_t) || ptr >= current) {
+        return 0;
+    }
+
+    const Tf::alloc_header_t *header = (const Tf::alloc_header_t *)ptr - 1;
+    uint size = header->size;
+    if (header->rsv != CHECKDIGITS || header->freed || size > (uintptr_t)(current - (const char *)ptr)) {
+        return 0;
+    }
+    return size;
+}
+
+
 Tf::alloc_header_t *TSharedMemoryAllocator::divide(Tf::alloc_header_t *block, uint size)
 {
     uint d = size % 32;
@@ -276,21 +400,28 @@ void TSharedMemoryAllocator::free(void *ptr)
         if (!header->freed) {
             header->freed = 1;
             pb_header->at.used -= sizeof(Tf::alloc_header_t) + header->size;
+        } else if (header != pb_header->alloc_tail()) {
+            Q_ASSERT(0);  // freed already
+            return;
         }
 
         if (header != pb_header->alloc_tail()) {
-            // next block
+            // Coalesces with the neighbors linked by the headers, which
+            // serve as boundary tags
             Tf::alloc_header_t *p = header->next();
             if (p->freed) {
+                remove_free(p);
                 merge(header, p);
             }
 
             // prev block
             p = header->prev();
             if (p && p->freed) {
-                merge(p, header);
+                remove_free(p);
+                header = merge(p, header);
             }
 
+            insert_free(header);
             break;
         }
 
@@ -311,6 +442,7 @@ void TSharedMemoryAllocator::free(void *ptr)
         if (!prev || !prev->freed) {
             break;
         }
+        remove_free(prev);
         ptr = prev + 1;
     }
 }
@@ -428,6 +560,16 @@ void TSharedMemoryAllocator::summary() const
 
     tSystemDebug("-- memory block summary --");
     tSystemDebug("table info: blocks = {}, free = {}, used = {}", countBlocks(), countFreeBlocks(), (quint64)pb_header->at.used);
+
+    for (int cls = 0; cls < NUM_SIZE_CLASSES; ++cls) {
+        int count = 0;
+        for (auto *cur = free_head(cls); cur; cur = free_next(cur)) {
+            count++;
+        }
+        if (count > 0) {
+            tSystemDebug("free list: size >= {}, blocks = {}", 32ULL << cls, count);
+        }
+    }
 }
 
 // Debug function to print the entire link list
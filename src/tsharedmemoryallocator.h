@@ -18,6 +18,7 @@ public:
     void *realloc(void *ptr, uint size);
     void free(void *ptr);
     uint allocSize(const void *ptr) const;
+    uint peekAllocSize(const void *ptr) const;
     size_t mapSize() const;
     void *origin() const { return (void *)_origin; }
     bool lockForRead();
@@ -41,6 +42,10 @@ private:
     char *sbrk(int64_t inc);
     void setbrk(bool initial = false);
     Tf::alloc_header_t *free_block(uint size);
+    Tf::alloc_header_t *free_head(int cls) const;
+    Tf::alloc_header_t *free_next(Tf::alloc_header_t *block) const;
+    void insert_free(Tf::alloc_header_t *block);
+    void remove_free(Tf::alloc_header_t *block);
 
     static Tf::alloc_header_t *merge(Tf::alloc_header_t *block, Tf::alloc_header_t *next);
     static Tf::alloc_header_t *divide(Tf::alloc_header_t *block, uint size);
@@ -10,16 +10,22 @@
 #include <TActionContext>
 #include <TSystemGlobal>
 #include <QDataStream>
+#include <QtEndian>
+#include <atomic>
 #include <cstring>
 
 
 const void *FREE = (void *)-1;
+constexpr int MAX_READ_RETRIES = 4;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "needs lock-free atomics in the shared memory");
 
 struct hash_header_t {
     uintptr_t hashtg {0};
     uint tableSize {1024};
     uint count {0};
     uint freeCount {0};
+    std::atomic<uint64_t> sequence {0};  // odd while written
 
     uintptr_t *hashg() { return hashtg ? (uintptr_t *)((uintptr_t)this + hashtg) : nullptr; }
 
@@ -49,10 +55,61 @@ struct hash_header_t {
     }
 };
 
+namespace {
+
+// Runs the lock-free read \a func and returns true if no writer has
+// modified the table meanwhile; the result of the read is discarded
+// otherwise and the caller reads again with the lock
+template <class Function>
+bool readOptimistically(const hash_header_t *h, Function func)
+{
+    for (int i = 0; i < MAX_READ_RETRIES; i++) {
+        uint64_t seq = h->sequence.load(std::memory_order_acquire);
+        if (seq & 1) {
+            break;  // being written, waits for the lock
+        }
+
+        bool ok = func();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (h->sequence.load(std::memory_order_relaxed) == seq) {
+            return ok;
+        }
+    }
+    return false;
+}
+
+// Reads a byte array written by QDataStream, checking the bounds
+bool readByteArray(const char *&ptr, const char *end, const char *&data, uint &length)
+{
+    if (end - ptr < (qsizetype)sizeof(quint32)) {
+        return false;
+    }
+
+    length = qFromBigEndian<quint32>(ptr);
+    ptr += sizeof(quint32);
+    if (length == 0xFFFFFFFF) {  // null
+        length = 0;
+    } else if (length > (quint64)(end - ptr)) {
+        return false;  // includes the extended length of Qt 6.7
+    }
+
+    data = ptr;
+    ptr += length;
+    return true;
+}
+
+}
+
 /*!
   \class TSharedMemoryKvs
   \brief The TSharedMemoryKvs class provides a means of operating a in-memory
   KVS built in the server process.
+
+  Writers lock the shared memory segment, and make the sequence number in
+  the header odd while they modify the table. Readers look up the keys
+  without the lock and accept the result only if the sequence number was
+  even and unchanged; they fall back to the lock for reading if a writer
+  intervenes.
 */
 
 
@@ -114,13 +171,79 @@ bool TSharedMemoryKvs::set(const QByteArray &key, const QByteArray &value, int s
         return false;
     }
 
+    QByteArray data = serialize(key, value, seconds);
+    lockForWrite();  // lock
+    bool ret = setBucket(key, data);
+    unlock();  // unlock
+    return ret;
+}
+
+/*!
+  Sets the keys of the \a items to hold the values and set them to
+  timeout after a given number of \a seconds, in one critical section.
+  Returns the number of items set.
+ */
+int TSharedMemoryKvs::set(const QMap<QByteArray, QByteArray> &items, int seconds)
+{
+    if (seconds <= 0) {
+        return 0;
+    }
+
+    QList<QByteArray> datas;
+    datas.reserve(items.count());
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+        datas << serialize(it.key(), it.value(), seconds);
+    }
+
+    int cnt = 0;
+    int i = 0;
+    lockForWrite();  // lock
+    for (auto it = items.constBegin(); it != items.constEnd(); ++it, ++i) {
+        if (!it.key().isEmpty() && setBucket(it.key(), datas[i])) {
+            cnt++;
+        }
+    }
+    unlock();  // unlock
+    return cnt;
+}
+
+
+/*!
+  Sets the \a key to hold the \a value only if the key does not exist or
+  has expired. Returns true if set.
+ */
+bool TSharedMemoryKvs::add(const QByteArray &key, const QByteArray &value, int seconds)
+{
+    if (key.isEmpty() || seconds <= 0) {
+        return false;
+    }
+
+    QByteArray data = serialize(key, value, seconds);
+    Bucket bucket;
+    bool ret = false;
+
+    lockForWrite();  // lock
+    uint idx = find(key, bucket);
+    if (idx >= tableSize() || bucket.isExpired()) {
+        ret = setBucket(key, data);
+    }
+    unlock();  // unlock
+    return ret;
+}
+
+
+QByteArray TSharedMemoryKvs::serialize(const QByteArray &key, const QByteArray &value, int seconds)
+{
     QByteArray data;
     QDataStream ds(&data, QIODevice::WriteOnly);
-    int64_t expires = Tf::getMSecsSinceEpoch() + seconds * 1000;
+    int64_t expires = Tf::getMSecsSinceEpoch() + seconds * 1000LL;
     ds << Bucket{key, value, expires};
+    return data;
+}
 
-    lockForWrite();  // lock
-
+// Stores the serialized bucket, with the lock for writing held
+bool TSharedMemoryKvs::setBucket(const QByteArray &key, const QByteArray &data)
+{
     Bucket bucket;
     QByteArray buf;
     uint idx = index(key);
@@ -174,7 +297,6 @@ bool TSharedMemoryKvs::set(const QByteArray &key, const QByteArray &value, int s
         break;
     }
 
-    unlock();  // unlock
     return ret;
 }
 
@@ -240,6 +362,61 @@ bool TSharedMemoryKvs::find(uint index, Bucket &bucket) const
     return true;
 }
 
+// Looks up the key without the lock. The table and the buckets can be
+// modified by a writer meanwhile, so every offset and length read is
+// checked before being followed; returns false if any is inconsistent.
+bool TSharedMemoryKvs::peek(const QByteArray &key, Bucket &bucket, bool &found) const
+{
+    found = false;
+    if (key.isEmpty()) {
+        return true;
+    }
+
+    const uint tsize = _h->tableSize;
+    const uintptr_t *table = _h->hashg();
+    if (tsize == 0 || driver()->peekAllocSize(table) < tsize * sizeof(uintptr_t)) {
+        return false;
+    }
+
+    uint idx = qHash(key) % tsize;
+    for (uint i = 0; i < tsize; i++) {
+        uintptr_t g = table[idx];
+        if (!g) {
+            return true;  // not found
+        }
+
+        if (g != (uintptr_t)-1) {
+            const char *ptr = (const char *)_h + g;
+            uint alcsize = driver()->peekAllocSize(ptr);
+            if (alcsize == 0) {
+                return false;
+            }
+
+            const char *end = ptr + alcsize;
+            const char *keyData;
+            uint keyLength;
+            if (!readByteArray(ptr, end, keyData, keyLength)) {
+                return false;
+            }
+
+            if (keyLength == (uint)key.length() && std::memcmp(keyData, key.constData(), keyLength) == 0) {
+                const char *valueData;
+                uint valueLength;
+                if (!readByteArray(ptr, end, valueData, valueLength) || end - ptr < (qsizetype)sizeof(qint64)) {
+                    return false;
+                }
+                bucket.key = key;
+                bucket.value = QByteArray(valueData, valueLength);
+                bucket.expires = qFromBigEndian<qint64>(ptr);
+                found = true;
+                return true;
+            }
+        }
+        idx = (idx + 1) % tsize;
+    }
+    return true;
+}
+
 /*!
   Returns the value associated with the \a key; otherwise
   returns an empty byte array.
@@ -247,10 +424,52 @@ bool TSharedMemoryKvs::find(uint index, Bucket &bucket) const
 QByteArray TSharedMemoryKvs::get(const QByteArray &key)
 {
     Bucket bucket;
-    lockForRead();  // lock
-    uint idx = find(key, bucket);
-    unlock();  // unlock
-    return (idx < tableSize() && bucket.expires > Tf::getMSecsSinceEpoch()) ? bucket.value : QByteArray();
+    bool found = false;
+
+    if (!readOptimistically(_h, [&]() { return peek(key, bucket, found); })) {
+        lockForRead();  // lock
+        found = (find(key, bucket) < tableSize());
+        unlock();  // unlock
+    }
+    return (found && bucket.expires > Tf::getMSecsSinceEpoch()) ? bucket.value : QByteArray();
+}
+
+/*!
+  Returns the values associated with the \a keys, looked up in one
+  critical section. The keys not found are not contained.
+ */
+QMap<QByteArray, QByteArray> TSharedMemoryKvs::get(const QByteArrayList &keys)
+{
+    QMap<QByteArray, QByteArray> values;
+    Bucket bucket;
+    const int64_t current = Tf::getMSecsSinceEpoch();
+
+    auto lookup = [&]() {
+        values.clear();
+        for (auto &key : keys) {
+            bool found = false;
+            if (!peek(key, bucket, found)) {
+                return false;
+            }
+            if (found && bucket.expires > current) {
+                values.insert(key, bucket.value);
+            }
+        }
+        return true;
+    };
+
+    if (!readOptimistically(_h, lookup)) {
+        values.clear();
+        lockForRead();  // lock
+        for (auto &key : keys) {
+            uint idx = find(key, bucket);
+            if (idx < tableSize() && bucket.expires > current) {
+                values.insert(key, bucket.value);
+            }
+        }
+        unlock();  // unlock
+    }
+    return values;
 }
 
 /*!
@@ -267,6 +486,27 @@ bool TSharedMemoryKvs::remove(const QByteArray &key)
     return (idx < tableSize());
 }
 
+/*!
+  Removes the specified \a keys in one critical section. Returns the
+  number of items removed.
+ */
+int TSharedMemoryKvs::remove(const QByteArrayList &keys)
+{
+    int cnt = 0;
+    Bucket bucket;
+
+    lockForWrite();  // lock
+    for (auto &key : keys) {
+        uint idx = find(key, bucket);
+        if (idx < tableSize()) {
+            remove(idx);
+            cnt++;
+        }
+    }
+    unlock();  // unlock
+    return cnt;
+}
+
 
 void TSharedMemoryKvs::remove(uint index)
 {
@@ -417,7 +657,14 @@ bool TSharedMemoryKvs::lockForRead()
 */
 bool TSharedMemoryKvs::lockForWrite()
 {
-    return driver()->lockForWrite();
+    bool ret = driver()->lockForWrite();
+    // Makes the sequence number odd; it is odd already if the previous
+    // writer has died holding the lock
+    uint64_t seq = _h->sequence.load(std::memory_order_relaxed);
+    _h->sequence.store(seq + ((seq & 1) ? 2 : 1), std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _writeLocked = true;
+    return ret;
 }
 
 /*!
@@ -425,6 +672,10 @@ bool TSharedMemoryKvs::lockForWrite()
 */
 bool TSharedMemoryKvs::unlock()
 {
+    if (_writeLocked) {
+        _h->sequence.fetch_add(1, std::memory_order_release);  // even
+        _writeLocked = false;
+    }
     return driver()->unlock();
 }
 
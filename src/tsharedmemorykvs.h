@@ -1,5 +1,6 @@
 #pragma once
 #include <QByteArray>
+#include <QMap>
 #include <QStringList>
 #include <TGlobal>
 #include <TKvsDatabase>
@@ -68,8 +69,12 @@ public:
     ~TSharedMemoryKvs();
 
     QByteArray get(const QByteArray &key);
+    QMap<QByteArray, QByteArray> get(const QByteArrayList &keys);
     bool set(const QByteArray &key, const QByteArray &value, int seconds);
+    int set(const QMap<QByteArray, QByteArray> &items, int seconds);
+    bool add(const QByteArray &key, const QByteArray &value, int seconds);
     bool remove(const QByteArray &key);
+    int remove(const QByteArrayList &keys);
     uint count() const;
     uint tableSize() const;
     void clear();
@@ -89,10 +94,13 @@ public:
 protected:
     uint find(const QByteArray &key, Bucket &bucket) const;
     bool find(uint index, Bucket &bucket) const;
+    bool peek(const QByteArray &key, Bucket &bucket, bool &found) const;
     int searchIndex(int first);
     uint index(const QByteArray &key) const;
     uint next(uint index) const;
     void remove(uint index);
+    bool setBucket(const QByteArray &key, const QByteArray &data);
+    static QByteArray serialize(const QByteArray &key, const QByteArray &value, int seconds);
 
 
 private:
@@ -102,6 +110,7 @@ private:
 
     TKvsDatabase::Handle &_database;
     hash_header_t *_h {nullptr};
+    bool _writeLocked {false};
 
     friend class TCacheSharedMemoryStore;
     T_DISABLE_COPY(TSharedMemoryKvs)
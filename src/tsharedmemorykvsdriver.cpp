@@ -122,6 +122,12 @@ uint TSharedMemoryKvsDriver::allocSize(const void *ptr) const
 }
 
 
+uint TSharedMemoryKvsDriver::peekAllocSize(const void *ptr) const
+{
+    return _allocator ? _allocator->peekAllocSize(ptr) : 0;
+}
+
+
 size_t TSharedMemoryKvsDriver::mapSize() const
 {
     return _allocator ? _allocator->mapSize() : 0;
@@ -24,6 +24,7 @@ public:
     void *realloc(void *ptr, uint size);
     void free(void *ptr);
     uint allocSize(const void *ptr) const;
+    uint peekAllocSize(const void *ptr) const;
     size_t mapSize() const;
     void *origin() const;
 
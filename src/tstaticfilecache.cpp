@@ -0,0 +1,325 @@
+/* Copyright (c) 2026, AOYAMA Kazuharu
+ * All rights reserved.
+ *
+ * This software may be used and distributed according to the terms of
+ * the New BSD License, which is incorporated herein by reference.
+ */
+
+#include "tstaticfilecache.h"
+#include "tsystemglobal.h"
+#include <QFile>
+#include <QFileInfo>
+#include <TAppSettings>
+#include <thread>
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+/*!
+  \class TStaticFileCache
+  \brief The TStaticFileCache class keeps small, frequently requested
+  static files of the public directory in memory together with their
+  precomputed response header fields.
+
+  A cache hit is answered without touching the file system. The entries
+  are invalidated through inotify when the files are modified, so the
+  cache is available only on Linux. A file failed to be cached is
+  remembered until it is modified, so that it is not read again on
+  every request.
+*/
+
+constexpr int MAX_REJECTION_COUNT = 4096;
+
+TStaticFileCache::TStaticFileCache()
+{
+#ifdef Q_OS_LINUX
+    _inotifyFd = ::inotify_init1(IN_CLOEXEC);
+    if (_inotifyFd < 0) {
+        tSystemError("inotify_init1 failed  errno:{}", errno);
+        return;
+    }
+
+    std::thread([this]() {
+        watchEvents();
+    }).detach();
+#endif
+}
+
+/*!
+  Returns a global TStaticFileCache object.
+*/
+TStaticFileCache &TStaticFileCache::instance()
+{
+    // Never destroyed; the watcher thread refers to it until the process exits
+    static TStaticFileCache *cache = new TStaticFileCache;
+    return *cache;
+}
+
+/*!
+  Returns true if the static file cache is enabled by the setting
+  StaticFileCache.Enable; otherwise returns false.
+*/
+bool TStaticFileCache::isEnabled()
+{
+#ifdef Q_OS_LINUX
+    static const bool enable = Tf::appSettings()->value(Tf::StaticFileCacheEnable).toBool();
+    return enable;
+#else
+    return false;  // requires inotify
+#endif
+}
+
+/*!
+  Returns the maximum size of a file to be cached.
+*/
+int64_t TStaticFileCache::maxFileSize()
+{
+    static const int64_t size = Tf::appSettings()->value(Tf::StaticFileCacheMaxFileSize).toLongLong();
+    return size;
+}
+
+/*!
+  Returns the entry for the request path \a path, or a null pointer if
+  it is not cached.
+*/
+std::shared_ptr<const TStaticFileCache::Entry> TStaticFileCache::find(const QByteArray &path)
+{
+    QReadLocker locker(&_lock);
+    auto it = _entries.constFind(path);
+    if (it == _entries.constEnd()) {
+        return nullptr;
+    }
+
+    QMutexLocker lruLocker(&_lruMutex);
+    _lruList.splice(_lruList.begin(), _lruList, it->lruPos);  // most recently used
+    return it->entry;
+}
+
+/*!
+  Inserts the \a entry for the request path \a path, evicting the least
+  recently used entries if the total size exceeds the setting
+  StaticFileCache.MaxTotalSize. Returns true if the entry is cached;
+  otherwise returns false.
+*/
+bool TStaticFileCache::insert(const QByteArray &path, const std::shared_ptr<Entry> &entry)
+{
+    static const int64_t maxTotalSize = Tf::appSettings()->value(Tf::StaticFileCacheMaxTotalSize).toLongLong();
+
+    if (!isEnabled() || !entry) {
+        return false;
+    }
+
+    QWriteLocker locker(&_lock);
+
+    if (entry->size() > maxTotalSize || !watch(QFileInfo(entry->filePath).absolutePath())) {
+        reject(path, *entry);
+        return false;
+    }
+
+    // Verifies that the file has not been changed before the watch started
+    QFileInfo fi(entry->filePath);
+    if (fi.size() != entry->fileSize || fi.lastModified().toMSecsSinceEpoch() != entry->lastModifiedMSecs) {
+        return false;
+    }
+
+    removeEntry(path);
+
+    while (_totalSize + entry->size() > maxTotalSize && !_lruList.empty()) {
+        // Evicts the least recently used one
+        tSystemDebug("Static file cache evicts: {}", _lruList.back().data());
+        removeEntry(_lruList.back());
+    }
+
+    _lruList.push_front(path);
+    _entries.insert(path, Slot {entry, _lruList.begin()});
+    _fileKeys.insert(entry->filePath, path);
+    if (!entry->gzipFilePath.isEmpty()) {
+        _fileKeys.insert(entry->gzipFilePath, path);
+    }
+    _rejections.remove(path);
+    _totalSize += entry->size();
+    tSystemDebug("Static file cached: {}  total:{}", path.data(), _totalSize);
+    return true;
+}
+
+/*!
+  Returns true if the file of the request path \a path failed to be
+  cached and has not been modified since; the file of \a fileSize bytes
+  was last modified at \a lastModifiedMSecs.
+*/
+bool TStaticFileCache::isRejected(const QByteArray &path, int64_t fileSize, int64_t lastModifiedMSecs) const
+{
+    QReadLocker locker(&_lock);
+    auto it = _rejections.constFind(path);
+    return it != _rejections.constEnd() && it->fileSize == fileSize && it->lastModifiedMSecs == lastModifiedMSecs;
+}
+
+/*!
+  Removes the entries of the file \a filePath.
+*/
+void TStaticFileCache::invalidate(const QString &filePath)
+{
+    QWriteLocker locker(&_lock);
+    const QList<QByteArray> keys = _fileKeys.values(filePath);
+    for (auto &key : keys) {
+        tSystemDebug("Static file cache invalidated: {}", key.data());
+        removeEntry(key);
+    }
+}
+
+/*!
+  Removes all the entries.
+*/
+void TStaticFileCache::clear()
+{
+    QWriteLocker locker(&_lock);
+    _entries.clear();
+    _lruList.clear();
+    _fileKeys.clear();
+    _rejections.clear();
+    _totalSize = 0;
+}
+
+/*!
+  Returns the number of the entries.
+*/
+int TStaticFileCache::count() const
+{
+    QReadLocker locker(&_lock);
+    return _entries.count();
+}
+
+/*!
+  Returns the total size of the bodies cached.
+*/
+int64_t TStaticFileCache::totalSize() const
+{
+    QReadLocker locker(&_lock);
+    return _totalSize;
+}
+
+// Must be called with the write lock held
+void TStaticFileCache::removeEntry(const QByteArray &path)
+{
+    auto it = _entries.find(path);
+    if (it == _entries.end()) {
+        return;
+    }
+
+    auto entry = it->entry;
+    _lruList.erase(it->lruPos);
+    _entries.erase(it);
+    _fileKeys.remove(entry->filePath, path);
+    if (!entry->gzipFilePath.isEmpty()) {
+        _fileKeys.remove(entry->gzipFilePath, path);
+    }
+    _totalSize -= entry->size();
+}
+
+// Must be called with the write lock held
+void TStaticFileCache::reject(const QByteArray &path, const Entry &entry)
+{
+    if (_rejections.count() >= MAX_REJECTION_COUNT) {
+        _rejections.clear();
+    }
+    _rejections.insert(path, Rejection {entry.fileSize, entry.lastModifiedMSecs});
+}
+
+// Must be called with the write lock held
+bool TStaticFileCache::watch(const QString &dirPath)
+{
+#ifdef Q_OS_LINUX
+    if (_inotifyFd < 0) {
+        return false;
+    }
+
+    if (_watchDirs.key(dirPath, -1) >= 0) {
+        return true;
+    }
+
+    constexpr uint32_t mask = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+    int wd = ::inotify_add_watch(_inotifyFd, QFile::encodeName(dirPath).constData(), mask);
+    if (wd < 0) {
+        tSystemWarn("inotify_add_watch failed: {}  errno:{}", dirPath, errno);
+        return false;
+    }
+    _watchDirs.insert(wd, dirPath);
+    return true;
+#else
+    Q_UNUSED(dirPath);
+    return false;
+#endif
+}
+
+
+void TStaticFileCache::watchEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(struct inotify_event) char buf[8192];
+
+    for (;;) {
+        ssize_t len = ::read(_inotifyFd, buf, sizeof(buf));
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            tSystemError("inotify read error  errno:{}", errno);
+            break;
+        }
+
+        for (char *p = buf; p < buf + len;) {
+            auto *event = reinterpret_cast<struct inotify_event *>(p);
+            p += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events were lost
+                clear();
+                continue;
+            }
+
+            if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT)) {
+                // The directory is gone
+                QWriteLocker locker(&_lock);
+                QString dir = _watchDirs.take(event->wd);
+                if (!dir.isEmpty()) {
+                    ::inotify_rm_watch(_inotifyFd, event->wd);
+                    const auto keys = _entries.keys();
+                    for (auto &key : keys) {
+                        if (_entries.value(key).entry->filePath.startsWith(dir + QLatin1Char('/'))) {
+                            removeEntry(key);
+                        }
+                    }
+                }
+                continue;
+            }
+
+            if (event->len > 0) {
+                QString dir;
+                {
+                    QReadLocker locker(&_lock);
+                    dir = _watchDirs.value(event->wd);
+                }
+                if (!dir.isEmpty()) {
+                    QString filePath = dir + QLatin1Char('/') + QFile::decodeName(event->name);
+                    invalidate(filePath);
+                    if (filePath.endsWith(QLatin1String(".gz"))) {
+                        // A precompressed file is created or modified
+                        invalidate(filePath.chopped(3));
+                    }
+                }
+            }
+        }
+    }
+
+    // Entries can not be invalidated any more
+    QWriteLocker locker(&_lock);
+    _entries.clear();
+    _lruList.clear();
+    _fileKeys.clear();
+    _watchDirs.clear();
+    _totalSize = 0;
+    ::close(_inotifyFd);
+    _inotifyFd = -1;
+#endif
+}
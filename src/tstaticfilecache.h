@@ -0,0 +1,79 @@
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QMultiHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QString>
+#include <TGlobal>
+#include <list>
+#include <memory>
+
+
+class T_CORE_EXPORT TStaticFileCache {
+public:
+    class Representation {
+    public:
+        QByteArray etag;
+        QByteArray lastModified;  // HTTP-date
+        QByteArray header;  // status line and header fields of 200 response, except Date and Connection
+        QByteArray notModifiedHeader;  // same as above of 304 response
+        QByteArray body;
+    };
+
+    class Entry {
+    public:
+        QString filePath;
+        QString gzipFilePath;  // precompressed file, if any
+        int64_t fileSize {0};
+        int64_t lastModifiedMSecs {0};
+        Representation identity;
+        Representation gzip;  // empty body if no compressed variant
+
+        int64_t size() const { return identity.body.size() + gzip.body.size(); }
+    };
+
+    static TStaticFileCache &instance();
+    static bool isEnabled();
+    static int64_t maxFileSize();
+
+    std::shared_ptr<const Entry> find(const QByteArray &path);
+    bool insert(const QByteArray &path, const std::shared_ptr<Entry> &entry);
+    bool isRejected(const QByteArray &path, int64_t fileSize, int64_t lastModifiedMSecs) const;
+    void invalidate(const QString &filePath);
+    void clear();
+    int count() const;
+    int64_t totalSize() const;
+
+private:
+    class Slot {
+    public:
+        std::shared_ptr<Entry> entry;
+        std::list<QByteArray>::iterator lruPos;
+    };
+
+    class Rejection {
+    public:
+        int64_t fileSize {0};
+        int64_t lastModifiedMSecs {0};
+    };
+
+    TStaticFileCache();
+    bool watch(const QString &dirPath);
+    void removeEntry(const QByteArray &path);
+    void reject(const QByteArray &path, const Entry &entry);
+    void watchEvents();
+
+    mutable QReadWriteLock _lock;
+    QHash<QByteArray, Slot> _entries;
+    std::list<QByteArray> _lruList;  // request paths, most recently used first
+    QMutex _lruMutex;  // guards _lruList with the read lock held
+    QMultiHash<QString, QByteArray> _fileKeys;  // file path to request paths
+    QHash<QByteArray, Rejection> _rejections;  // files failed to be cached
+    QHash<int, QString> _watchDirs;  // watch descriptor to directory path
+    int64_t _totalSize {0};
+    int _inotifyFd {-1};
+
+    T_DISABLE_COPY(TStaticFileCache)
+    T_DISABLE_MOVE(TStaticFileCache)
+};
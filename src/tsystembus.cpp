@@ -90,10 +90,36 @@ QList<TSystemBusMessage> TSystemBus::recvAll()
 void TSystemBus::readBus()
 {
     bool ready = false;
+    QByteArrayList invalidatedKeys;
     {
         QMutexLocker locker(&mutexRead);
         readBuffer += busSocket->readAll();
 
+        // Takes out the cache invalidations, which are not received by recvAll()
+        QByteArray rest;
+        for (;;) {
+            QDataStream ds(readBuffer);
+            ds.setByteOrder(QDataStream::BigEndian);
+            uint8_t opcode;
+            uint32_t length;
+            ds >> opcode >> length;
+
+            if ((uint)readBuffer.length() < HEADER_LEN || (uint)readBuffer.length() < length + HEADER_LEN) {
+                break;
+            }
+
+            if ((opcode & 0x3F) == Tf::CacheInvalidate) {
+                auto message = TSystemBusMessage::parse(readBuffer);
+                if (message.isValid()) {
+                    invalidatedKeys << message.data();
+                }
+            } else {
+                rest += readBuffer.left(length + HEADER_LEN);
+                readBuffer.remove(0, length + HEADER_LEN);
+            }
+        }
+        readBuffer.prepend(rest);
+
         QDataStream ds(readBuffer);
         ds.setByteOrder(QDataStream::BigEndian);
         uint8_t opcode;
@@ -103,6 +129,10 @@ void TSystemBus::readBus()
         ready = ((uint)readBuffer.length() >= length + HEADER_LEN);
     }
 
+    for (auto &key : invalidatedKeys) {
+        emit cacheInvalidated(key);
+    }
+
     if (ready) {
         emit readyReceive();
     }
@@ -25,6 +25,7 @@ public:
 
 signals:
     void readyReceive();
+    void cacheInvalidated(const QByteArray &key);
     void disconnected();
 
 protected slots:
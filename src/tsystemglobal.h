@@ -48,7 +48,8 @@ enum SystemOpCode {
     WebSocketSendBinary = 0x02,
     WebSocketPublishText = 0x03,
     WebSocketPublishBinary = 0x04,
-    MaxOpCode = 0x04,
+    CacheInvalidate = 0x05,
+    MaxOpCode = 0x05,
 };
 
 T_CORE_EXPORT QMap<QString, QVariant> settingsToMap(QSettings &settings, const QString &env = QString());
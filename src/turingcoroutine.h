@@ -1,4 +1,5 @@
 #pragma once
+#include "trangefile.h"
 
 class TUringTask;
 
@@ -15,4 +16,6 @@ private:
     int _sd {0};
     QByteArray _response;
     QString _fileName;
+    QList<TRangeFile::Range> _fileRanges;
+    QByteArray _fileEpilogue;
 };
@@ -71,8 +71,8 @@ private:
 
 class AsyncSendFile : public TAwaitBase {
 public:
-    AsyncSendFile(int sd, int fd, int fileSize) :
-        _sd(sd), _fd(fd), _fileSize(fileSize)
+    AsyncSendFile(int sd, int fd, int64_t offset, int64_t length) :
+        _sd(sd), _fd(fd), _start(offset), _end(offset + length), _offset(offset)
     {
         if (::pipe2(_pipefd, O_CLOEXEC) < 0) {
             tSystemError("pipe error: {}", strerror(errno));
@@ -99,7 +99,7 @@ public:
     inline int await_resume()
     {
         //tSystemInfo("AsyncSendFile::await_resume : _offset:{} _cqeflags:{} _cqeres:{}", _offset, _cqeflags, _cqeres);
-        return (_cqeres < 0) ? _cqeres : _offset;
+        return (_cqeres < 0) ? _cqeres : _offset - _start;
     }
 
     bool completed() const override
@@ -108,7 +108,7 @@ public:
         switch (_state) {
         case State::WaitForPollOut:
             if (_cqeres == POLLOUT) {
-                return (_offset + _cqeres >= _fileSize);
+                return (_offset + _cqeres >= _end);
             } else {
                 // POLLERR or POLLHUP
                 return true;
@@ -140,7 +140,7 @@ public:
             [[fallthrough]];
 
         case State::Idle: {
-            size_t len = std::min<size_t>(SPLICE_LEN, _fileSize - _offset);
+            size_t len = std::min<size_t>(SPLICE_LEN, _end - _offset);
             int res = TUringServer::instance()->addSendFile(_sd, _fd, _offset, len, _pipefd, this);
             if (res < 0) {
                 tSystemError("addSend error: {}", strerror(errno));
@@ -155,7 +155,7 @@ public:
                 _offset += _cqeres;
                 _cqeres = 0;
 
-                if (_offset >= _fileSize) {
+                if (_offset >= _end) {
                     return;
                 }
             }
@@ -183,7 +183,8 @@ private:
 
     int _sd {0};
     int _fd {0};
-    size_t _fileSize {0};
+    size_t _start {0};
+    size_t _end {0};
     size_t _offset {0};
     int _pipefd[2] {0};
     State _state {State::Idle};
@@ -219,7 +220,7 @@ TUringTask TUringCoroutine::start()
         TUringServer::instance()->registerForGC(this);
     });
 
-    TActionContextRoutine routine;
+    TActionContextRoutine routine(_sd);
     int timeout = 5000;
 
     while (timeout > 0) {
@@ -289,6 +290,8 @@ TUringTask TUringCoroutine::start()
         });
         _response = std::move(result.response);
         _fileName = std::move(result.fileName);
+        _fileRanges = std::move(result.fileRanges);
+        _fileEpilogue = std::move(result.fileEpilogue);
 
         if (!_response.isEmpty()) {
             int res = co_await AsyncSend(_sd, _response.data(), _response.length());
@@ -339,8 +342,37 @@ TUringTask TUringCoroutine::start()
 
             munmap(mapped, fileSize);
 #else
-            int res = co_await AsyncSendFile(_sd, fd, fileSize);
-            tSystemDebug("AsyncSendFile: res:{}", res);
+            if (_fileRanges.isEmpty()) {
+                int res = co_await AsyncSendFile(_sd, fd, 0, fileSize);
+                tSystemDebug("AsyncSendFile: res:{}", res);
+            } else {
+                // Byte ranges
+                for (auto &range : _fileRanges) {
+                    if (!range.prologue.isEmpty()) {
+                        int res = co_await AsyncSend(_sd, range.prologue.data(), range.prologue.length());
+                        if (res <= 0) {
+                            tSystemError("Send error fd={} res={}", _sd, res);
+                            co_return;
+                        }
+                    }
+
+                    int res = co_await AsyncSendFile(_sd, fd, range.offset, range.length);
+                    tSystemDebug("AsyncSendFile: offset:{} res:{}", range.offset, res);
+                    if (res < 0) {
+                        co_return;
+                    }
+                }
+
+                if (!_fileEpilogue.isEmpty()) {
+                    int res = co_await AsyncSend(_sd, _fileEpilogue.data(), _fileEpilogue.length());
+                    if (res <= 0) {
+                        tSystemError("Send error fd={} res={}", _sd, res);
+                        co_return;
+                    }
+                }
+                _fileRanges.clear();
+                _fileEpilogue.resize(0);
+            }
 
 #endif
             _fileName.resize(0);
@@ -71,7 +71,7 @@ bool TUrlRoute::parseConfigFile()
 bool TUrlRoute::addRouteFromString(const QString &line)
 {
     QStringList items = line.simplified().split(' ');
-    if (items.count() != 3) {
+    if (items.count() < 3) {
         Tf::error("Invalid directive, '{}'", line);
         return false;
     }
@@ -126,7 +126,33 @@ bool TUrlRoute::addRouteFromString(const QString &line)
         }
     }
 
+    // Options
+    for (int i = 3; i < items.count(); ++i) {
+        QString name = items[i].section('=', 0, 0).toLower();
+        QString value = THttpUtility::trimmedQuotes(items[i].section('=', 1));
+
+        if (name == QLatin1String("cache")) {
+            bool ok;
+            rt.cache.seconds = value.toInt(&ok);
+            if (!ok || rt.cache.seconds < 0) {
+                Tf::error("Invalid cache seconds, '{}'", items[i]);
+                return false;
+            }
+        } else if (name == QLatin1String("query")) {
+            rt.cache.queryItems = value.split(',', Qt::SkipEmptyParts);
+        } else if (name == QLatin1String("header")) {
+            for (auto &header : value.split(',', Qt::SkipEmptyParts)) {
+                rt.cache.headers << header.toLatin1();
+            }
+        } else {
+            Tf::error("Invalid option, '{}'", items[i]);
+            return false;
+        }
+    }
+
     _routes << rt;
+    insertRoute(_routes.count() - 1);
+    _urlIndex[rt.controller + '#' + rt.action] << _routes.count() - 1;
     tSystemDebug("route: method:{} path:{}  ctrl:{} action:{} params:{}",
         (int)rt.method, (QLatin1String("/") + rt.componentList.join("/")), (const char*)rt.controller.data(),
         (const char*)rt.action.data(), rt.hasVariableParams);
@@ -134,55 +160,123 @@ bool TUrlRoute::addRouteFromString(const QString &line)
 }
 
 
-TRouting TUrlRoute::findRouting(Tf::HttpMethod method, const QStringList &components) const
+/*!
+  Adds the route of the \a index to the route trees of the methods it
+  accepts. Routes added earlier take precedence over later ones.
+*/
+void TUrlRoute::insertRoute(int index)
 {
-    if (_routes.isEmpty()) {
-        return TRouting();
-    }
+    const TRoute &rt = _routes[index];
 
-    for (const auto &rt : _routes) {
-        // Too long or short?
-        if (rt.hasVariableParams) {
-            if (components.length() < rt.componentList.length() - 1) {
-                continue;
+    for (int method = 0; method < (int)_trees.size(); ++method) {
+        if (rt.method != TRoute::RouteDirective::Match && (int)rt.method != method) {
+            continue;
+        }
+
+        QList<Node> &tree = _trees[method];
+        if (tree.isEmpty()) {
+            tree << Node();  // root
+        }
+
+        int node = 0;
+        tree[node].minRoute = std::min(tree[node].minRoute, index);
+
+        for (const auto &c : rt.componentList) {
+            if (c == QLatin1String(":params")) {
+                if (tree[node].paramsRoute < 0) {
+                    tree[node].paramsRoute = index;
+                }
+                node = -1;
+                break;
             }
-        } else {
-            if (components.length() != rt.componentList.length()) {
-                continue;
+
+            bool isParam = (c == QLatin1String(":param"));
+            int next = (isParam) ? tree[node].param : tree[node].literals.value(c, -1);
+            if (next < 0) {
+                next = tree.count();
+                tree << Node();
+                if (isParam) {
+                    tree[node].param = next;
+                } else {
+                    tree[node].literals.insert(c, next);
+                }
             }
+            node = next;
+            tree[node].minRoute = std::min(tree[node].minRoute, index);
         }
 
-        for (int idx : (const QList<int> &)rt.keywordIndexes) {
-            if (components.value(idx) != rt.componentList[idx]) {
-                goto continue_next;
-            }
+        if (node >= 0 && tree[node].route < 0) {
+            tree[node].route = index;
+        }
+    }
+}
+
+/*!
+  Returns the minimum index of the routes matching the \a components from
+  the position \a pos under the \a node, or \a best if none is smaller.
+*/
+int TUrlRoute::matchRoute(const QList<Node> &tree, int node, const QStringList &components, int pos, int best) const
+{
+    const Node &n = tree[node];
+    if (n.minRoute >= best) {
+        return best;
+    }
+
+    // ":params" takes the rest, even if empty
+    if (n.paramsRoute >= 0 && n.paramsRoute < best) {
+        best = n.paramsRoute;
+    }
+
+    if (pos == components.count()) {
+        if (n.route >= 0 && n.route < best) {
+            best = n.route;
         }
+        return best;
+    }
+
+    auto it = n.literals.constFind(components[pos]);
+    if (it != n.literals.constEnd()) {
+        best = matchRoute(tree, *it, components, pos + 1, best);
+    }
+    if (n.param >= 0) {
+        best = matchRoute(tree, n.param, components, pos + 1, best);
+    }
+    return best;
+}
 
-        if (rt.method == TRoute::RouteDirective::Match || (int)rt.method == (int)method) {
-            // Generates parameters for action
-            QStringList params = components;
 
-            if (params.count() == 1 && params[0].isEmpty()) {  // means path="/"
-                params.clear();
+TRouting TUrlRoute::findRouting(Tf::HttpMethod method, const QStringList &components) const
+{
+    if ((int)method < 0 || (int)method >= (int)_trees.size() || _trees[method].isEmpty()) {
+        return TRouting();
+    }
+
+    int index = matchRoute(_trees[method], 0, components, 0, INT_MAX);
+    if (index == INT_MAX) {
+        return TRouting() /* Not found routing info */;
+    }
+
+    const TRoute &rt = _routes[index];
+
+    // Generates parameters for action
+    QStringList params;
+    if (components.count() != 1 || !components[0].isEmpty()) {  // not path="/"
+        // Skips non-parameters
+        params.reserve(components.count() - rt.keywordIndexes.count());
+        int k = 0;
+        for (int i = 0; i < components.count(); ++i) {
+            if (k < rt.keywordIndexes.count() && rt.keywordIndexes[k] == i) {
+                ++k;
             } else {
-                // Erases non-parameters
-                QListIterator<int> it(rt.keywordIndexes);
-                it.toBack();
-                while (it.hasPrevious()) {
-                    int idx = it.previous();
-                    params.removeAt(idx);
-                }
+                params << components[i];
             }
-
-            TRouting routing(rt.controller, rt.action, params);
-            routing.exists = true;
-            return routing;
         }
-    continue_next:
-        continue;
     }
 
-    return TRouting() /* Not found routing info */;
+    TRouting routing(rt.controller, rt.action, params);
+    routing.cache = rt.cache;
+    routing.exists = true;
+    return routing;
 }
 
 
@@ -211,19 +305,17 @@ static QString generatePath(const QStringList &components, const QStringList &pa
 
 QString TUrlRoute::findUrl(const QString &controller, const QString &action, const QStringList &params) const
 {
-    if (_routes.isEmpty()) {
+    const QByteArray key = controller.toLower().toLatin1() + "controller#" + action.toLower().toLatin1();
+    auto it = _urlIndex.constFind(key);
+    if (it == _urlIndex.constEnd()) {
         return QString();
     }
 
-    for (const auto &rt : _routes) {
-        const QByteArray ctrl = controller.toLower().toLatin1() + "controller";
-        const QByteArray act = action.toLower().toLatin1();
-
-        if (rt.controller == ctrl && rt.action == act) {
-            if ((rt.paramNum == params.count() && !rt.hasVariableParams)
-                || (rt.paramNum <= params.count() && rt.hasVariableParams)) {
-                return generatePath(rt.componentList, params);
-            }
+    for (int index : *it) {
+        const TRoute &rt = _routes[index];
+        if ((rt.paramNum == params.count() && !rt.hasVariableParams)
+            || (rt.paramNum <= params.count() && rt.hasVariableParams)) {
+            return generatePath(rt.componentList, params);
         }
     }
 
@@ -234,6 +326,10 @@ QString TUrlRoute::findUrl(const QString &controller, const QString &action, con
 void TUrlRoute::clear()
 {
     _routes.clear();
+    for (auto &tree : _trees) {
+        tree.clear();
+    }
+    _urlIndex.clear();
 }
 
 
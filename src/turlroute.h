@@ -1,7 +1,18 @@
 #pragma once
 #include <QByteArray>
+#include <QHash>
 #include <QStringList>
 #include <TGlobal>
+#include <array>
+#include <climits>
+
+
+class TRouteCachePolicy {
+public:
+    int seconds {0};  // 0: not cached
+    QStringList queryItems;  // query items in the cache key
+    QByteArrayList headers;  // request headers in the cache key
+};
 
 
 class TRoute {
@@ -27,6 +38,7 @@ public:
     QByteArray action;
     int paramNum {0};
     bool hasVariableParams {false};
+    TRouteCachePolicy cache;
 };
 
 
@@ -36,6 +48,7 @@ public:
     QByteArray controller;
     QByteArray action;
     QStringList params;
+    TRouteCachePolicy cache;
 
     TRouting() { }
     TRouting(const QByteArray &controller, const QByteArray &action, const QStringList &params = QStringList());
@@ -75,5 +88,20 @@ protected:
     void clear();
 
 private:
+    // Node of a route tree, one level per path component
+    class Node {
+    public:
+        QHash<QString, int> literals;  // child node indexes by component
+        int param {-1};  // child node index for ":param"
+        int route {-1};  // index of the route ending at this node
+        int paramsRoute {-1};  // index of the route with ":params" at this node
+        int minRoute {INT_MAX};  // minimum index of the routes in this subtree
+    };
+
+    void insertRoute(int index);
+    int matchRoute(const QList<Node> &tree, int node, const QStringList &components, int pos, int best) const;
+
     QList<TRoute> _routes;
+    std::array<QList<Node>, Tf::Patch + 1> _trees;  // route trees per HTTP method
+    QHash<QByteArray, QList<int>> _urlIndex;  // route indexes by controller and action
 };
@@ -5,6 +5,7 @@
  * the New BSD License, which is incorporated herein by reference.
  */
 
+#include "tassetmanifest.h"
 #include <QFileInfo>
 #include <QRegularExpression>
 #include <TActionView>
@@ -726,21 +727,35 @@ QString TViewHelper::jsPath(const QString &src, bool withTimestamp) const
 /*!
   Returns a path to \a src. The \a src must be one of URL, a absolute
   path or a relative path. If \a src is a relative path, it must exist
-  in the public directory.
+  in the public directory. If \a withTimestamp is true, the modification
+  time of the file, taken from TAssetManifest if enabled and the file is
+  in it, is appended as the query.
 */
 QString TViewHelper::srcPath(const QString &src, const QString &dir, bool withTimestamp) const
 {
-    if (src.contains(QRegularExpression("^[a-z]+://"))) {
+    static const QRegularExpression rx("^[a-z]+://");
+
+    if (src.contains(rx)) {
         return src;
     }
 
     QString ret = (src.startsWith('/')) ? src : dir + src;
 
     if (withTimestamp) {
-        QFileInfo fi(Tf::app()->publicPath() + ret);
-        if (fi.exists()) {
+        QString fingerprint;
+        if (TAssetManifest::isEnabled()) {
+            fingerprint = TAssetManifest::instance().fingerprint(ret);
+        }
+        if (fingerprint.isEmpty()) {
+            // Not in the manifest, such as a file added after it was built
+            QFileInfo fi(Tf::app()->publicPath() + ret);
+            if (fi.exists()) {
+                fingerprint = QString::number(fi.lastModified().toSecsSinceEpoch());
+            }
+        }
+        if (!fingerprint.isEmpty()) {
             ret += QLatin1Char('?');
-            ret += QString::number(fi.lastModified().toSecsSinceEpoch());
+            ret += fingerprint;
         }
     }
     return ret;
@@ -7,6 +7,8 @@
 
 #include "tcachefactory.h"
 #include "tdatabasecontextmainthread.h"
+#include "tlocalcache.h"
+#include "tsystembus.h"
 #include <QDateTime>
 #include <QDir>
 #include <QJsonDocument>
@@ -616,6 +618,13 @@ void TWebApplication::initializeCache()
         initializer->setSingleShot(true);
         initializer->start(10);
     }
+
+    if (cacheEnabled() && TLocalCache::isEnabled() && maxNumberOfAppServers() > 1) {
+        // Receives invalidations of the local cache from other processes
+        QObject::connect(TSystemBus::instance(), &TSystemBus::cacheInvalidated, [](const QByteArray &key) {
+            TCache::invalidateLocal(key);
+        });
+    }
 }
 
 
@@ -7,6 +7,7 @@
 
 #include "tdispatcher.h"
 #include "thazardptrmanager.h"
+#include "tsessionmanager.h"
 #include "tsystemglobal.h"
 #include <TActionController>
 #include <TAppSettings>
@@ -320,6 +321,9 @@ int main(int argc, char *argv[])
     // Initialize cache
     webapp.initializeCache();
 
+    // Starts session GC
+    TSessionManager::instance().startGarbageCollector();
+
     QObject::connect(&webapp, &QCoreApplication::aboutToQuit, [&]() { server->stop(); });
     ret = webapp.exec();
 
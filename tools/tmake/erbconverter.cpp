@@ -35,6 +35,36 @@
     "T_DEFINE_VIEW(%1)\n"                           \
     "\n"
 
+#define VIEW_UTF8_SOURCE_TEMPLATE                   \
+    "#include <QtCore>\n"                           \
+    "#include <TreeFrogView>\n"                     \
+    "%4"                                            \
+    "\n"                                            \
+    "class T_VIEW_EXPORT %1 : public TActionView\n" \
+    "{\n"                                           \
+    "public:\n"                                     \
+    "  %1() : TActionView() { }\n"                  \
+    "  QString toString();\n"                       \
+    "  QByteArray toUtf8();\n"                      \
+    "};\n"                                          \
+    "\n"                                            \
+    "QString %1::toString()\n"                      \
+    "{\n"                                           \
+    "  return QString::fromUtf8(toUtf8());\n"       \
+    "}\n"                                           \
+    "\n"                                            \
+    "QByteArray %1::toUtf8()\n"                     \
+    "{\n"                                           \
+    "  utf8Output = true;\n"                        \
+    "  responsebytes.reserve(%3);\n"                \
+    "%2\n"                                          \
+    "  return responsebytes;\n"                     \
+    "}\n"                                           \
+    "\n"                                            \
+    "T_DEFINE_VIEW(%1)\n"                           \
+    "\n"
+
+extern bool utf8OutputMode;
 
 const QRegularExpression RxPartialTag("<%#partial[ \t]+\"([^\"]+)\"[ \t]*%>");
 
@@ -89,11 +119,11 @@ bool ErbConverter::convert(const QString &erbPath, int trimMode) const
         return false;
     }
 
-    ErbParser parser((ErbParser::TrimMode)trimMode);
+    ErbParser parser((ErbParser::TrimMode)trimMode, outputMode());
     parser.parse(erbSrc);
     QString code = parser.sourceCode();
     QTextStream ts(&outFile);
-    ts << QString(VIEW_SOURCE_TEMPLATE).arg(className, code, QString::number(code.size()), generateIncludeCode(parser));
+    ts << QString(sourceTemplate()).arg(className, code, QString::number(code.size()), generateIncludeCode(parser));
     if (ts.status() == QTextStream::Ok) {
         std::printf("  created  %s  (trim:%d)\n", qUtf8Printable(outFile.fileName()), trimMode);
     }
@@ -109,11 +139,11 @@ bool ErbConverter::convert(const QString &className, const QString &erb, int tri
         return false;
     }
 
-    ErbParser parser((ErbParser::TrimMode)trimMode);
+    ErbParser parser((ErbParser::TrimMode)trimMode, outputMode());
     parser.parse(erb);
     QString code = parser.sourceCode();
     QTextStream ts(&outFile);
-    ts << QString(VIEW_SOURCE_TEMPLATE).arg(className, code, QString::number(code.size()), generateIncludeCode(parser));
+    ts << QString(sourceTemplate()).arg(className, code, QString::number(code.size()), generateIncludeCode(parser));
     if (ts.status() == QTextStream::Ok) {
         std::printf("  created  %s  (trim:%d)\n", qUtf8Printable(outFile.fileName()), trimMode);
     }
@@ -143,6 +173,44 @@ QString ErbConverter::escapeNewline(const QString &string)
 }
 
 
+QString ErbConverter::escapeUtf8(const QByteArray &utf8)
+{
+    QString str;
+    str.reserve(utf8.length() * 1.1);
+
+    for (char c : utf8) {
+        if (c == '\\') {
+            str += QLatin1String("\\\\");
+        } else if (c == '\n') {
+            str += QLatin1String("\\n");
+        } else if (c == '\r') {
+            str += QLatin1String("\\r");
+        } else if (c == '"') {
+            str += QLatin1String("\\\"");
+        } else if ((uchar)c >= 0x80) {
+            // Octal escape sequence of non-ASCII byte
+            str += QLatin1Char('\\');
+            str += QString::number((uchar)c, 8);
+        } else {
+            str += QLatin1Char(c);
+        }
+    }
+    return str;
+}
+
+
+ErbParser::OutputMode ErbConverter::outputMode()
+{
+    return (utf8OutputMode) ? ErbParser::Utf8Output : ErbParser::QStringOutput;
+}
+
+
+const char *ErbConverter::sourceTemplate()
+{
+    return (utf8OutputMode) ? VIEW_UTF8_SOURCE_TEMPLATE : VIEW_SOURCE_TEMPLATE;
+}
+
+
 QString ErbConverter::generateIncludeCode(const ErbParser &parser) const
 {
     QString code = parser.includeCode();
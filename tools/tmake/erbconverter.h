@@ -1,10 +1,9 @@
 #pragma once
+#include "erbparser.h"
 #include <QDir>
 #include <QFile>
 #include <QString>
 
-class ErbParser;
-
 
 class ErbConverter {
 public:
@@ -14,10 +13,13 @@ public:
     QDir outputDir() const { return outputDirectory; }
     static QString fileSuffix() { return "erb"; }
     static QString escapeNewline(const QString &string);
+    static QString escapeUtf8(const QByteArray &utf8);
 
 protected:
     QString generateIncludeCode(const ErbParser &parser) const;
     QStringList replacePartialTag(QString &erb, int depth) const;
+    static ErbParser::OutputMode outputMode();
+    static const char *sourceTemplate();
 
 private:
     QDir outputDirectory;
@@ -60,13 +60,23 @@ void ErbParser::parse(const QString &erb)
         QString text = erbData.mid(pos, i - pos);
         if (!text.isEmpty()) {
             // HTML output
-            if (isAsciiString(text)) {
-                srcCode += QLatin1String("  responsebody += QStringLiteral(\"");
+            if (outputMode == Utf8Output) {
+                // Precomputed UTF-8 bytes
+                QByteArray utf8 = text.toUtf8();
+                srcCode += QLatin1String("  responsebytes.append(\"");
+                srcCode += ErbConverter::escapeUtf8(utf8);
+                srcCode += QLatin1String("\", ");
+                srcCode += QString::number(utf8.length());
+                srcCode += QLatin1String(");\n");
             } else {
-                srcCode += QLatin1String("  responsebody += tr(\"");
+                if (isAsciiString(text)) {
+                    srcCode += QLatin1String("  responsebody += QStringLiteral(\"");
+                } else {
+                    srcCode += QLatin1String("  responsebody += tr(\"");
+                }
+                srcCode += ErbConverter::escapeNewline(text);
+                srcCode += QLatin1String("\");\n");
             }
-            srcCode += ErbConverter::escapeNewline(text);
-            srcCode += QLatin1String("\");\n");
         }
 
         if (i >= 0) {
@@ -106,6 +116,20 @@ void ErbParser::parsePercentTag()
             QPair<QString, QString> p = parseEndPercentTag();
             incCode += p.first;
             incCode += QLatin1Char('\n');
+        } else if (posMatchWith("cache ") || posMatchWith("cache\t")) {
+            startTag += QLatin1String("cache");
+            pos += 5;
+            // Outputs the beginning of fragment cache block
+            QPair<QString, QString> p = parseEndPercentTag();
+            srcCode += QLatin1String("if (beginFragment(");
+            srcCode += semicolonTrim(p.first);
+            srcCode += QLatin1String(")) {\n");
+        } else if (posMatchWith("endcache")) {
+            startTag += QLatin1String("endcache");
+            pos += 8;
+            // Outputs the end of fragment cache block
+            parseEndPercentTag();
+            srcCode += QLatin1String("} endFragment();\n");
         } else {
             // Outputs comments
             srcCode += QLatin1String("/*");
@@ -160,7 +184,9 @@ void ErbParser::parsePercentTag()
             // Outputs the value
             QPair<QString, QString> p = parseEndPercentTag();
             if (!p.first.isEmpty()) {
-                if (p.second.isEmpty()) {
+                if (isYield(p)) {
+                    srcCode += QLatin1String("echoYield();\n");
+                } else if (p.second.isEmpty()) {
                     srcCode += QLatin1String("echo(");
                     srcCode += semicolonTrim(p.first);
                     srcCode += QLatin1String(");\n");
@@ -179,7 +205,9 @@ void ErbParser::parsePercentTag()
             // Outputs the escaped value
             QPair<QString, QString> p = parseEndPercentTag();
             if (!p.first.isEmpty()) {
-                if (p.second.isEmpty()) {
+                if (isYield(p)) {
+                    srcCode += QLatin1String("ehYield();\n");
+                } else if (p.second.isEmpty()) {
                     srcCode += QLatin1String("eh(");
                     srcCode += semicolonTrim(p.first);
                     srcCode += QLatin1String(");\n");
@@ -209,6 +237,14 @@ void ErbParser::parsePercentTag()
 }
 
 
+// Bare yield() of a layout, written as UTF-8 without the conversion to
+// QString in the UTF-8 output mode
+bool ErbParser::isYield(const QPair<QString, QString> &tag) const
+{
+    return outputMode == Utf8Output && tag.second.isEmpty() && semicolonTrim(tag.first) == QLatin1String("yield()");
+}
+
+
 QPair<QString, QString> ErbParser::parseEndPercentTag()
 {
     QString string;
@@ -11,8 +11,13 @@ public:
         StrongTrim,  // Removes whitespaces from the start and the end
     };
 
-    ErbParser(TrimMode mode) :
-        trimMode(mode), pos(0) { }
+    enum OutputMode {
+        QStringOutput = 0,  // Appends to the QString buffer
+        Utf8Output,  // Appends UTF-8 bytes to the QByteArray buffer
+    };
+
+    ErbParser(TrimMode mode, OutputMode output = QStringOutput) :
+        trimMode(mode), outputMode(output), pos(0) { }
     void parse(const QString &text);
     QString sourceCode() const { return srcCode; }
     QString includeCode() const { return incCode; }
@@ -21,10 +26,12 @@ private:
     bool posMatchWith(const QString &str, int offset = 0) const;
     void parsePercentTag();
     QPair<QString, QString> parseEndPercentTag();
+    bool isYield(const QPair<QString, QString> &tag) const;
     void skipWhiteSpacesAndNewLineCode();
     QString parseQuote();
 
     TrimMode trimMode;
+    OutputMode outputMode;
     QString erbData;
     QString srcCode;
     QString incCode;
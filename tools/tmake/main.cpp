@@ -15,6 +15,7 @@
 constexpr auto DEFAULT_OUTPUT_DIR = "viewcodes";
 extern QString devIni;
 extern int defaultTrimMode;
+extern bool utf8OutputMode;
 
 
 static int usage()
@@ -67,6 +68,8 @@ int main(int argc, char *argv[])
 
     defaultTrimMode = devSetting.value("Erb.DefaultTrimMode", "1").toInt();
     std::printf("Erb.DefaultTrimMode: %d\n", defaultTrimMode);
+    utf8OutputMode = devSetting.value("Erb.Utf8Output", false).toBool();
+    std::printf("Erb.Utf8Output: %s\n", (utf8OutputMode) ? "true" : "false");
 
     QDir viewDir(".");
     if (!args.value("-v").isEmpty()) {
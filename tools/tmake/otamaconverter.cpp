@@ -16,6 +16,7 @@
 #include <THtmlParser>
 
 #define TF_ATTRIBUTE_NAME QLatin1String("data-tf")
+#define TF_CACHE_ATTRIBUTE_NAME QLatin1String("data-tf-cache")
 #define LEFT_DELIM QString("<% ")
 #define RIGHT_DELIM QString(" %>")
 #define RIGHT_DELIM_NO_TRIM QString(" +%>")
@@ -26,6 +27,78 @@ QString devIni;
 static QString replaceMarker;
 
 
+// Quotes the string as a C++ string literal; '%' is escaped as well so
+// that the literal does not end the ERB tag
+static QString stringLiteral(const QString &str)
+{
+    QString res = QLatin1String("\"");
+    for (const QChar &c : str) {
+        switch (c.unicode()) {
+        case '"':
+            res += QLatin1String("\\\"");
+            break;
+        case '\\':
+            res += QLatin1String("\\\\");
+            break;
+        case '%':
+            res += QLatin1String("\\045");
+            break;
+        case '\n':
+            res += QLatin1String("\\n");
+            break;
+        case '\r':
+            res += QLatin1String("\\r");
+            break;
+        case '\t':
+            res += QLatin1String("\\t");
+            break;
+        default:
+            res += c;
+            break;
+        }
+    }
+    res += QLatin1Char('"');
+    return res;
+}
+
+// Converts the value of the data-tf-cache attribute, "key, seconds[, tag ...]",
+// into the arguments of the '<%#cache %>' tag. The key and the tags are
+// taken as strings. A value beginning with '=' is an expression list of
+// C++, such as "= keyOf(item), 60", and is passed as is.
+static QString cacheBlockArguments(const QString &value)
+{
+    if (value.startsWith(QLatin1Char('='))) {
+        return value.mid(1).trimmed();
+    }
+
+    const QStringList fields = value.split(QLatin1Char(','));
+    bool ok = false;
+    int seconds = fields.value(1).trimmed().toInt(&ok);
+    if (!ok || seconds <= 0 || fields[0].trimmed().isEmpty()) {
+        qCritical("Invalid data-tf-cache attribute: %s", qUtf8Printable(value));
+        return QString();
+    }
+
+    QString args = stringLiteral(fields[0].trimmed());
+    args += QLatin1String(", ");
+    args += QString::number(seconds);
+
+    QStringList tags;
+    for (int i = 2; i < fields.count(); ++i) {
+        QString tag = fields[i].trimmed();
+        if (!tag.isEmpty()) {
+            tags << stringLiteral(tag);
+        }
+    }
+    if (!tags.isEmpty()) {
+        args += QLatin1String(", {");
+        args += tags.join(QLatin1String(", "));
+        args += QLatin1Char('}');
+    }
+    return args;
+}
+
+
 QString generateErbPhrase(const QString &str, int echoOption)
 {
     QString s = str;
@@ -157,6 +230,12 @@ QString OtamaConverter::convertToErb(const QString &html, const QString &otm, in
             e.removeAttribute(TF_ATTRIBUTE_NAME);
         }
 
+        QString cacheArgs;
+        if (e.hasAttribute(TF_CACHE_ATTRIBUTE_NAME)) {
+            cacheArgs = cacheBlockArguments(e.attribute(TF_CACHE_ATTRIBUTE_NAME).trimmed());
+            e.removeAttribute(TF_CACHE_ATTRIBUTE_NAME);
+        }
+
         if (label == DUMMY_LABEL) {
             htmlParser.removeElementTree(i, true);
             continue;
@@ -259,6 +338,20 @@ QString OtamaConverter::convertToErb(const QString &html, const QString &otm, in
                 }
             }
         }
+
+        // Fragment cache block
+        if (!cacheArgs.isEmpty()) {
+            const int eparent = htmlParser.at(i).parent;
+            int idx = htmlParser.at(eparent).children.indexOf(i);
+            THtmlElement &he1 = htmlParser.insertNewElement(eparent, idx);
+            he1.text = QLatin1String("<%#cache ");
+            he1.text += cacheArgs;
+            he1.text += RIGHT_DELIM;
+
+            THtmlElement &he2 = htmlParser.insertNewElement(eparent, idx + 2);
+            he2.text = QLatin1String("<%#endcache");
+            he2.text += RIGHT_DELIM;
+        }
     }
 
     return htmlParser.toString();
@@ -28,6 +28,8 @@ private slots:
     void erbparse();
     void erbparseStrong_data();
     void erbparseStrong();
+    void erbparseUtf8_data();
+    void erbparseUtf8();
 };
 
 
@@ -111,6 +113,7 @@ void TestTfpconverter::otamaconvert_data()
     QTest::newRow("c2") << "indexc2.html" << "logic1.olg" << "resc2.html";
     QTest::newRow("c3") << "indexc3.html" << "logic1.olg" << "resc3.html";
     QTest::newRow("c4") << "indexc4.html" << "logic1.olg" << "resc4.html";
+    QTest::newRow("c5") << "indexc5.html" << "logic1.olg" << "resc5.html";
 
     QTest::newRow("dm") << "dummy.html"  << "logic1.olg" << "resdm.html";
 }
@@ -253,6 +256,12 @@ void TestTfpconverter::erbparse_data()
                         << "  responsebody += QStringLiteral(\"<body><script>function() { return '\\\\n'; }</script></body>\");\n";
     QTest::newRow("26") << "<body><script>function() { return \"\\n\"; }</script></body>"
                         << "  responsebody += QStringLiteral(\"<body><script>function() { return \\\"\\\\n\\\"; }</script></body>\");\n";
+    QTest::newRow("27") << "<body><%#cache \"side\", 60 %>\n<%= vvv %><%#endcache %>\n</body>"
+                        << "  responsebody += QStringLiteral(\"<body>\");\n  if (beginFragment(\"side\", 60)) {\n  eh(vvv);\n  } endFragment();\n  responsebody += QStringLiteral(\"</body>\");\n";
+    QTest::newRow("28") << "<body><%#cache \"side\", 60, {\"news\"}; %>x<%#endcache%></body>"
+                        << "  responsebody += QStringLiteral(\"<body>\");\n  if (beginFragment(\"side\", 60, {\"news\"})) {\n  responsebody += QStringLiteral(\"x\");\n  } endFragment();\n  responsebody += QStringLiteral(\"</body>\");\n";
+    QTest::newRow("29") << "<body><%#cache \"50\\045>off\", 10 %>x<%#endcache %></body>"
+                        << "  responsebody += QStringLiteral(\"<body>\");\n  if (beginFragment(\"50\\045>off\", 10)) {\n  responsebody += QStringLiteral(\"x\");\n  } endFragment();\n  responsebody += QStringLiteral(\"</body>\");\n";
 }
 
 
@@ -352,5 +361,39 @@ void TestTfpconverter::erbparseStrong()
 }
 
 
+void TestTfpconverter::erbparseUtf8_data()
+{
+    QTest::addColumn<QString>("erb");
+    QTest::addColumn<QString>("expe");
+
+    QTest::newRow("1") << "<body>Hello ... \n</body>"
+                       << "  responsebytes.append(\"<body>Hello ... \\n</body>\", 24);\n";
+    QTest::newRow("2") << "<body>Hello <%= vvv %></body>"
+                       << "  responsebytes.append(\"<body>Hello \", 12);\n  eh(vvv);\n  responsebytes.append(\"</body>\", 7);\n";
+    QTest::newRow("3") << "<p>\"\\\"</p>"
+                       << "  responsebytes.append(\"<p>\\\"\\\\\\\"</p>\", 10);\n";
+    QTest::newRow("4") << QString::fromUtf8("<p>\u3042</p>")
+                       << "  responsebytes.append(\"<p>\\343\\201\\202</p>\", 10);\n";
+    QTest::newRow("5") << "<body><%== yield() %></body>"
+                       << "  responsebytes.append(\"<body>\", 6);\n  echoYield();\n  responsebytes.append(\"</body>\", 7);\n";
+    QTest::newRow("6") << "<body><%= yield(); %></body>"
+                       << "  responsebytes.append(\"<body>\", 6);\n  ehYield();\n  responsebytes.append(\"</body>\", 7);\n";
+    QTest::newRow("7") << "<body><%== yield() %|% \"none\" %></body>"
+                       << "  responsebytes.append(\"<body>\", 6);\n  { QString ___s(fromValue(yield())); if (___s.isEmpty()) { echo(\"none\"); } else { echo(yield()); }}\n  responsebytes.append(\"</body>\", 7);\n";
+}
+
+
+void TestTfpconverter::erbparseUtf8()
+{
+    QFETCH(QString, erb);
+    QFETCH(QString, expe);
+
+    ErbParser parser(ErbParser::NormalTrim, ErbParser::Utf8Output);
+    parser.parse(erb);
+    QString result = parser.sourceCode();
+    QCOMPARE(result, expe);
+}
+
+
 QTEST_MAIN(TestTfpconverter)
 #include "tmaketest.moc"
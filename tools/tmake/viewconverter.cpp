@@ -36,6 +36,7 @@
     "include(source.list)\n"
 
 int defaultTrimMode;
+bool utf8OutputMode;
 
 
 ViewConverter::ViewConverter(const QDir &view, const QDir &output, bool projectFile) :